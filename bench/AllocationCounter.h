@@ -0,0 +1,18 @@
+/**
+ * @file AllocationCounter.h
+ * @brief Счётчик выделений памяти через глобальные operator new.
+ *
+ * AllocationCounter.cpp заменяет глобальные operator new/delete, поэтому
+ * линкуется только в исполняемые файлы, которым нужен подсчёт (recsys_perf).
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace recsys::bench {
+
+    /// Число вызовов operator new (включая new[]) с начала процесса во всех потоках.
+    std::uint64_t allocationCount();
+
+} // namespace recsys::bench
@@ -0,0 +1,37 @@
+#include "BenchData.h"
+#include <random>
+
+namespace recsys::bench {
+
+    std::pair<User, User> makeUserPair(int ratings, double overlap, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> score(1, 5);
+
+        // Первый оценивает товары [0, ratings), второй — первые shared из них
+        // и дальше товары, которых у первого нет.
+        const int shared = static_cast<int>(overlap * ratings + 0.5);
+        User a(1), b(2);
+        for (int i = 0; i < ratings; ++i) {
+            a.addRating(Rating(1, i + 1, score(rng), 0));
+            int itemId = i < shared ? i + 1 : ratings + i + 1;
+            b.addRating(Rating(2, itemId, score(rng), 0));
+        }
+        return {std::move(a), std::move(b)};
+    }
+
+    SyntheticGenerator::Config dataConfig(int users, int items, int perUser, unsigned seed) {
+        SyntheticGenerator::Config config;
+        config.users = static_cast<std::size_t>(users);
+        config.items = static_cast<std::size_t>(items);
+        config.ratings = static_cast<std::uint64_t>(users) * static_cast<std::uint64_t>(perUser);
+        config.seed = seed;
+        return config;
+    }
+
+    Data makeData(int users, int items, int perUser, unsigned seed) {
+        Data data;
+        SyntheticGenerator(dataConfig(users, items, perUser, seed)).build(data.users, data.items);
+        return data;
+    }
+
+} // namespace recsys::bench
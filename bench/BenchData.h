@@ -0,0 +1,45 @@
+/**
+ * @file BenchData.h
+ * @brief Наборы данных для бенчмарков.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "Models/User.h"
+#include "Models/Item.h"
+#include "DataHandler/SyntheticGenerator.h"
+
+namespace recsys::bench {
+
+    /**
+     * @struct Data
+     * @brief Пользователи и товары в формате, который принимают Predictor и Recommender
+     */
+    struct Data {
+        std::vector<User> users;
+        std::vector<recsys::Item> items;
+    };
+
+    /**
+     * @brief Два пользователя с заданным числом оценок и долей общих товаров.
+     *
+     * @param ratings Оценок у каждого
+     * @param overlap Доля общих товаров в [0, 1]
+     * @param seed Зерно генератора оценок
+     */
+    std::pair<User, User> makeUserPair(int ratings, double overlap, unsigned seed);
+
+    /**
+     * @brief Набор со степенной популярностью товаров и активностью пользователей.
+     *
+     * Строится SyntheticGenerator с параметрами по умолчанию;
+     * в среднем perUser оценок на пользователя.
+     */
+    Data makeData(int users, int items, int perUser, unsigned seed);
+
+    /// Параметры генератора для того же набора (например, чтобы записать его в файл).
+    SyntheticGenerator::Config dataConfig(int users, int items, int perUser, unsigned seed);
+
+} // namespace recsys::bench
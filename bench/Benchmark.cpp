@@ -0,0 +1,163 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+namespace recsys::bench {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double nsSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }
+
+        /// Значение по ближайшему рангу из отсортированного массива.
+        double percentile(const std::vector<double>& sorted, double p) {
+            if (sorted.empty()) return 0.0;
+            auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+            return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+        }
+
+        /// Строка JSON с экранированием.
+        std::string quote(const std::string& s) {
+            std::string out = "\"";
+            for (char c : s) {
+                if (c == '"' || c == '\\') out += '\\';
+                if (c == '\n') {
+                    out += "\\n";
+                    continue;
+                }
+                out += c;
+            }
+            return out + "\"";
+        }
+
+        /// Время в удобных единицах для таблицы.
+        std::string humanTime(double ns) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(ns < 10.0 ? 2 : 1);
+            if (ns < 1e3) out << ns << " ns";
+            else if (ns < 1e6) out << ns / 1e3 << " us";
+            else if (ns < 1e9) out << ns / 1e6 << " ms";
+            else out << ns / 1e9 << " s";
+            return out.str();
+        }
+
+    } // namespace
+
+    std::string Result::fullName() const {
+        std::string full = suite + "/" + name;
+        for (const auto& [key, value] : params) full += "/" + key + "=" + value;
+        return full;
+    }
+
+    bool Runner::enabled(const std::string& fullName) const {
+        if (options_.filter.empty()) return true;
+        // Префикс набора («similarity/») должен проходить, если фильтр уточняет случай внутри него
+        return fullName.find(options_.filter) != std::string::npos ||
+               options_.filter.compare(0, fullName.size(), fullName) == 0;
+    }
+
+    void Runner::run(const std::string& suite, const std::string& name, Params params,
+                     const std::function<void()>& setup, const Batch& batch) {
+        Result result;
+        result.suite = suite;
+        result.name = name;
+        result.params = std::move(params);
+        if (!options_.filter.empty() && result.fullName().find(options_.filter) == std::string::npos) return;
+
+        // Прогрев и подбор числа операций в замере
+        // (по самому быстрому запуску: первый обычно идёт на холодных кэшах)
+        double fastest = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < std::max<std::size_t>(options_.warmup, 1); ++i) {
+            if (setup) setup();
+            auto start = Clock::now();
+            batch(1);
+            fastest = std::min(fastest, nsSince(start));
+        }
+        result.iterations = 1;
+        if (!setup) {
+            const double target = options_.minSampleMs * 1e6;
+            if (fastest < target) {
+                result.iterations = static_cast<std::size_t>(std::ceil(target / std::max(fastest, 1.0)));
+            }
+        }
+
+        result.samples.reserve(options_.repetitions);
+        for (std::size_t r = 0; r < options_.repetitions; ++r) {
+            if (setup) setup();
+            auto start = Clock::now();
+            batch(result.iterations);
+            result.samples.push_back(nsSince(start) / static_cast<double>(result.iterations));
+        }
+
+        std::vector<double> sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        if (!sorted.empty()) {
+            result.median = percentile(sorted, 0.5);
+            result.p99 = percentile(sorted, 0.99);
+            result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+            result.min = sorted.front();
+            result.max = sorted.back();
+        }
+
+        if (options_.verbose) printRow(std::cout, result);
+        results_.push_back(std::move(result));
+    }
+
+    void Runner::printHeader(std::ostream& out) {
+        out << std::left << std::setw(64) << "benchmark" << std::right
+            << std::setw(12) << "median" << std::setw(12) << "p99"
+            << std::setw(12) << "iters" << "\n";
+    }
+
+    void Runner::printRow(std::ostream& out, const Result& result) {
+        out << std::left << std::setw(64) << result.fullName() << std::right
+            << std::setw(12) << humanTime(result.median) << std::setw(12) << humanTime(result.p99)
+            << std::setw(12) << result.iterations << std::endl;
+    }
+
+    void Runner::writeJson(std::ostream& out) const {
+        char date[32] = {};
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        out << std::setprecision(6) << std::defaultfloat;
+        out << "{\n  \"context\": {\n"
+            << "    \"date\": " << quote(date) << ",\n"
+#ifdef RECSYS_BUILD_TYPE
+            << "    \"build_type\": " << quote(RECSYS_BUILD_TYPE) << ",\n"
+#endif
+            << "    \"threads\": " << std::thread::hardware_concurrency() << ",\n"
+            << "    \"warmup\": " << options_.warmup << ",\n"
+            << "    \"repetitions\": " << options_.repetitions << ",\n"
+            << "    \"min_sample_ms\": " << options_.minSampleMs << "\n"
+            << "  },\n  \"benchmarks\": [";
+
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            out << (i ? "," : "") << "\n    {\"suite\": " << quote(r.suite)
+                << ", \"name\": " << quote(r.name) << ", \"params\": {";
+            for (std::size_t p = 0; p < r.params.size(); ++p) {
+                out << (p ? ", " : "") << quote(r.params[p].first) << ": " << quote(r.params[p].second);
+            }
+            out << "}, \"iterations\": " << r.iterations
+                << ", \"samples\": " << r.samples.size()
+                << ", \"median_ns\": " << r.median
+                << ", \"p99_ns\": " << r.p99
+                << ", \"mean_ns\": " << r.mean
+                << ", \"min_ns\": " << r.min
+                << ", \"max_ns\": " << r.max << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+} // namespace recsys::bench
@@ -0,0 +1,136 @@
+/**
+ * @file Benchmark.h
+ * @brief Минимальный каркас микробенчмарков: прогрев, повторения, медиана/p99 и JSON.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace recsys::bench {
+
+    /// Не даёт компилятору выбросить вычисление результата.
+    template <class T>
+    inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    /// Параметры случая (имя → значение) для таблицы и JSON.
+    using Params = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @struct Result
+     * @brief Результат одного случая; времена — наносекунды на операцию
+     */
+    struct Result {
+        std::string suite;
+        std::string name;
+        Params params;
+        std::size_t iterations = 0;   ///< Операций в одном замере
+        std::vector<double> samples;  ///< Время операции в каждом замере
+        double median = 0.0;
+        double p99 = 0.0;
+        double mean = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+
+        /// suite/name/param=value/...
+        std::string fullName() const;
+    };
+
+    /**
+     * @class Runner
+     * @brief Выполняет случаи и собирает результаты.
+     *
+     * Каждый случай прогревается warmup раз; по прогреву подбирается число
+     * операций в замере, чтобы замер длился не меньше minSampleMs (так
+     * точность часов не искажает быстрые операции). Затем делается
+     * repetitions замеров, и по ним считаются медиана, p99 (по ближайшему
+     * рангу), среднее и экстремумы.
+     *
+     * Если у случая есть setup, он выполняется перед каждой операцией вне
+     * замера, а замер состоит ровно из одной операции.
+     */
+    class Runner {
+    public:
+        /**
+         * @struct Options
+         * @brief Параметры прогона
+         */
+        struct Options {
+            std::size_t warmup = 3;         ///< Прогревочных запусков
+            std::size_t repetitions = 30;   ///< Замеров на случай
+            double minSampleMs = 5.0;       ///< Минимальная длительность замера
+            std::string filter;             ///< Подстрока полного имени; пустая — все случаи
+            bool verbose = true;            ///< Печатать строку таблицы по готовности случая
+        };
+
+        explicit Runner(Options options) : options_(std::move(options)) {}
+
+        /// Будет ли выполнен случай с таким полным именем (префиксом).
+        bool enabled(const std::string& fullName) const;
+
+        /**
+         * @brief Измеряет операцию op.
+         *
+         * @param suite Набор (например, "similarity")
+         * @param name Имя случая
+         * @param params Параметры случая
+         * @param op Операция; её результат стоит передать в doNotOptimize
+         */
+        template <class Op>
+        void measure(const std::string& suite, const std::string& name, Params params, Op&& op) {
+            run(suite, name, std::move(params), {}, [&](std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i) op();
+            });
+        }
+
+        /// То же с подготовкой setup перед каждой операцией (вне замера).
+        template <class Setup, class Op>
+        void measure(const std::string& suite, const std::string& name, Params params,
+                     Setup&& setup, Op&& op) {
+            run(suite, name, std::move(params), std::function<void()>(setup),
+                [&](std::size_t n) {
+                    for (std::size_t i = 0; i < n; ++i) op();
+                });
+        }
+
+        /// Собранные результаты в порядке выполнения.
+        const std::vector<Result>& results() const { return results_; }
+
+        /// Шапка таблицы (в том же формате, что строки verbose).
+        static void printHeader(std::ostream& out);
+
+        /// Одна строка таблицы.
+        static void printRow(std::ostream& out, const Result& result);
+
+        /**
+         * @brief Пишет результаты в JSON.
+         *
+         * Формат: {"context": {...}, "benchmarks": [{"suite", "name", "params",
+         * "iterations", "samples", "median_ns", "p99_ns", "mean_ns", "min_ns", "max_ns"}]}.
+         */
+        void writeJson(std::ostream& out) const;
+
+    private:
+        using Batch = std::function<void(std::size_t)>;
+
+        void run(const std::string& suite, const std::string& name, Params params,
+                 const std::function<void()>& setup, const Batch& batch);
+
+        Options options_;
+        std::vector<Result> results_;
+    };
+
+} // namespace recsys::bench
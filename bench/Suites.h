@@ -0,0 +1,33 @@
+/**
+ * @file Suites.h
+ * @brief Наборы бенчмарков recsys_bench.
+ */
+
+#pragma once
+
+#include "Benchmark.h"
+
+namespace recsys::bench {
+
+    /**
+     * @struct SuiteOptions
+     * @brief Общие параметры наборов
+     */
+    struct SuiteOptions {
+        double scale = 1.0;   ///< Множитель размеров наборов данных
+        unsigned seed = 42;   ///< Зерно генераторов данных
+    };
+
+    /// Similarity::cosine/pearson/jaccard/manhattan при разной длине профилей и доле общих товаров; adjustedCosine.
+    void similaritySuite(Runner& runner, const SuiteOptions& options);
+
+    /// Predictor::predict (по каждой метрике, без кэша и с тёплым кэшем) и predictItemBased.
+    void predictorSuite(Runner& runner, const SuiteOptions& options);
+
+    /// Точки входа Recommender: recommendTopN, recommendItemBasedTopN, recommendHybrid, topPopularItems.
+    void recommenderSuite(Runner& runner, const SuiteOptions& options);
+
+    /// CSVLoader::load на сгенерированном файле.
+    void loaderSuite(Runner& runner, const SuiteOptions& options);
+
+} // namespace recsys::bench
@@ -0,0 +1,29 @@
+#include "Suites.h"
+#include "BenchData.h"
+#include "DataHandler/CSVLoader.h"
+#include <cstdio>
+#include <string>
+
+namespace recsys::bench {
+
+    void loaderSuite(Runner& runner, const SuiteOptions& options) {
+        if (!runner.enabled("loader")) return;
+
+        const int users = static_cast<int>(2000 * options.scale);
+        const int items = static_cast<int>(1000 * options.scale);
+        const int perUser = 25;
+        const std::string path = "recsys_bench_load.csv";
+        const auto rows = SyntheticGenerator(dataConfig(users, items, perUser, options.seed)).writeCsv(path);
+
+        runner.measure("loader", "CSVLoader::load",
+                       {{"rows", std::to_string(rows)}},
+                       [&] {
+                           std::vector<User> loadedUsers;
+                           std::vector<recsys::Item> loadedItems;
+                           CSVLoader::load(path, loadedUsers, loadedItems, false);
+                           doNotOptimize(loadedUsers.size() + loadedItems.size());
+                       });
+        std::remove(path.c_str());
+    }
+
+} // namespace recsys::bench
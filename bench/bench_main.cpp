@@ -0,0 +1,70 @@
+/**
+ * @file bench_main.cpp
+ * @brief Точка входа recsys_bench: запуск наборов микробенчмарков.
+ *
+ * Использование: recsys_bench [--filter S] [--repetitions N] [--warmup N]
+ * [--min-sample-ms M] [--scale X] [--seed S] [--json файл.json]
+ */
+
+#include "Benchmark.h"
+#include "Suites.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace recsys::bench;
+
+int main(int argc, char* argv[]) {
+    Runner::Options options;
+    SuiteOptions suite;
+    std::string jsonPath;
+
+    try {
+        for (int i = 1; i < argc; i += 2) {
+            std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "[ОШИБКА] Нет значения для " << flag << "\n";
+                return 1;
+            }
+            std::string value = argv[i + 1];
+            if (flag == "--filter") options.filter = value;
+            else if (flag == "--repetitions") options.repetitions = std::stoul(value);
+            else if (flag == "--warmup") options.warmup = std::stoul(value);
+            else if (flag == "--min-sample-ms") options.minSampleMs = std::stod(value);
+            else if (flag == "--scale") suite.scale = std::stod(value);
+            else if (flag == "--seed") suite.seed = static_cast<unsigned>(std::stoul(value));
+            else if (flag == "--json") jsonPath = value;
+            else {
+                std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n"
+                          << "Использование: recsys_bench [--filter S] [--repetitions N] [--warmup N]"
+                             " [--min-sample-ms M] [--scale X] [--seed S] [--json файл.json]\n";
+                return 1;
+            }
+        }
+        if (options.repetitions == 0 || suite.scale <= 0.0) {
+            std::cerr << "[ОШИБКА] repetitions и scale должны быть положительными\n";
+            return 1;
+        }
+
+        Runner runner(options);
+        Runner::printHeader(std::cout);
+        similaritySuite(runner, suite);
+        predictorSuite(runner, suite);
+        recommenderSuite(runner, suite);
+        loaderSuite(runner, suite);
+
+        if (!jsonPath.empty()) {
+            std::ofstream out(jsonPath);
+            if (!out) {
+                std::cerr << "[ОШИБКА] Не удалось открыть " << jsonPath << "\n";
+                return 1;
+            }
+            runner.writeJson(out);
+            std::cout << "\nРезультаты записаны в " << jsonPath << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ОШИБКА] " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "Suites.h"
+#include "BenchData.h"
+#include "Algorithms/Predictor.h"
+#include <random>
+#include <string>
+
+namespace recsys::bench {
+
+    namespace {
+
+        /// Пары (пользователь, товар), по которым циклически идут запросы.
+        std::vector<std::pair<int, int>> makeQueries(const Data& data, std::size_t count, unsigned seed) {
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<std::size_t> user(0, data.users.size() - 1);
+            std::uniform_int_distribution<std::size_t> item(0, data.items.size() - 1);
+            std::vector<std::pair<int, int>> queries;
+            while (queries.size() < count) {
+                const User& u = data.users[user(rng)];
+                int itemId = data.items[item(rng)].getId();
+                if (u.getRatingForItem(itemId) > 0.0) continue;
+                queries.emplace_back(u.getId(), itemId);
+            }
+            return queries;
+        }
+
+        const char* metricName(Predictor::Metric metric) {
+            switch (metric) {
+                case Predictor::Metric::Cosine: return "cosine";
+                case Predictor::Metric::Pearson: return "pearson";
+                case Predictor::Metric::Jaccard: return "jaccard";
+                case Predictor::Metric::Manhattan: return "manhattan";
+            }
+            return "?";
+        }
+
+    } // namespace
+
+    void predictorSuite(Runner& runner, const SuiteOptions& options) {
+        if (!runner.enabled("predictor")) return;
+
+        const int users = static_cast<int>(500 * options.scale);
+        const int items = static_cast<int>(1000 * options.scale);
+        const int perUser = 40;
+        Data data = makeData(users, items, perUser, options.seed);
+        const auto queries = makeQueries(data, 64, options.seed);
+        const Params shape{{"users", std::to_string(users)}, {"items", std::to_string(items)},
+                           {"perUser", std::to_string(perUser)}};
+
+        Predictor::Options noCache;
+        noCache.useCache = false;
+        const int k = 10;
+
+        for (auto metric : {Predictor::Metric::Cosine, Predictor::Metric::Pearson,
+                            Predictor::Metric::Jaccard, Predictor::Metric::Manhattan}) {
+            Params params = shape;
+            params.emplace_back("metric", metricName(metric));
+            std::size_t next = 0;
+            runner.measure("predictor", "predict", params, [&] {
+                const auto& [userId, itemId] = queries[next++ % queries.size()];
+                doNotOptimize(Predictor::predict(userId, itemId, data.users, k, metric, noCache));
+            });
+        }
+
+        {
+            // Все запросы попадают в кэш
+            Predictor::clearCache();
+            for (const auto& [userId, itemId] : queries) Predictor::predict(userId, itemId, data.users, k);
+            std::size_t next = 0;
+            Params params = shape;
+            params.emplace_back("cache", "warm");
+            runner.measure("predictor", "predict", params, [&] {
+                const auto& [userId, itemId] = queries[next++ % queries.size()];
+                doNotOptimize(Predictor::predict(userId, itemId, data.users, k));
+            });
+            Predictor::clearCache();
+        }
+
+        {
+            std::size_t next = 0;
+            runner.measure("predictor", "predictItemBased", shape, [&] {
+                const auto& [userId, itemId] = queries[next++ % queries.size()];
+                doNotOptimize(Predictor::predictItemBased(userId, itemId, data.users, data.items, k, noCache));
+            });
+        }
+    }
+
+} // namespace recsys::bench
@@ -0,0 +1,60 @@
+#include "Suites.h"
+#include "BenchData.h"
+#include "Algorithms/Recommender.h"
+#include <algorithm>
+#include <string>
+
+namespace recsys::bench {
+
+    void recommenderSuite(Runner& runner, const SuiteOptions& options) {
+        if (!runner.enabled("recommender")) return;
+
+        const int users = static_cast<int>(200 * options.scale);
+        const int items = static_cast<int>(300 * options.scale);
+        const int perUser = 20;
+        Data data = makeData(users, items, perUser, options.seed);
+        const Params shape{{"users", std::to_string(users)}, {"items", std::to_string(items)},
+                           {"perUser", std::to_string(perUser)}};
+
+        const int N = 10, k = 10;
+        std::size_t next = 0;
+        auto nextUser = [&] { return data.users[next++ % data.users.size()].getId(); };
+        // Точки входа пользуются глобальными кэшами Predictor: каждый запрос — с холодного кэша
+        auto coldCache = [] { Predictor::clearCache(); };
+
+        runner.measure("recommender", "recommendTopN", shape, coldCache, [&] {
+            doNotOptimize(Recommender::recommendTopN(nextUser(), data.users, data.items, N, k));
+        });
+        runner.measure("recommender", "recommendItemBasedTopN", shape, coldCache, [&] {
+            doNotOptimize(Recommender::recommendItemBasedTopN(nextUser(), data.users, data.items, N));
+        });
+        runner.measure("recommender", "recommendHybrid", shape, coldCache, [&] {
+            doNotOptimize(Recommender::recommendHybrid(nextUser(), data.users, data.items, N, k,
+                                                       Predictor::Metric::Cosine, 0.5));
+        });
+        runner.measure("recommender", "topPopularItems", shape, [&] {
+            doNotOptimize(Recommender::topPopularItems(data.items, N));
+        });
+
+        // Отбор кандидатов по соседям против прохода по каталогу с длинным хвостом
+        // товаров, которых никто не оценивал (новые поступления)
+        const int tail = static_cast<int>(100000 * options.scale);
+        std::vector<Item> catalogue = data.items;
+        int maxId = 0;
+        for (const auto& item : catalogue) maxId = std::max(maxId, item.getId());
+        for (int i = 1; i <= tail; ++i) catalogue.emplace_back(maxId + i);
+        const Params wideShape{{"users", std::to_string(users)}, {"items", std::to_string(catalogue.size())},
+                               {"perUser", std::to_string(perUser)}};
+        const User& target = data.users.front();
+        const auto nbrs = Predictor::neighbors(target, data.users, Predictor::Metric::Cosine);
+        for (bool generate : {false, true}) {
+            Recommender::setCandidateGeneration(generate);
+            runner.measure("recommender", generate ? "fromNeighbors.candidates" : "fromNeighbors.fullScan", wideShape, [&] {
+                doNotOptimize(Recommender::recommendFromNeighbors(target, nbrs, catalogue, N, k, Predictor::Options{}));
+            });
+        }
+        Recommender::setCandidateGeneration(true);
+        Predictor::clearCache();
+    }
+
+} // namespace recsys::bench
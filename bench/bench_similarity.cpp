@@ -0,0 +1,66 @@
+#include "Suites.h"
+#include "BenchData.h"
+#include "Algorithms/BatchSimilarity.h"
+#include "Algorithms/Predictor.h"
+#include "Algorithms/Similarity.h"
+#include <numeric>
+#include <string>
+
+namespace recsys::bench {
+
+    void similaritySuite(Runner& runner, const SuiteOptions& options) {
+        if (!runner.enabled("similarity")) return;
+
+        using Fn = double (*)(const User&, const User&);
+        const std::pair<const char*, Fn> functions[] = {
+            {"cosine", &Similarity::cosine},
+            {"pearson", &Similarity::pearson},
+            {"jaccard", &Similarity::jaccard},
+            {"manhattan", &Similarity::manhattan},
+        };
+
+        for (int ratings : {16, 128, 1024}) {
+            for (int percent : {10, 50, 90}) {
+                const auto pair = makeUserPair(ratings, percent / 100.0, options.seed);
+                const User& a = pair.first;
+                const User& b = pair.second;
+                for (const auto& function : functions) {
+                    Fn fn = function.second;
+                    runner.measure("similarity", function.first,
+                                   {{"ratings", std::to_string(ratings)},
+                                    {"overlap", std::to_string(percent) + "%"}},
+                                   [&] { doNotOptimize(fn(a, b)); });
+                }
+            }
+        }
+
+        // adjustedCosine проходит всех пользователей набора
+        for (int users : {100, 1000}) {
+            const int scaled = static_cast<int>(users * options.scale);
+            Data data = makeData(scaled, 200, 20, options.seed);
+            runner.measure("similarity", "adjustedCosine",
+                           {{"users", std::to_string(scaled)}, {"items", "200"}, {"perUser", "20"}},
+                           [&] { doNotOptimize(Similarity::adjustedCosine(data.users, 1, 2)); });
+        }
+
+        // Соседи для пакета пользователей: поочерёдно и одним разреженным произведением
+        for (int users : {1000, 4000}) {
+            const int scaled = static_cast<int>(users * options.scale);
+            Data data = makeData(scaled, 500, 20, options.seed);
+            const BatchSimilarity batch(data.users);
+            std::vector<std::size_t> queries(std::min<std::size_t>(64, data.users.size()));
+            std::iota(queries.begin(), queries.end(), 0);
+            const Params params = {{"users", std::to_string(scaled)}, {"queries", std::to_string(queries.size())}};
+
+            runner.measure("similarity", "neighbors.perUser", params, [&] {
+                for (std::size_t q : queries) {
+                    doNotOptimize(Predictor::neighbors(data.users[q], data.users, Predictor::Metric::Cosine).size());
+                }
+            });
+            runner.measure("similarity", "neighbors.batched", params, [&] {
+                doNotOptimize(batch.neighbors(queries, Predictor::Metric::Cosine).size());
+            });
+        }
+    }
+
+} // namespace recsys::bench
@@ -0,0 +1,191 @@
+/**
+ * @file load_main.cpp
+ * @brief Точка входа recsys_load: сквозной нагрузочный тест API рекомендаций.
+ *
+ * Использование: recsys_load <файл.csv> [--clients N] [--duration S] [--requests N]
+ * [--mode closed|open] [--qps Q] [--mix p,t,h,pop] [--user-skew S] [--n N]
+ * [--k K] [--seed S] [--connect host:port] [--json файл.json] [--metrics файл.prom]
+ * [--trace файл.json] [--parallel-min N] [--budget-us B]
+ *
+ * Без --connect запросы выполняются в том же процессе, с --connect —
+ * отправляются на сервер `recsys serve`, загруженный с тем же файлом.
+ */
+
+#include "Algorithms/Recommender.h"
+#include "DataHandler/CSVLoader.h"
+#include "Serving/LoadGenerator.h"
+#include "Utils/Instrumentation.h"
+#include "Utils/Tracing.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace recsys;
+
+namespace {
+
+    const char* const kTypeNames[] = {"predict", "topn", "hybrid", "popular"};
+
+    const char* const kUsage =
+        "Использование: recsys_load <файл_данных.csv> [--clients N] [--duration S] [--requests N]"
+        " [--mode closed|open] [--qps Q] [--mix p,t,h,pop] [--user-skew S] [--n N] [--k K]"
+        " [--seed S] [--connect host:port] [--json файл.json] [--metrics файл.prom] [--trace файл.json]"
+        " [--parallel-min N] [--budget-us B]\n";
+
+    LoadGenerator::Mix parseMix(const std::string& value) {
+        std::vector<double> shares;
+        std::stringstream ss(value);
+        std::string token;
+        while (std::getline(ss, token, ',')) shares.push_back(std::stod(token));
+        if (shares.size() != 4) throw std::invalid_argument("--mix expects four shares: predict,topn,hybrid,popular");
+        return {shares[0], shares[1], shares[2], shares[3]};
+    }
+
+    double toMs(std::uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+    void printRow(const std::string& name, const LoadGenerator::Stats& s, double seconds) {
+        const auto& h = s.latency;
+        std::cout << std::left << std::setw(9) << name << std::right << std::fixed
+                  << std::setw(9) << s.requests << std::setw(7) << s.errors
+                  << std::setprecision(1) << std::setw(10) << (seconds > 0.0 ? s.requests / seconds : 0.0)
+                  << std::setprecision(3)
+                  << std::setw(11) << toMs(h.percentile(0.5)) << std::setw(11) << toMs(h.percentile(0.95))
+                  << std::setw(11) << toMs(h.percentile(0.99)) << std::setw(11) << toMs(h.percentile(0.999))
+                  << std::setw(11) << toMs(h.max()) << "\n";
+    }
+
+    void writeStatsJson(std::ostream& out, const LoadGenerator::Stats& s) {
+        const auto& h = s.latency;
+        out << "{\"requests\": " << s.requests << ", \"errors\": " << s.errors
+            << ", \"mean_ns\": " << h.mean()
+            << ", \"p50_ns\": " << h.percentile(0.5) << ", \"p95_ns\": " << h.percentile(0.95)
+            << ", \"p99_ns\": " << h.percentile(0.99) << ", \"p999_ns\": " << h.percentile(0.999)
+            << ", \"max_ns\": " << h.max() << "}";
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "[ОШИБКА] " << kUsage;
+        return 1;
+    }
+
+    LoadGenerator::Config config;
+    RecommendationService::Config serviceConfig;
+    std::string connect, jsonPath, metricsPath, tracePath;
+
+    try {
+        for (int i = 2; i < argc; i += 2) {
+            std::string flag = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "[ОШИБКА] Нет значения для " << flag << "\n";
+                return 1;
+            }
+            std::string value = argv[i + 1];
+            if (flag == "--clients") config.clients = std::stoul(value);
+            else if (flag == "--duration") config.durationSeconds = std::stod(value);
+            else if (flag == "--requests") config.maxRequests = std::stoull(value);
+            else if (flag == "--mode") {
+                if (value != "closed" && value != "open") throw std::invalid_argument("Unknown mode: " + value);
+                config.mode = value == "open" ? LoadGenerator::Mode::Open : LoadGenerator::Mode::Closed;
+            }
+            else if (flag == "--qps") config.targetQps = std::stod(value);
+            else if (flag == "--mix") config.mix = parseMix(value);
+            else if (flag == "--user-skew") config.userSkew = std::stod(value);
+            else if (flag == "--n") config.n = std::stoi(value);
+            else if (flag == "--k") serviceConfig.k = std::stoi(value);
+            else if (flag == "--seed") config.seed = std::stoull(value);
+            else if (flag == "--connect") connect = value;
+            else if (flag == "--json") jsonPath = value;
+            else if (flag == "--metrics") metricsPath = value;
+            else if (flag == "--trace") tracePath = value;
+            else if (flag == "--budget-us") serviceConfig.budgetMicros = std::stol(value);
+            else if (flag == "--parallel-min") {
+                auto parallelism = Recommender::parallelism();
+                parallelism.minCandidates = std::stoull(value);
+                Recommender::setParallelism(parallelism);
+            }
+            else {
+                std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n" << kUsage;
+                return 1;
+            }
+        }
+
+        std::vector<User> users;
+        std::vector<Item> items;
+        CSVLoader::load(argv[1], users, items, false);
+        std::cout << "Загружено " << users.size() << " пользователей, " << items.size() << " товаров\n";
+
+        // Сервис нужен и в удалённом режиме: из него берутся пользователи и товары для запросов
+        RecommendationService service(std::move(users), std::move(items), serviceConfig);
+        LoadGenerator::ClientFactory factory = LoadGenerator::inProcess(service);
+        if (!connect.empty()) {
+            auto colon = connect.rfind(':');
+            if (colon == std::string::npos) throw std::invalid_argument("--connect expects host:port");
+            factory = LoadGenerator::remote(connect.substr(0, colon),
+                                            static_cast<std::uint16_t>(std::stoi(connect.substr(colon + 1))));
+        }
+
+        std::cout << "Режим " << (config.mode == LoadGenerator::Mode::Open ? "open" : "closed")
+                  << ", клиентов " << config.clients
+                  << (connect.empty() ? ", в процессе" : ", сервер " + connect) << "\n\n";
+        if (!tracePath.empty()) Tracer::start();
+        const auto model = service.snapshot();
+        auto report = LoadGenerator::run(model->users, model->items, config, factory);
+        Tracer::stop();
+
+        std::cout << std::left << std::setw(9) << "type" << std::right
+                  << std::setw(9) << "requests" << std::setw(7) << "errors" << std::setw(10) << "qps"
+                  << std::setw(11) << "p50 ms" << std::setw(11) << "p95 ms" << std::setw(11) << "p99 ms"
+                  << std::setw(11) << "p999 ms" << std::setw(11) << "max ms" << "\n";
+        for (std::size_t t = 0; t < report.byType.size(); ++t) {
+            if (report.byType[t].requests > 0) printRow(kTypeNames[t], report.byType[t], report.seconds);
+        }
+        printRow("total", report.total, report.seconds);
+        std::cout << std::setprecision(2) << "\nДлительность " << report.seconds << " с, " << report.qps() << " запросов/с\n";
+
+        if (!jsonPath.empty()) {
+            std::ofstream out(jsonPath);
+            if (!out) {
+                std::cerr << "[ОШИБКА] Не удалось открыть " << jsonPath << "\n";
+                return 1;
+            }
+            out << "{\n  \"seconds\": " << report.seconds << ",\n  \"qps\": " << report.qps()
+                << ",\n  \"total\": ";
+            writeStatsJson(out, report.total);
+            for (std::size_t t = 0; t < report.byType.size(); ++t) {
+                out << ",\n  \"" << kTypeNames[t] << "\": ";
+                writeStatsJson(out, report.byType[t]);
+            }
+            out << "\n}\n";
+            std::cout << "Результаты записаны в " << jsonPath << "\n";
+        }
+        if (!tracePath.empty()) {
+            std::ofstream out(tracePath);
+            if (!out) {
+                std::cerr << "[ОШИБКА] Не удалось открыть " << tracePath << "\n";
+                return 1;
+            }
+            Tracer::writeJson(out);
+            std::cout << "Трасса (" << Tracer::eventCount() << " событий) записана в " << tracePath << "\n";
+        }
+        // Счётчики горячего пути за прогон (в удалённом режиме они копятся в процессе сервера)
+        if (!metricsPath.empty()) {
+            std::ofstream out(metricsPath);
+            if (!out) {
+                std::cerr << "[ОШИБКА] Не удалось открыть " << metricsPath << "\n";
+                return 1;
+            }
+            Instrumentation::writeText(out, Instrumentation::snapshot());
+            std::cout << "Счётчики записаны в " << metricsPath << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ОШИБКА] " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
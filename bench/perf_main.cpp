@@ -0,0 +1,390 @@
+/**
+ * @file perf_main.cpp
+ * @brief Точка входа recsys_perf: регрессионные тесты производительности (ctest -L perf).
+ *
+ * Использование: recsys_perf --baseline файл.txt [--time-tolerance X]
+ * [--alloc-tolerance X] [--no-time] [--update]
+ *
+ * На сгенерированных наборах измеряются медианное время и число выделений
+ * памяти на операцию и сравниваются с базовым файлом:
+ * - время: провал, если медиана > базовой × скорость машины × (1 + time-tolerance);
+ *   скорость — отношение текущего времени калибровочного случая к базовому,
+ *   поэтому базовый файл переносим между машинами. Проверяется только в
+ *   Release-сборке, поскольку базовый файл снят в ней, и только для случаев
+ *   от kMinTimedNs: медиана операции короче микросекунды шумит сильнее допуска;
+ * - выделения: провал, если их > базовых × (1 + alloc-tolerance); не зависят
+ *   от машины и проверяются в любой сборке;
+ * - сложность: отношение времени на удвоенном наборе к времени на исходном
+ *   не должно превышать kMaxDoublingRatio (квадратичный рост дал бы 4).
+ *
+ * Проваленные проверки времени перемеряются до kTimingRetries раз (в зачёт
+ * идут лучшая медиана и лучшее отношение удвоения одного прогона). Улучшения не считаются ошибкой; --update переписывает базовый
+ * файл текущими значениями.
+ */
+
+#include "AllocationCounter.h"
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Algorithms/Recommender.h"
+#include "Algorithms/Similarity.h"
+#include "DataHandler/CSVLoader.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef RECSYS_BUILD_TYPE
+#define RECSYS_BUILD_TYPE ""
+#endif
+
+using namespace recsys;
+using namespace recsys::bench;
+
+namespace {
+
+    /// Предел отношения времени на удвоенном наборе ко времени на исходном.
+    constexpr double kMaxDoublingRatio = 3.0;
+
+    /// Случаи с базовой медианой короче этой проверяются только по выделениям.
+    constexpr double kMinTimedNs = 1000.0;
+
+    /// Случай, по которому оценивается скорость машины относительно базового файла.
+    const std::string kCalibration = "calibration";
+
+    /// Сколько раз перемеряется время, если проверки времени не прошли.
+    constexpr int kTimingRetries = 2;
+
+    /**
+     * @struct Measurement
+     * @brief Результат одного случая
+     */
+    struct Measurement {
+        std::string name;
+        double ns = 0.0;       ///< Медиана времени на операцию
+        double allocs = 0.0;   ///< Выделений памяти на операцию
+    };
+
+    /// Базовые значения: (случай, метрика) → значение.
+    using Baseline = std::map<std::pair<std::string, std::string>, double>;
+
+    Baseline readBaseline(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("Cannot open baseline: " + path);
+        Baseline baseline;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            std::string name, metric;
+            double value = 0.0;
+            if (!(fields >> name >> metric >> value)) throw std::runtime_error("Bad baseline line: " + line);
+            baseline[{name, metric}] = value;
+        }
+        return baseline;
+    }
+
+    void writeBaseline(const std::string& path, const std::vector<Measurement>& measurements) {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("Cannot write baseline: " + path);
+        out << "# Базовые значения recsys_perf (--update). Время снято в сборке " << RECSYS_BUILD_TYPE << ".\n"
+            << "# случай метрика значение; ns — медиана на операцию, allocs — выделений на операцию\n";
+        for (const auto& m : measurements) {
+            out << std::left << std::setw(32) << m.name << std::setw(8) << "ns" << std::fixed << std::setprecision(0)
+                << m.ns << "\n"
+                << std::setw(32) << m.name << std::setw(8) << "allocs" << std::setprecision(1) << m.allocs << "\n";
+        }
+    }
+
+    /**
+     * @class PerfSuite
+     * @brief Собирает измерения случаев
+     */
+    class PerfSuite {
+    public:
+        explicit PerfSuite(Runner::Options options) : runner_(std::move(options)) {}
+
+        /// Операция случая; аргумент — порядковый номер, по которому выбирается пользователь.
+        using Op = std::function<void(std::size_t)>;
+
+        /// Число операций, по которым усредняются выделения памяти.
+        static constexpr std::size_t kAllocOps = 8;
+
+        /**
+         * @brief Измеряет op (с подготовкой setup перед каждой операцией, если она задана).
+         *
+         * Время — медиана Runner; выделения — среднее по операциям 0..kAllocOps-1,
+         * поэтому не зависят от числа итераций, выбранного Runner.
+         */
+        void run(const std::string& name, const std::function<void()>& setup, const Op& op) {
+            std::size_t next = 0;
+            auto timed = [&] { op(next++); };
+            if (setup) runner_.measure("perf", name, {}, setup, timed);
+            else runner_.measure("perf", name, {}, timed);
+
+            std::uint64_t allocs = 0;
+            for (std::size_t i = 0; i < kAllocOps; ++i) {
+                if (setup) setup();
+                const auto before = allocationCount();
+                op(i);
+                allocs += allocationCount() - before;
+            }
+            measurements_.push_back({name, runner_.results().back().median,
+                                     static_cast<double>(allocs) / static_cast<double>(kAllocOps)});
+        }
+
+        const std::vector<Measurement>& measurements() const { return measurements_; }
+
+    private:
+        Runner runner_;
+        std::vector<Measurement> measurements_;
+    };
+
+    void runCases(PerfSuite& suite) {
+        const int items = 200, perUser = 20, N = 10, k = 10;
+        const unsigned seed = 42;
+        Data base = makeData(200, items, perUser, seed);
+        Data doubled = makeData(400, items, perUser, seed);
+        auto [a, b] = makeUserPair(128, 0.5, seed);
+        auto coldCache = [] { Predictor::clearCache(); };
+
+        // Поиск в хеш-таблице, как при сравнении профилей, но без кода библиотеки
+        std::unordered_map<int, double> table;
+        for (int i = 0; i < 4096; ++i) table.emplace(i * 7, i * 0.5);
+        suite.run(kCalibration, {}, [&table](std::size_t) {
+            double sum = 0.0;
+            for (int i = 0; i < 4 * 4096 * 7; i += 3) {
+                auto it = table.find(i);
+                if (it != table.end()) sum += it->second;
+            }
+            doNotOptimize(sum);
+        });
+
+        suite.run("similarity.cosine", {}, [&a = a, &b = b](std::size_t) { doNotOptimize(Similarity::cosine(a, b)); });
+        suite.run("similarity.pearson", {}, [&a = a, &b = b](std::size_t) { doNotOptimize(Similarity::pearson(a, b)); });
+
+        Predictor::Options noCache;
+        noCache.useCache = false;
+        for (Data* data : {&base, &doubled}) {
+            const std::string suffix = data == &base ? "" : ".x2";
+            auto user = [data](std::size_t i) { return data->users[i % data->users.size()].getId(); };
+            const int itemId = data->items.front().getId();
+
+            suite.run("predict.cosine" + suffix, {}, [&](std::size_t i) {
+                doNotOptimize(Predictor::predict(user(i), itemId, data->users, k, Predictor::Metric::Cosine, noCache));
+            });
+            suite.run("recommendTopN" + suffix, coldCache, [&](std::size_t i) {
+                doNotOptimize(Recommender::recommendTopN(user(i), data->users, data->items, N, k));
+            });
+        }
+        suite.run("predictItemBased", {}, [&](std::size_t i) {
+            doNotOptimize(Predictor::predictItemBased(base.users[i % base.users.size()].getId(), base.items.back().getId(),
+                                                      base.users, base.items, k, noCache));
+        });
+
+        const auto dir = std::filesystem::temp_directory_path();
+        for (int users : {1000, 2000}) {
+            const std::string suffix = users == 1000 ? "" : ".x2";
+            const std::string path = (dir / ("recsys_perf_" + std::to_string(users) + ".csv")).string();
+            SyntheticGenerator(dataConfig(users, 500, 20, seed)).writeCsv(path, 1);
+            suite.run("csv.load" + suffix, {}, [&](std::size_t) {
+                std::vector<User> loadedUsers;
+                std::vector<recsys::Item> loadedItems;
+                CSVLoader::load(path, loadedUsers, loadedItems, false);
+                doNotOptimize(loadedUsers.size() + loadedItems.size());
+            });
+            std::remove(path.c_str());
+        }
+        Predictor::clearCache();
+    }
+
+    /**
+     * @struct Check
+     * @brief Одна проверка для итоговой таблицы
+     */
+    struct Check {
+        std::string name;
+        std::string metric;
+        double baseline;
+        double current;
+        double limit;
+        bool ok;
+    };
+
+    const Measurement& find(const std::vector<Measurement>& measurements, const std::string& name) {
+        for (const auto& m : measurements) {
+            if (m.name == name) return m;
+        }
+        throw std::logic_error("Unknown perf case: " + name);
+    }
+
+    /**
+     * @struct Tolerances
+     * @brief Допуски сравнения с базовым файлом
+     */
+    struct Tolerances {
+        double time = 1.0;      ///< Допустимый рост медианы (1.0 — вдвое)
+        double allocs = 0.10;   ///< Допустимый рост выделений
+        bool checkTime = true;  ///< Сравнивать ли время с базовым
+    };
+
+    /// Случаи, у которых есть пара на удвоенном наборе (имя + ".x2").
+    const char* const kDoubled[] = {"predict.cosine", "recommendTopN", "csv.load"};
+
+    /// Отношения времени на удвоенном наборе ко времени на исходном, в порядке kDoubled.
+    std::vector<double> doublingRatios(const std::vector<Measurement>& measurements) {
+        std::vector<double> ratios;
+        for (const std::string name : kDoubled) {
+            ratios.push_back(find(measurements, name + ".x2").ns / find(measurements, name).ns);
+        }
+        return ratios;
+    }
+
+    /// Скорость машины относительно базового файла (> 1 — медленнее); 1, если калибровки в нём нет.
+    double machineSpeed(const Baseline& baseline, const std::vector<Measurement>& measurements) {
+        auto calibration = baseline.find({kCalibration, "ns"});
+        if (calibration == baseline.end() || calibration->second <= 0.0) return 1.0;
+        return find(measurements, kCalibration).ns / calibration->second;
+    }
+
+    /**
+     * @brief Проверки по медианам measurements и отношениям ratios (см. doublingRatios).
+     *
+     * Отношения передаются отдельно: при перемерах в зачёт идёт лучшее
+     * отношение одного прогона, а не отношение лучших медиан разных прогонов.
+     */
+    std::vector<Check> compare(const Baseline& baseline, const std::vector<Measurement>& measurements,
+                               const std::vector<double>& ratios, const Tolerances& tolerances) {
+        std::vector<Check> checks;
+        const double speed = machineSpeed(baseline, measurements);
+        for (const auto& m : measurements) {
+            auto allocs = baseline.find({m.name, "allocs"});
+            if (allocs != baseline.end()) {
+                double limit = allocs->second * (1.0 + tolerances.allocs);
+                checks.push_back({m.name, "allocs", allocs->second, m.allocs, limit, m.allocs <= limit});
+            }
+            auto ns = baseline.find({m.name, "ns"});
+            if (tolerances.checkTime && ns != baseline.end() && m.name != kCalibration && ns->second >= kMinTimedNs) {
+                double limit = ns->second * speed * (1.0 + tolerances.time);
+                checks.push_back({m.name, "ns", ns->second, m.ns, limit, m.ns <= limit});
+            }
+        }
+        for (std::size_t i = 0; i < ratios.size(); ++i) {
+            checks.push_back({std::string(kDoubled[i]) + ".x2", "ratio", 2.0, ratios[i], kMaxDoublingRatio,
+                              ratios[i] <= kMaxDoublingRatio});
+        }
+        return checks;
+    }
+
+    /// Провалена ли проверка времени (а не выделений): такие перепроверяются повторным прогоном.
+    bool timingFailed(const std::vector<Check>& checks) {
+        return std::any_of(checks.begin(), checks.end(), [](const Check& c) { return !c.ok && c.metric != "allocs"; });
+    }
+
+    void printCheck(const Check& c) {
+        std::cout << std::left << std::setw(28) << c.name << std::setw(8) << c.metric << std::right << std::fixed
+                  << std::setprecision(c.metric == "ratio" ? 2 : c.metric == "allocs" ? 1 : 0)
+                  << std::setw(14) << c.baseline << std::setw(14) << c.current << std::setw(14) << c.limit
+                  << (c.ok ? "  ok" : "  REGRESSION") << "\n";
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string baselinePath;
+    Tolerances tolerances;
+    tolerances.checkTime = std::string(RECSYS_BUILD_TYPE) == "Release";
+    bool update = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if (flag == "--no-time") {
+                tolerances.checkTime = false;
+                continue;
+            }
+            if (flag == "--update") {
+                update = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "[ОШИБКА] Нет значения для " << flag << "\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (flag == "--baseline") baselinePath = value;
+            else if (flag == "--time-tolerance") tolerances.time = std::stod(value);
+            else if (flag == "--alloc-tolerance") tolerances.allocs = std::stod(value);
+            else {
+                std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n"
+                          << "Использование: recsys_perf --baseline файл.txt [--time-tolerance X]"
+                             " [--alloc-tolerance X] [--no-time] [--update]\n";
+                return 1;
+            }
+        }
+        if (baselinePath.empty()) {
+            std::cerr << "[ОШИБКА] Не задан --baseline\n";
+            return 1;
+        }
+
+        Runner::Options options;
+        options.warmup = 2;
+        options.repetitions = 9;
+        options.minSampleMs = 20.0;
+        options.verbose = false;
+        PerfSuite suite(options);
+        runCases(suite);
+        std::vector<Measurement> measurements = suite.measurements();
+
+        if (update) {
+            writeBaseline(baselinePath, measurements);
+            std::cout << "Базовые значения записаны в " << baselinePath << "\n";
+            return 0;
+        }
+
+        const Baseline baseline = readBaseline(baselinePath);
+        std::vector<double> ratios = doublingRatios(measurements);
+        std::vector<Check> checks = compare(baseline, measurements, ratios, tolerances);
+        for (int attempt = 0; attempt < kTimingRetries && timingFailed(checks); ++attempt) {
+            // Всплеск нагрузки на машине не должен ронять прогон: время перемеряется,
+            // в зачёт идут лучшая медиана каждого случая и лучшее отношение одного прогона
+            std::cout << "Проверки времени не прошли, повторный прогон...\n";
+            PerfSuite retry(options);
+            runCases(retry);
+            for (auto& m : measurements) m.ns = std::min(m.ns, find(retry.measurements(), m.name).ns);
+            const std::vector<double> again = doublingRatios(retry.measurements());
+            for (std::size_t i = 0; i < ratios.size(); ++i) ratios[i] = std::min(ratios[i], again[i]);
+            checks = compare(baseline, measurements, ratios, tolerances);
+        }
+
+        std::cout << std::left << std::setw(28) << "case" << std::setw(8) << "metric" << std::right
+                  << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(14) << "limit" << "\n";
+        std::size_t failed = 0;
+        for (const auto& c : checks) {
+            printCheck(c);
+            if (!c.ok) ++failed;
+        }
+        if (tolerances.checkTime) {
+            std::cout << "\nСкорость машины относительно базового файла: " << std::setprecision(2)
+                      << machineSpeed(baseline, measurements) << " (пределы времени умножены на неё)\n";
+        }
+        if (!tolerances.checkTime) std::cout << "\nВремя не проверялось (сборка " << RECSYS_BUILD_TYPE << ", базовый файл снят в Release)\n";
+        if (failed > 0) {
+            std::cout << "\n" << failed << " регрессий\n";
+            return 1;
+        }
+        std::cout << "\nРегрессий нет\n";
+    } catch (const std::exception& e) {
+        std::cerr << "[ОШИБКА] " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include "BatchSimilarity.h"
+#include "SimilarityPolicies.h"
+#include "../Utils/Instrumentation.h"
+#include "../Utils/MemoryReport.h"
+#include "../Utils/Parallel.h"
+#include "../Utils/Tracing.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace recsys {
+
+    namespace {
+
+        /**
+         * @struct PairSide
+         * @brief Размер профиля и квадрат нормы одного пользователя пары
+         */
+        struct PairSide {
+            std::size_t size;
+            double squaredNorm;
+        };
+
+        // Аккумуляторы ячейки плитки: n — число общих товаров (0 — ячейка не
+        // затронута), add копит суммы, finish отдаёт их finish() политики из SimilarityPolicies.h.
+
+        struct CosineCell {
+            std::uint32_t n = 0;
+            double dot = 0.0;
+            void add(double x, double y) { dot += x * y; }
+            double finish(PairSide a, PairSide b) const {
+                return CosineSimilarity::finish(dot, a.squaredNorm, b.squaredNorm);
+            }
+        };
+
+        struct PearsonCell {
+            std::uint32_t n = 0;
+            double sum1 = 0.0, sum2 = 0.0, sum1Sq = 0.0, sum2Sq = 0.0, pSum = 0.0;
+            void add(double x, double y) {
+                sum1 += x;
+                sum2 += y;
+                sum1Sq += x * x;
+                sum2Sq += y * y;
+                pSum += x * y;
+            }
+            double finish(PairSide, PairSide) const {
+                return PearsonSimilarity::finish(n, sum1, sum2, sum1Sq, sum2Sq, pSum);
+            }
+        };
+
+        struct JaccardCell {
+            std::uint32_t n = 0;
+            void add(double, double) {}
+            double finish(PairSide a, PairSide b) const {
+                return JaccardSimilarity::finish(n, a.size, b.size);
+            }
+        };
+
+        struct ManhattanCell {
+            std::uint32_t n = 0;
+            double sum = 0.0;
+            void add(double x, double y) { sum += std::abs(x - y); }
+            double finish(PairSide, PairSide) const { return ManhattanSimilarity::finish(n, sum); }
+        };
+
+        /**
+         * @struct BatchEntry
+         * @brief Оценка x пользователя пакета b товару col
+         */
+        struct BatchEntry {
+            std::uint32_t col;
+            std::uint32_t b;
+            double x;
+        };
+
+    } // namespace
+
+    BatchSimilarity::BatchSimilarity(const std::vector<User>& users) : users_(users) {
+        RECSYS_TRACE_SCOPE("similarity.batch_index", "similarity");
+        constexpr std::size_t kMaxIndex = std::numeric_limits<std::uint32_t>::max();
+        if (users.size() >= kMaxIndex) throw std::length_error("Too many users for BatchSimilarity");
+
+        // Столбцы — товары по возрастанию ID
+        std::vector<int> itemIds;
+        std::size_t ratings = 0;
+        for (const auto& u : users) ratings += u.getRatings().size();
+        itemIds.reserve(ratings);
+        for (const auto& u : users) {
+            for (const auto& [itemId, rating] : u.getRatings()) itemIds.push_back(itemId);
+        }
+        std::sort(itemIds.begin(), itemIds.end());
+        itemIds.erase(std::unique(itemIds.begin(), itemIds.end()), itemIds.end());
+        if (itemIds.size() >= kMaxIndex) throw std::length_error("Too many items for BatchSimilarity");
+        std::unordered_map<int, std::uint32_t> column;
+        column.reserve(itemIds.size());
+        for (std::size_t c = 0; c < itemIds.size(); ++c) column.emplace(itemIds[c], static_cast<std::uint32_t>(c));
+
+        // Строки пользователей
+        userOffsets_.reserve(users.size() + 1);
+        userOffsets_.push_back(0);
+        userItems_.reserve(ratings);
+        userScores_.reserve(ratings);
+        squaredNorms_.reserve(users.size());
+        std::vector<std::pair<std::uint32_t, double>> row;
+        std::vector<std::size_t> itemCounts(itemIds.size() + 1, 0);
+        for (const auto& u : users) {
+            row.clear();
+            double norm = 0.0;
+            for (const auto& [itemId, rating] : u.getRatings()) {
+                row.emplace_back(column.at(itemId), rating.score);
+                norm += rating.score * rating.score;
+            }
+            std::sort(row.begin(), row.end());
+            for (const auto& [col, score] : row) {
+                userItems_.push_back(col);
+                userScores_.push_back(score);
+                ++itemCounts[col + 1];
+            }
+            userOffsets_.push_back(userItems_.size());
+            squaredNorms_.push_back(norm);
+        }
+
+        // Транспонирование: пользователи в строке товара идут по возрастанию индекса
+        itemOffsets_.assign(itemCounts.size(), 0);
+        for (std::size_t c = 1; c < itemCounts.size(); ++c) itemOffsets_[c] = itemOffsets_[c - 1] + itemCounts[c];
+        itemUsers_.resize(ratings);
+        itemScores_.resize(ratings);
+        std::vector<std::size_t> fill(itemOffsets_.begin(), itemOffsets_.end() - 1);
+        for (std::size_t u = 0; u < users.size(); ++u) {
+            for (std::size_t p = userOffsets_[u]; p < userOffsets_[u + 1]; ++p) {
+                std::size_t& slot = fill[userItems_[p]];
+                itemUsers_[slot] = static_cast<std::uint32_t>(u);
+                itemScores_[slot] = userScores_[p];
+                ++slot;
+            }
+        }
+    }
+
+    template <class Acc>
+    void BatchSimilarity::runBatch(const std::size_t* queries, std::size_t count, const Options& options,
+                                   std::vector<Neighbor>* out) const {
+        RECSYS_TRACE_SCOPE("similarity.batch", "similarity");
+        const std::size_t tile = std::max<std::size_t>(1, options.tileUsers);
+
+        // Объединение профилей пакета, сгруппированное по товарам
+        std::vector<BatchEntry> entries;
+        for (std::size_t b = 0; b < count; ++b) {
+            const std::size_t q = queries[b];
+            for (std::size_t p = userOffsets_[q]; p < userOffsets_[q + 1]; ++p) {
+                entries.push_back({userItems_[p], static_cast<std::uint32_t>(b), userScores_[p]});
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const BatchEntry& a, const BatchEntry& b) {
+            return a.col != b.col ? a.col < b.col : a.b < b.b;
+        });
+        std::vector<std::size_t> groupStart;   ///< Начало группы товара в entries
+        std::vector<std::size_t> cursor;       ///< Позиция в строке товара (растёт от полосы к полосе)
+        for (std::size_t e = 0; e < entries.size(); ++e) {
+            if (e == 0 || entries[e].col != entries[e - 1].col) {
+                groupStart.push_back(e);
+                cursor.push_back(itemOffsets_[entries[e].col]);
+            }
+        }
+        groupStart.push_back(entries.size());
+
+        std::vector<Acc> cells(count * tile);
+        std::vector<std::vector<std::uint32_t>> touched(count);
+        std::uint64_t evaluated = 0, overlap = 0;
+
+        const std::size_t users = userCount();
+        for (std::size_t t0 = 0; t0 < users; t0 += tile) {
+            const std::size_t t1 = std::min(users, t0 + tile);
+
+            // Умножение: каждая строка товара читается один раз на весь пакет
+            for (std::size_t g = 0; g + 1 < groupStart.size(); ++g) {
+                const std::size_t end = itemOffsets_[entries[groupStart[g]].col + 1];
+                std::size_t& pos = cursor[g];
+                for (; pos < end && itemUsers_[pos] < t1; ++pos) {
+                    const std::uint32_t offset = static_cast<std::uint32_t>(itemUsers_[pos] - t0);
+                    const double y = itemScores_[pos];
+                    for (std::size_t e = groupStart[g]; e < groupStart[g + 1]; ++e) {
+                        Acc& cell = cells[entries[e].b * tile + offset];
+                        if (cell.n++ == 0) touched[entries[e].b].push_back(offset);
+                        cell.add(entries[e].x, y);
+                    }
+                }
+            }
+
+            // Схожесть по затронутым ячейкам полосы и их сброс
+            for (std::size_t b = 0; b < count; ++b) {
+                const User& target = users_[queries[b]];
+                const PairSide a{userOffsets_[queries[b] + 1] - userOffsets_[queries[b]], squaredNorms_[queries[b]]};
+                for (std::uint32_t offset : touched[b]) {
+                    Acc& cell = cells[b * tile + offset];
+                    const std::size_t u = t0 + offset;
+                    if (users_[u].getId() != target.getId()) {
+                        const PairSide other{userOffsets_[u + 1] - userOffsets_[u], squaredNorms_[u]};
+                        double s = cell.finish(a, other);
+                        if (s > 0.0) out[b].push_back({s, &users_[u]});
+                        ++evaluated;
+                        overlap += cell.n;
+                    }
+                    cell = Acc{};
+                }
+                touched[b].clear();
+            }
+        }
+
+        std::size_t found = 0;
+        for (std::size_t b = 0; b < count; ++b) {
+            std::sort(out[b].begin(), out[b].end(), [](const Neighbor& x, const Neighbor& y) {
+                return x.similarity != y.similarity ? x.similarity > y.similarity : x.user < y.user;
+            });
+            found += out[b].size();
+        }
+        RECSYS_COUNT(SimilarityEvaluations, evaluated);
+        RECSYS_COUNT(OverlapItems, overlap);
+        RECSYS_COUNT(NeighborsFound, found);
+    }
+
+    std::vector<std::vector<Neighbor>> BatchSimilarity::neighbors(const std::vector<std::size_t>& queries,
+                                                                  Predictor::Metric metric,
+                                                                  const Options& options) const {
+        for (std::size_t q : queries) {
+            if (q >= userCount()) throw std::out_of_range("Query user index out of range");
+        }
+        std::vector<std::vector<Neighbor>> result(queries.size());
+        const std::size_t batch = std::max<std::size_t>(1, options.batchSize);
+        const std::size_t batches = (queries.size() + batch - 1) / batch;
+
+        parallelFor(batches, [&](std::size_t k) {
+            const std::size_t begin = k * batch;
+            const std::size_t count = std::min(queries.size(), begin + batch) - begin;
+            const std::size_t* block = queries.data() + begin;
+            std::vector<Neighbor>* out = result.data() + begin;
+            switch (metric) {
+                case Predictor::Metric::Cosine: runBatch<CosineCell>(block, count, options, out); break;
+                case Predictor::Metric::Pearson: runBatch<PearsonCell>(block, count, options, out); break;
+                case Predictor::Metric::Jaccard: runBatch<JaccardCell>(block, count, options, out); break;
+                case Predictor::Metric::Manhattan: runBatch<ManhattanCell>(block, count, options, out); break;
+            }
+        }, options.threads);
+        return result;
+    }
+
+    std::size_t BatchSimilarity::memoryBytes() const {
+        return MemoryReport::bytesOf(userOffsets_) + MemoryReport::bytesOf(userItems_) +
+               MemoryReport::bytesOf(userScores_) + MemoryReport::bytesOf(itemOffsets_) +
+               MemoryReport::bytesOf(itemUsers_) + MemoryReport::bytesOf(itemScores_) +
+               MemoryReport::bytesOf(squaredNorms_);
+    }
+
+} // namespace recsys
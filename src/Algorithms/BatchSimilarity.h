@@ -0,0 +1,100 @@
+/**
+ * @file BatchSimilarity.h
+ * @brief Схожесть блока пользователей со всеми сразу как разреженное произведение матриц.
+ */
+
+#pragma once
+
+#include "../Models/User.h"
+#include "NeighborhoodPredictor.h"
+#include "Predictor.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class BatchSimilarity
+     * @brief Строки схожести для пакета пользователей: R_Q × Rᵀ.
+     *
+     * Оценки хранятся дважды в формате CSR: по пользователям (строка —
+     * оценённые товары по возрастанию) и по товарам (строка — оценившие
+     * пользователи по возрастанию индекса). Для пакета из B пользователей
+     * товары их профилей объединяются, и список оценивших каждый товар
+     * читается один раз на пакет, а не B раз, как при поочерёдных вызовах
+     * Predictor::neighbors. Суммы по общим товарам копятся в плотной плитке
+     * B × tileUsers, которая проходит по пользователям полосами и остаётся
+     * в кэше; сбрасываются только затронутые ячейки.
+     *
+     * Значения схожести совпадают с Similarity (на целых и полуцелых оценках
+     * — бит в бит), порядок соседей — по убыванию схожести, при равенстве —
+     * по позиции в векторе пользователей.
+     *
+     * @note Хранит ссылку на вектор пользователей: он должен жить дольше
+     *       объекта и не меняться, иначе индекс нужно построить заново.
+     */
+    class BatchSimilarity {
+    public:
+        /**
+         * @struct Options
+         * @brief Размеры пакета и плитки
+         */
+        struct Options {
+            std::size_t batchSize = 32;     ///< Пользователей в пакете
+            std::size_t tileUsers = 1024;   ///< Ширина плитки аккумуляторов (пользователей)
+            std::size_t threads = 0;        ///< Потоки по пакетам; 0 — весь общий пул
+        };
+
+        /**
+         * @brief Строит оба CSR-представления; O(R log R) по числу оценок.
+         * @throws std::length_error Если пользователей или товаров больше 2³² − 1
+         */
+        explicit BatchSimilarity(const std::vector<User>& users);
+
+        /**
+         * @brief Соседи с положительной схожестью для каждого из queries.
+         *
+         * @param queries Индексы пользователей в векторе, переданном в конструктор
+         * @param metric Метрика схожести
+         * @return Для каждого запроса — соседи как у Predictor::neighbors
+         * @throws std::out_of_range Если индекс запроса вне вектора пользователей
+         */
+        std::vector<std::vector<Neighbor>> neighbors(const std::vector<std::size_t>& queries,
+                                                     Predictor::Metric metric,
+                                                     const Options& options) const;
+
+        /// То же с параметрами по умолчанию.
+        std::vector<std::vector<Neighbor>> neighbors(const std::vector<std::size_t>& queries,
+                                                     Predictor::Metric metric) const {
+            return neighbors(queries, metric, Options{});
+        }
+
+        /// Число пользователей.
+        std::size_t userCount() const { return userOffsets_.size() - 1; }
+
+        /// Число различных товаров.
+        std::size_t itemCount() const { return itemOffsets_.size() - 1; }
+
+        /// Число оценок.
+        std::size_t ratingCount() const { return userItems_.size(); }
+
+        /// Оценка занятой памяти (см. MemoryReport).
+        std::size_t memoryBytes() const;
+
+    private:
+        template <class Acc>
+        void runBatch(const std::size_t* queries, std::size_t count, const Options& options,
+                      std::vector<Neighbor>* out) const;
+
+        const std::vector<User>& users_;
+        std::vector<std::size_t> userOffsets_;    ///< Начало строки пользователя в userItems_
+        std::vector<std::uint32_t> userItems_;    ///< Столбцы (товары) строк пользователей
+        std::vector<double> userScores_;          ///< Оценки в порядке userItems_
+        std::vector<std::size_t> itemOffsets_;    ///< Начало строки товара в itemUsers_
+        std::vector<std::uint32_t> itemUsers_;    ///< Индексы оценивших пользователей
+        std::vector<double> itemScores_;          ///< Оценки в порядке itemUsers_
+        std::vector<double> squaredNorms_;        ///< Σ r² по всему профилю
+    };
+
+} // namespace recsys
@@ -0,0 +1,124 @@
+#include "CoRatingIndex.h"
+#include "../Utils/MemoryReport.h"
+#include "../Utils/Tracing.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace recsys {
+
+    void CoRatingIndex::build(const std::vector<Item>& items) {
+        RECSYS_TRACE_SCOPE("corating.build", "similarity");
+        pairs_.clear();
+        for (const auto& item : items) {
+            const auto& ratings = item.getRatings();
+            for (std::size_t i = 0; i < ratings.size(); ++i) {
+                for (std::size_t j = i + 1; j < ratings.size(); ++j) {
+                    apply(ratings[i].userId, ratings[i].score,
+                          ratings[j].userId, ratings[j].score, +1);
+                }
+            }
+        }
+    }
+
+    void CoRatingIndex::addRating(const Rating& rating, const Item& item) {
+        for (const auto& other : item.getRatings()) {
+            if (other.userId == rating.userId) continue;
+            apply(rating.userId, rating.score, other.userId, other.score, +1);
+        }
+    }
+
+    void CoRatingIndex::removeRating(const Rating& rating, const Item& item) {
+        for (const auto& other : item.getRatings()) {
+            if (other.userId == rating.userId) continue;
+            apply(rating.userId, rating.score, other.userId, other.score, -1);
+        }
+    }
+
+    void CoRatingIndex::apply(int userA, double x, int userB, double y, int sign) {
+        if (userA > userB) {
+            std::swap(userA, userB);
+            std::swap(x, y);
+        }
+
+        auto key = std::make_pair(userA, userB);
+        if (sign < 0) {
+            auto it = pairs_.find(key);
+            if (it == pairs_.end()) return;
+            if (--it->second.count == 0) {
+                pairs_.erase(it);
+                return;
+            }
+            auto& s = it->second;
+            s.sumA -= x;
+            s.sumB -= y;
+            s.sumAA -= x * x;
+            s.sumBB -= y * y;
+            s.sumAB -= x * y;
+            s.sumAbsDiff -= std::abs(x - y);
+            return;
+        }
+
+        auto& s = pairs_[key];
+        ++s.count;
+        s.sumA += x;
+        s.sumB += y;
+        s.sumAA += x * x;
+        s.sumBB += y * y;
+        s.sumAB += x * y;
+        s.sumAbsDiff += std::abs(x - y);
+    }
+
+    std::optional<CoRatingIndex::PairStats> CoRatingIndex::find(int userA, int userB) const {
+        bool swapped = userA > userB;
+        auto key = swapped ? std::make_pair(userB, userA) : std::make_pair(userA, userB);
+        auto it = pairs_.find(key);
+        if (it == pairs_.end()) return std::nullopt;
+
+        PairStats s = it->second;
+        if (swapped) {
+            std::swap(s.sumA, s.sumB);
+            std::swap(s.sumAA, s.sumBB);
+        }
+        return s;
+    }
+
+    double CoRatingIndex::cosine(const User& a, const User& b) const {
+        double norm1 = a.getSquaredNorm();
+        double norm2 = b.getSquaredNorm();
+        if (norm1 <= 0.0 || norm2 <= 0.0) return 0.0;
+
+        auto s = find(a.getId(), b.getId());
+        if (!s) return 0.0;
+        return s->sumAB / (std::sqrt(norm1) * std::sqrt(norm2));
+    }
+
+    double CoRatingIndex::pearson(const User& a, const User& b) const {
+        auto s = find(a.getId(), b.getId());
+        if (!s) return 0.0;
+        int n = s->count;
+        if (n == 1) return 1.0;
+
+        double num = s->sumAB - (s->sumA * s->sumB / n);
+        double var = (s->sumAA - s->sumA * s->sumA / n) * (s->sumBB - s->sumB * s->sumB / n);
+        return (var <= 0.0) ? 0.0 : num / std::sqrt(var);
+    }
+
+    double CoRatingIndex::jaccard(const User& a, const User& b) const {
+        auto s = find(a.getId(), b.getId());
+        int inter = s ? s->count : 0;
+        int uni = static_cast<int>(a.getRatings().size() + b.getRatings().size()) - inter;
+        return uni == 0 ? 0.0 : static_cast<double>(inter) / uni;
+    }
+
+    double CoRatingIndex::manhattan(const User& a, const User& b) const {
+        auto s = find(a.getId(), b.getId());
+        if (!s) return 0.0;
+        return 1.0 / (1.0 + std::max(0.0, s->sumAbsDiff));
+    }
+
+    std::size_t CoRatingIndex::memoryBytes() const {
+        return MemoryReport::bytesOf(pairs_);
+    }
+
+} // namespace recsys
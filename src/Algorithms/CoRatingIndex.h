@@ -0,0 +1,102 @@
+/**
+ * @file CoRatingIndex.h
+ * @brief Инкрементально поддерживаемые суммы по общим оценкам пар пользователей.
+ */
+
+#pragma once
+
+#include "../Models/User.h"
+#include "../Models/Item.h"
+#include "../Utils/Cache.h"
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class CoRatingIndex
+     * @brief Для каждой пары пользователей с общими товарами хранит суммы по этим товарам.
+     *
+     * Суммы позволяют получить косинус, Пирсона, Жаккара и манхэттенскую
+     * схожесть за O(1) (с нормами из User::getSquaredNorm и размерами профилей).
+     * Добавление или удаление оценки (u, i) обновляет только пары (u, v)
+     * для пользователей v, оценивших товар i, — O(число оценок товара).
+     *
+     * @note Суммы обновляются вычитанием, поэтому при долгой работе накапливается
+     *       погрешность порядка машинного эпсилона на операцию; пара удаляется
+     *       целиком, когда у неё не остаётся общих товаров.
+     */
+    class CoRatingIndex {
+    public:
+        /**
+         * @struct PairStats
+         * @brief Суммы по общим товарам пары (A, B).
+         */
+        struct PairStats {
+            int count = 0;            ///< Число общих товаров
+            double sumA = 0.0;        ///< Σ r_A
+            double sumB = 0.0;        ///< Σ r_B
+            double sumAA = 0.0;       ///< Σ r_A²
+            double sumBB = 0.0;       ///< Σ r_B²
+            double sumAB = 0.0;       ///< Σ r_A·r_B
+            double sumAbsDiff = 0.0;  ///< Σ |r_A − r_B|
+        };
+
+        /**
+         * @brief Перестраивает индекс с нуля по оценкам товаров.
+         * @param items Все товары; стоимость O(Σ n_i²)
+         */
+        void build(const std::vector<Item>& items);
+
+        /**
+         * @brief Учитывает новую оценку пользователя.
+         *
+         * @param rating Добавленная оценка
+         * @param item Товар rating.itemId; оценка самого rating.userId в нём игнорируется
+         */
+        void addRating(const Rating& rating, const Item& item);
+
+        /**
+         * @brief Исключает оценку пользователя.
+         *
+         * @param rating Удаляемая оценка (с прежним значением score)
+         * @param item Товар rating.itemId; оценка самого rating.userId в нём игнорируется
+         */
+        void removeRating(const Rating& rating, const Item& item);
+
+        /**
+         * @brief Суммы пары, ориентированные так, что A = userA.
+         * @return std::nullopt, если общих товаров нет
+         */
+        std::optional<PairStats> find(int userA, int userB) const;
+
+        /// Косинусная близость (как Similarity::cosine).
+        double cosine(const User& a, const User& b) const;
+
+        /// Корреляция Пирсона по общим товарам (как Similarity::pearson).
+        double pearson(const User& a, const User& b) const;
+
+        /// Мера Жаккара (как Similarity::jaccard).
+        double jaccard(const User& a, const User& b) const;
+
+        /// Манхэттенская схожесть (как Similarity::manhattan).
+        double manhattan(const User& a, const User& b) const;
+
+        /// Число пар с хотя бы одним общим товаром.
+        std::size_t pairCount() const { return pairs_.size(); }
+
+        /// Оценка занятой памяти (см. MemoryReport).
+        std::size_t memoryBytes() const;
+
+        /// Удаляет все пары.
+        void clear() { pairs_.clear(); }
+
+    private:
+        /// Применяет вклад (x — оценка userA, y — оценка userB) со знаком sign.
+        void apply(int userA, double x, int userB, double y, int sign);
+
+        std::unordered_map<std::pair<int, int>, PairStats, pair_hash> pairs_; ///< (min, max) → суммы
+    };
+
+} // namespace recsys
@@ -0,0 +1,365 @@
+#include "CrossValidation.h"
+#include "Evaluation.h"
+#include "Recommender.h"
+#include "../Models/Item.h"
+#include "../Utils/EpochSet.h"
+#include "../Utils/Parallel.h"
+#include "../Utils/Tracing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace recsys {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double msSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        using FoldModel = CrossValidation::Folds::Model;
+
+        FoldModel buildModel(const std::vector<User>& users,
+                             const RatingView& view,
+                             const std::vector<std::uint8_t>& ids,
+                             int fold,
+                             CrossValidation::Split split,
+                             bool withItems) {
+            RECSYS_TRACE_SCOPE("cv.build_fold", "evaluation");
+            FoldModel model;
+            model.users.reserve(users.size());
+            std::unordered_map<int, std::size_t> itemIndex;
+
+            for (std::size_t j = 0; j < users.size(); ++j) {
+                User user(users[j].getId());
+                for (std::size_t r = view.userOffsets[j]; r < view.userOffsets[j + 1]; ++r) {
+                    if (!CrossValidation::isTrain(ids[r], fold, split)) continue;
+                    const Rating& rating = *view.ratings[r];
+                    user.addRating(rating);
+                    ++model.trainSize;
+
+                    if (withItems) {
+                        auto [it, inserted] = itemIndex.try_emplace(rating.itemId, model.items.size());
+                        if (inserted) model.items.emplace_back(rating.itemId);
+                        model.items[it->second].addRating(rating);
+                    }
+                }
+                model.users.push_back(std::move(user));
+            }
+            return model;
+        }
+
+        void validate(const CrossValidation::Config& config) {
+            if (config.k <= 0) throw std::invalid_argument("k must be positive");
+            if (config.alpha < 0.0 || config.alpha > 1.0) throw std::invalid_argument("alpha must be in [0, 1]");
+        }
+
+    } // namespace
+
+    RatingView RatingView::of(const std::vector<User>& users) {
+        RatingView view;
+        view.userOffsets.reserve(users.size() + 1);
+        view.userOffsets.push_back(0);
+
+        std::size_t total = 0;
+        for (const auto& u : users) total += u.getRatings().size();
+        view.ratings.reserve(total);
+
+        for (const auto& u : users) {
+            for (const auto& [itemId, r] : u.getRatings()) view.ratings.push_back(&r);
+            view.userOffsets.push_back(view.ratings.size());
+        }
+        return view;
+    }
+
+    std::vector<std::uint8_t> CrossValidation::assignFolds(const RatingView& view,
+                                                           Split split,
+                                                           int folds,
+                                                           unsigned seed) {
+        if (folds < 2 || folds > 255) {
+            throw std::invalid_argument("Number of folds must be in [2, 255]");
+        }
+
+        const std::size_t n = view.size();
+        std::vector<std::uint8_t> ids(n);
+        std::mt19937 rng(seed);
+
+        switch (split) {
+            case Split::Random: {
+                // Перемешанная перестановка, нарезанная по кругу: фолды отличаются не более чем на 1
+                std::vector<std::size_t> order(n);
+                std::iota(order.begin(), order.end(), 0);
+                std::shuffle(order.begin(), order.end(), rng);
+                for (std::size_t pos = 0; pos < n; ++pos) {
+                    ids[order[pos]] = static_cast<std::uint8_t>(pos % folds);
+                }
+                break;
+            }
+            case Split::PerUser: {
+                // Внутри пользователя — та же схема со случайным сдвигом,
+                // чтобы малые профили не складывались в первые фолды
+                std::vector<std::size_t> order;
+                for (std::size_t j = 0; j + 1 < view.userOffsets.size(); ++j) {
+                    std::size_t begin = view.userOffsets[j], end = view.userOffsets[j + 1];
+                    order.resize(end - begin);
+                    std::iota(order.begin(), order.end(), begin);
+                    std::shuffle(order.begin(), order.end(), rng);
+                    std::size_t offset = rng() % folds;
+                    for (std::size_t pos = 0; pos < order.size(); ++pos) {
+                        ids[order[pos]] = static_cast<std::uint8_t>((offset + pos) % folds);
+                    }
+                }
+                break;
+            }
+            case Split::Temporal: {
+                // folds + 1 хронологических отрезков равного размера
+                std::vector<std::size_t> order(n);
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                    return view.ratings[a]->timestamp < view.ratings[b]->timestamp;
+                });
+                const std::size_t chunks = static_cast<std::size_t>(folds) + 1;
+                for (std::size_t pos = 0; pos < n; ++pos) {
+                    ids[order[pos]] = static_cast<std::uint8_t>(pos * chunks / n);
+                }
+                break;
+            }
+        }
+        return ids;
+    }
+    CrossValidation::Folds CrossValidation::prepare(const std::vector<User>& users,
+                                                    const Config& config,
+                                                    bool withItems,
+                                                    Timings& timings) {
+        Folds p;
+
+        // --- 1. Разбиение ---
+        auto phaseStart = Clock::now();
+        p.view = RatingView::of(users);
+        p.ids = assignFolds(p.view, config.split, config.folds, config.seed);
+        timings.splitMs = msSince(phaseStart);
+
+        // --- 2. Модели фолдов ---
+        phaseStart = Clock::now();
+        p.models.resize(config.folds);
+        parallelFor(p.models.size(), [&](std::size_t f) {
+            auto start = Clock::now();
+            p.models[f] = buildModel(users, p.view, p.ids, static_cast<int>(f), config.split, withItems);
+            p.models[f].buildMs = msSince(start);
+        }, config.threads);
+        timings.buildMs = msSince(phaseStart);
+
+        // Тестовые оценки раскладываются по фолдам подряд: оценки задачи
+        // образуют непрерывный отрезок, а фолд — срез столбца предсказаний
+        p.foldOffsets.push_back(0);
+        for (int f = 0; f < config.folds; ++f) {
+            for (std::size_t j = 0; j < users.size(); ++j) {
+                const std::size_t begin = p.testOrder.size();
+                for (std::size_t r = p.view.userOffsets[j]; r < p.view.userOffsets[j + 1]; ++r) {
+                    if (isTest(p.ids[r], f, config.split)) p.testOrder.push_back(r);
+                }
+                if (p.testOrder.size() > begin) p.tasks.push_back({f, j, begin, p.testOrder.size()});
+            }
+            p.foldOffsets.push_back(p.testOrder.size());
+        }
+        return p;
+    }
+/**
+     * @brief Выполняет k-fold кросс-валидацию
+     *
+     * @details Фазы:
+     * 1. Разбиение: массив номеров фолдов поверх RatingView.
+     * 2. Построение моделей: по одной на фолд, фолды строятся параллельно.
+     * 3. Предсказание: задачи (фолд, пользователь) раздаются потокам динамически;
+     *    каждая пишет в свой отрезок столбца предсказаний, поэтому синхронизация не нужна.
+     * 4. Метрики: Evaluation::computeErrors по срезу столбца каждого фолда
+     *    и по всему столбцу; слияние блоков детерминировано.
+     */
+
+    CrossValidation::Report CrossValidation::run(const std::vector<User>& users, const Config& config) {
+        validate(config);
+        const auto runStart = Clock::now();
+        Report report;
+
+        const bool needUser = config.algorithm != Algorithm::ItemBased;
+        const bool needItem = config.algorithm != Algorithm::UserBased;
+        Predictor::Options options = config.options;
+        options.useCache = false; // модели фолдов живут только во время прогона
+
+        Folds prepared = prepare(users, config, needItem, report.timings);
+        const RatingView& view = prepared.view;
+        const auto& models = prepared.models;
+        const auto& tasks = prepared.tasks;
+
+        report.folds.resize(config.folds);
+        for (int f = 0; f < config.folds; ++f) {
+            report.folds[f].fold = f;
+            report.folds[f].trainSize = models[f].trainSize;
+            report.folds[f].timings.buildMs = models[f].buildMs;
+        }
+
+        // --- 3. Предсказания ---
+        // Столбцы выровнены с testOrder; NaN — предсказать не удалось
+        auto phaseStart = Clock::now();
+        const auto& testOrder = prepared.testOrder;
+        std::vector<double> predicted(testOrder.size(), std::numeric_limits<double>::quiet_NaN());
+        std::vector<double> actual(testOrder.size());
+        for (std::size_t i = 0; i < testOrder.size(); ++i) actual[i] = view.ratings[testOrder[i]]->score;
+
+        std::vector<double> taskMs(tasks.size(), 0.0);
+
+        parallelFor(tasks.size(), [&](std::size_t t) {
+            auto start = Clock::now();
+            const Folds::Task& task = tasks[t];
+            const FoldModel& model = models[task.fold];
+            const User& target = model.users[task.user];
+            if (target.getRatings().empty()) return; // холодный старт: предсказания нет
+
+            std::vector<Neighbor> nbrs;
+            if (needUser) nbrs = Predictor::neighbors(target, model.users, config.metric);
+
+            for (std::size_t pos = task.begin; pos < task.end; ++pos) {
+                const Rating& rating = *view.ratings[testOrder[pos]];
+
+                double userPred = needUser
+                    ? Predictor::predictFromNeighbors(target, nbrs, rating.itemId, config.k, options) : 0.0;
+                double itemPred = needItem
+                    ? Predictor::predictItemBased(target.getId(), rating.itemId, model.users, model.items,
+                                                  config.k, options) : 0.0;
+
+                double value = 0.0;
+                switch (config.algorithm) {
+                    case Algorithm::UserBased: value = userPred; break;
+                    case Algorithm::ItemBased: value = itemPred; break;
+                    case Algorithm::Hybrid: value = config.alpha * userPred + (1.0 - config.alpha) * itemPred; break;
+                }
+                if (value > 0.0) predicted[pos] = value;
+            }
+            taskMs[t] = msSince(start);
+        }, config.threads);
+
+        for (std::size_t t = 0; t < tasks.size(); ++t) {
+            report.folds[tasks[t].fold].timings.predictMs += taskMs[t];
+        }
+        report.timings.predictMs = msSince(phaseStart);
+
+        // --- 4. Метрики ---
+        phaseStart = Clock::now();
+        for (auto& fold : report.folds) {
+            auto start = Clock::now();
+            const std::size_t begin = prepared.foldOffsets[fold.fold];
+            const std::size_t end = prepared.foldOffsets[fold.fold + 1];
+            auto errors = Evaluation::computeErrors(predicted.data() + begin, actual.data() + begin,
+                                                    end - begin, config.threads);
+            fold.testSize = end - begin;
+            fold.predicted = errors.count;
+            fold.mae = errors.mae;
+            fold.rmse = errors.rmse;
+            fold.timings.scoreMs = msSince(start);
+        }
+        auto pooled = Evaluation::computeErrors(predicted, actual, config.threads);
+        report.testSize = testOrder.size();
+        report.predicted = pooled.count;
+        report.mae = pooled.mae;
+        report.rmse = pooled.rmse;
+        report.timings.scoreMs = msSince(phaseStart);
+        report.timings.totalMs = msSince(runStart);
+        return report;
+    }
+
+/**
+     * @brief Оценивает качество top-N списков на отложенных оценках
+     *
+     * @details Для каждой задачи (фолд, пользователь) список строится по модели
+     * фолда среди всех её товаров, которые пользователь не оценил в обучении;
+     * релевантны тестовые оценки не ниже relevanceThreshold (отсортированный
+     * массив ID). Каждая задача накапливает метрики в свой аккумулятор,
+     * аккумуляторы сливаются по фолдам в порядке задач.
+     */
+
+    CrossValidation::RankingReport CrossValidation::runRanking(const std::vector<User>& users,
+                                                               const Config& config,
+                                                               int topN,
+                                                               double relevanceThreshold) {
+        validate(config);
+        if (topN <= 0) throw std::invalid_argument("topN must be positive");
+        const auto runStart = Clock::now();
+        RankingReport report;
+
+        const bool needUser = config.algorithm != Algorithm::ItemBased;
+        Predictor::Options options = config.options;
+        options.useCache = false;
+
+        // Кандидаты берутся из товаров модели, поэтому они нужны при любом алгоритме
+        Folds prepared = prepare(users, config, true, report.timings);
+        const RatingView& view = prepared.view;
+        const auto& tasks = prepared.tasks;
+
+        auto phaseStart = Clock::now();
+        std::vector<RankingMetrics::Accumulator> partial(tasks.size());
+
+        parallelFor(tasks.size(), [&](std::size_t t) {
+            const Folds::Task& task = tasks[t];
+            const FoldModel& model = prepared.models[task.fold];
+            const User& target = model.users[task.user];
+
+            std::vector<int> relevant;
+            for (std::size_t pos = task.begin; pos < task.end; ++pos) {
+                const Rating& rating = *view.ratings[prepared.testOrder[pos]];
+                if (rating.score >= relevanceThreshold) relevant.push_back(rating.itemId);
+            }
+            if (relevant.empty()) return;
+            std::sort(relevant.begin(), relevant.end());
+
+            std::vector<std::pair<int, double>> recs;
+            if (!target.getRatings().empty()) {
+                std::vector<Neighbor> nbrs;
+                if (needUser) nbrs = Predictor::neighbors(target, model.users, config.metric);
+
+                if (config.algorithm == Algorithm::UserBased) {
+                    recs = Recommender::recommendFromNeighbors(target, nbrs, model.items, topN, config.k, options);
+                } else {
+                    const EpochSet& excluded = Recommender::scratchExclusions(target);
+                    std::vector<std::pair<int, double>> scored;
+                    scored.reserve(model.items.size());
+                    for (const auto& item : model.items) {
+                        const int itemId = item.getId();
+                        if (excluded.contains(itemId)) continue;
+                        double userPred = needUser
+                            ? Predictor::predictFromNeighbors(target, nbrs, itemId, config.k, options) : 0.0;
+                        double itemPred = Predictor::predictItemBased(target.getId(), itemId, model.users,
+                                                                      model.items, config.k, options);
+                        scored.emplace_back(itemId, config.algorithm == Algorithm::Hybrid
+                            ? config.alpha * userPred + (1.0 - config.alpha) * itemPred
+                            : itemPred);
+                    }
+                    recs = Recommender::selectTopN(std::move(scored), topN);
+                }
+            }
+            // Пользователь без рекомендаций (холодный старт) входит в среднее с нулями
+            partial[t].add(recs, relevant, topN);
+        }, config.threads);
+        report.timings.predictMs = msSince(phaseStart);
+
+        phaseStart = Clock::now();
+        std::vector<RankingMetrics::Accumulator> perFold(config.folds);
+        RankingMetrics::Accumulator total;
+        for (std::size_t t = 0; t < tasks.size(); ++t) {
+            perFold[tasks[t].fold].merge(partial[t]);
+            total.merge(partial[t]);
+        }
+        for (const auto& acc : perFold) report.folds.push_back(acc.result());
+        report.metrics = total.result();
+        report.timings.scoreMs = msSince(phaseStart);
+        report.timings.totalMs = msSince(runStart);
+        return report;
+    }
+
+} // namespace recsys
@@ -0,0 +1,250 @@
+/**
+ * @file CrossValidation.h
+ * @brief Оценка точности предсказаний на отложенных оценках (k-fold).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Predictor.h"
+#include "RankingMetrics.h"
+#include "../Models/Item.h"
+#include "../Models/User.h"
+
+namespace recsys {
+
+    /**
+     * @struct RatingView
+     * @brief Плоское представление оценок без копирования: указатели на Rating внутри User.
+     *
+     * Оценки пользователя users[j] занимают отрезок
+     * [userOffsets[j], userOffsets[j + 1]) массива ratings.
+     * Действительно, пока исходный вектор пользователей не изменяется.
+     */
+    struct RatingView {
+        std::vector<const Rating*> ratings;     ///< Оценки, сгруппированные по пользователям
+        std::vector<std::size_t> userOffsets;   ///< Начало оценок каждого пользователя (+ конец)
+
+        /// Строит представление по вектору пользователей.
+        static RatingView of(const std::vector<User>& users);
+
+        /// Число оценок.
+        std::size_t size() const { return ratings.size(); }
+    };
+
+    /**
+     * @class CrossValidation
+     * @brief k-fold кросс-валидация user-based, item-based и гибридного предсказания.
+     *
+     * Разбиение задаётся массивом номеров фолдов, выровненным с RatingView:
+     * сами оценки не копируются и не перемешиваются. Для каждого фолда
+     * строится своя обучающая модель (пользователи без оценок теста),
+     * после чего предсказания для всех пар (фолд, пользователь) считаются
+     * параллельно: соседи пользователя ищутся один раз на все его тестовые
+     * оценки. Результаты пишутся в столбец предсказаний, выровненный с
+     * разбиением, и сводятся в MAE/RMSE по фолдам.
+     *
+     * Нулевое предсказание означает «предсказать не удалось» (нет соседей,
+     * холодный старт) и в ошибку не входит, а учитывается в покрытии.
+     */
+    class CrossValidation {
+    public:
+        /**
+         * @enum Split
+         * @brief Способ разбиения оценок на фолды
+         */
+        enum class Split {
+            Random,    ///< Каждая оценка попадает в случайный фолд (фолды равного размера)
+            PerUser,   ///< Оценки каждого пользователя равномерно распределены по фолдам
+            Temporal   ///< Хронологические отрезки: фолд f обучается на отрезках 0..f, тест — отрезок f+1
+        };
+
+        /**
+         * @enum Algorithm
+         * @brief Оцениваемый алгоритм предсказания
+         */
+        enum class Algorithm {
+            UserBased,  ///< Predictor::predict
+            ItemBased,  ///< Predictor::predictItemBased
+            Hybrid      ///< alpha·user + (1 − alpha)·item, как в Recommender::recommendHybrid
+        };
+
+        /**
+         * @struct Config
+         * @brief Параметры прогона
+         */
+        struct Config {
+            Split split = Split::Random;
+            int folds = 5;                                        ///< Число фолдов (2..255)
+            Algorithm algorithm = Algorithm::UserBased;
+            int k = 5;                                            ///< Число соседей
+            Predictor::Metric metric = Predictor::Metric::Cosine; ///< Метрика user-based части
+            Predictor::Options options;                           ///< Политики; кэш всегда отключён
+            double alpha = 0.5;                                   ///< Вес user-based части гибрида
+            unsigned seed = 42;                                   ///< Зерно случайного разбиения
+            std::size_t threads = 0;                              ///< Потоки; 0 — весь общий пул
+        };
+
+        /**
+         * @struct Timings
+         * @brief Время фаз в миллисекундах
+         *
+         * Для фолда buildMs и predictMs — суммарное процессорное время его задач;
+         * для отчёта целиком — настенное время фаз.
+         */
+        struct Timings {
+            double splitMs = 0.0;    ///< Разбиение на фолды
+            double buildMs = 0.0;    ///< Построение обучающих моделей
+            double predictMs = 0.0;  ///< Предсказание тестовых оценок
+            double scoreMs = 0.0;    ///< Подсчёт метрик
+            double totalMs = 0.0;    ///< Весь прогон
+        };
+
+        /**
+         * @struct FoldResult
+         * @brief Метрики одного фолда
+         */
+        struct FoldResult {
+            int fold = 0;
+            std::size_t trainSize = 0;  ///< Оценок в обучающей модели
+            std::size_t testSize = 0;   ///< Отложенных оценок
+            std::size_t predicted = 0;  ///< Из них удалось предсказать
+            double mae = 0.0;
+            double rmse = 0.0;
+            Timings timings;
+        };
+
+        /**
+         * @struct Report
+         * @brief Итог прогона: метрики по фолдам и по всем тестовым оценкам
+         */
+        struct Report {
+            std::vector<FoldResult> folds;
+            std::size_t testSize = 0;
+            std::size_t predicted = 0;
+            double mae = 0.0;   ///< По всем предсказанным оценкам всех фолдов
+            double rmse = 0.0;
+            Timings timings;
+
+            /// Доля тестовых оценок, для которых нашлось предсказание.
+            double coverage() const {
+                return testSize > 0 ? static_cast<double>(predicted) / testSize : 0.0;
+            }
+        };
+
+        /**
+         * @struct RankingReport
+         * @brief Метрики top-N списков по фолдам и по всем пользователям
+         */
+        struct RankingReport {
+            std::vector<RankingMetrics::Result> folds;
+            RankingMetrics::Result metrics;  ///< Среднее по всем парам (фолд, пользователь)
+            Timings timings;                 ///< predictMs — построение списков и метрик
+        };
+
+        /**
+         * @struct Folds
+         * @brief Разбиение, обучающие модели фолдов и задачи предсказания.
+         *
+         * Тестовые оценки раскладываются в testOrder по фолдам, внутри фолда —
+         * по пользователям, поэтому оценки задачи и тестовая часть фолда
+         * образуют непрерывные отрезки.
+         */
+        struct Folds {
+            /**
+             * @struct Model
+             * @brief Обучающая модель фолда.
+             *
+             * users[j] соответствует users[j] исходного вектора (возможно, без оценок),
+             * поэтому тестовую оценку можно сопоставить пользователю модели по индексу.
+             */
+            struct Model {
+                std::vector<User> users;
+                std::vector<Item> items;     ///< Пусто, если модель строилась без товаров
+                std::size_t trainSize = 0;   ///< Оценок в модели
+                double buildMs = 0.0;        ///< Время построения
+            };
+
+            /// Задача предсказания: тестовые оценки одного пользователя в одном фолде.
+            struct Task {
+                int fold;
+                std::size_t user;   ///< Индекс пользователя в исходном векторе
+                std::size_t begin;  ///< Отрезок [begin, end) оценок задачи в testOrder
+                std::size_t end;
+            };
+
+            RatingView view;
+            std::vector<std::uint8_t> ids;          ///< Номера фолдов, выровненные с view
+            std::vector<Model> models;
+            std::vector<Task> tasks;
+            std::vector<std::size_t> testOrder;     ///< Индексы тестовых оценок в view
+            std::vector<std::size_t> foldOffsets;   ///< Начало тестовой части каждого фолда (+ конец)
+        };
+
+        /**
+         * @brief Назначает каждой оценке номер фолда (для Temporal — номер отрезка 0..folds).
+         *
+         * @param view Оценки
+         * @param split Способ разбиения
+         * @param folds Число фолдов
+         * @param seed Зерно генератора (для Temporal не используется)
+         * @return Массив номеров, выровненный с view.ratings
+         * @throws std::invalid_argument Если folds вне диапазона [2, 255]
+         */
+        static std::vector<std::uint8_t> assignFolds(const RatingView& view,
+                                                     Split split,
+                                                     int folds,
+                                                     unsigned seed);
+
+        /// Входит ли оценка с номером id в тестовую часть фолда fold.
+        static bool isTest(std::uint8_t id, int fold, Split split) {
+            return split == Split::Temporal ? id == fold + 1 : id == fold;
+        }
+
+        /// Входит ли оценка с номером id в обучающую часть фолда fold.
+        static bool isTrain(std::uint8_t id, int fold, Split split) {
+            return split == Split::Temporal ? id <= fold : id != fold;
+        }
+
+        /**
+         * @brief Разбивает оценки и параллельно строит модели фолдов.
+         *
+         * @param users Все пользователи с оценками
+         * @param config Параметры разбиения (split, folds, seed, threads)
+         * @param withItems Строить ли в моделях векторы товаров
+         * @param timings Сюда пишутся splitMs и buildMs
+         */
+        static Folds prepare(const std::vector<User>& users,
+                             const Config& config,
+                             bool withItems,
+                             Timings& timings);
+
+        /**
+         * @brief Выполняет кросс-валидацию.
+         *
+         * @param users Все пользователи с оценками
+         * @param config Параметры прогона
+         * @return Метрики и время фаз
+         * @throws std::invalid_argument При некорректных параметрах
+         */
+        static Report run(const std::vector<User>& users, const Config& config);
+
+        /**
+         * @brief Оценивает top-N рекомендации метриками ранжирования.
+         *
+         * @param users Все пользователи с оценками
+         * @param config Параметры прогона
+         * @param topN Длина списка рекомендаций и отсечение K метрик
+         * @param relevanceThreshold Минимальная отложенная оценка релевантного товара
+         * @return Precision/recall/NDCG/MAP/MRR по фолдам и в целом
+         * @throws std::invalid_argument При некорректных параметрах
+         */
+        static RankingReport runRanking(const std::vector<User>& users,
+                                        const Config& config,
+                                        int topN = 10,
+                                        double relevanceThreshold = 4.0);
+    };
+
+} // namespace recsys
@@ -0,0 +1,98 @@
+#include "DecayTable.h"
+#include "../Utils/MemoryReport.h"
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace recsys {
+
+    namespace {
+
+        /**
+         * @struct TableCache
+         * @brief Процессный кэш таблиц по периоду полураспада
+         *
+         * Хранит не больше DecayTable::kCachedTables таблиц; в начале — последняя
+         * использованная, вытесняется давно не использованная. Вытесненная таблица
+         * живёт, пока её держат вызывающие.
+         */
+        struct TableCache {
+            std::mutex mutex;
+            std::vector<std::pair<double, std::shared_ptr<const DecayTable>>> tables;
+        };
+
+        TableCache& tableCache() {
+            static TableCache cache;
+            return cache;
+        }
+
+    } // namespace
+/**
+     * @brief Строит таблицу весов затухания
+     *
+     * @details Вес корзины вычисляется в её середине:
+     * \f[
+     * w_j = 2^{-\frac{j + 0.5}{B}}
+     * \f]
+     * где \f$B\f$ — число корзин на период полураспада.
+     */
+
+    DecayTable::DecayTable(double halfLifeSeconds,
+                           std::size_t bucketsPerHalfLife,
+                           std::size_t halfLives)
+        : halfLife_(halfLifeSeconds) {
+        if (!(halfLifeSeconds > 0.0) || bucketsPerHalfLife == 0 || halfLives == 0) {
+            throw std::invalid_argument("DecayTable parameters must be positive");
+        }
+
+        invBucketWidth_ = static_cast<double>(bucketsPerHalfLife) / halfLifeSeconds;
+        weights_.resize(bucketsPerHalfLife * halfLives);
+        for (std::size_t j = 0; j < weights_.size(); ++j) {
+            double halfLivesElapsed = (static_cast<double>(j) + 0.5) / bucketsPerHalfLife;
+            weights_[j] = std::exp2(-halfLivesElapsed);
+        }
+    }
+/**
+     * @brief Возвращает общую таблицу для периода полураспада
+     *
+     * @param halfLifeSeconds Период полураспада (в секундах)
+     * @return Разделяемый указатель на неизменяемую таблицу
+     */
+
+    std::shared_ptr<const DecayTable> DecayTable::forHalfLife(double halfLifeSeconds) {
+        thread_local std::shared_ptr<const DecayTable> last;
+        if (last && last->halfLife() == halfLifeSeconds) return last;
+
+        TableCache& cache = tableCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto& tables = cache.tables;
+        auto it = std::find_if(tables.begin(), tables.end(),
+                               [&](const auto& entry) { return entry.first == halfLifeSeconds; });
+        if (it == tables.end()) {
+            auto table = std::make_shared<const DecayTable>(halfLifeSeconds);
+            if (tables.size() >= kCachedTables) tables.pop_back();
+            tables.emplace(tables.begin(), halfLifeSeconds, std::move(table));
+        } else {
+            std::rotate(tables.begin(), it, it + 1);
+        }
+        last = tables.front().second;
+        return last;
+    }
+
+    std::size_t DecayTable::memoryBytes() const {
+        return MemoryReport::heapBlock(sizeof(DecayTable)) + MemoryReport::bytesOf(weights_);
+    }
+
+    std::size_t DecayTable::cachedBytes(std::size_t& tables) {
+        TableCache& cache = tableCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        tables = cache.tables.size();
+        std::size_t bytes = MemoryReport::bytesOf(cache.tables);
+        for (const auto& entry : cache.tables) bytes += entry.second->memoryBytes();
+        return bytes;
+    }
+
+} // namespace recsys
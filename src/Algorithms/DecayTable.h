@@ -0,0 +1,87 @@
+/**
+ * @file DecayTable.h
+ * @brief Таблица весов временного затухания с квантованием возраста оценки.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class DecayTable
+     * @brief Предвычисленные веса w(age) = 2^(-age / halfLife).
+     *
+     * Возраст оценки квантуется в корзины фиксированной ширины
+     * (halfLife / bucketsPerHalfLife), и вес каждой корзины вычисляется один раз
+     * при построении таблицы. Во внутреннем цикле предсказания вместо std::exp
+     * выполняются одно умножение и одно чтение из массива.
+     *
+     * Относительная ошибка квантования не превышает ln2 / (2 · bucketsPerHalfLife),
+     * т.е. ~0.5% при 64 корзинах на период полураспада. Оценки старше
+     * halfLives периодов получают вес последней корзины.
+     */
+    class DecayTable {
+    public:
+        /**
+         * @brief Строит таблицу весов.
+         *
+         * @param halfLifeSeconds Период полураспада (в секундах), > 0
+         * @param bucketsPerHalfLife Число корзин на один период полураспада
+         * @param halfLives Сколько периодов полураспада покрывает таблица
+         * @throws std::invalid_argument Если параметры неположительны
+         */
+        explicit DecayTable(double halfLifeSeconds,
+                            std::size_t bucketsPerHalfLife = 64,
+                            std::size_t halfLives = 16);
+
+        /**
+         * @brief Вес оценки заданного возраста.
+         * @param ageSeconds Возраст оценки (now − timestamp); отрицательный считается нулём
+         * @return Вес в диапазоне (0, 1]
+         */
+        double weight(long ageSeconds) const {
+            if (ageSeconds <= 0) return 1.0;
+            auto idx = static_cast<std::size_t>(static_cast<double>(ageSeconds) * invBucketWidth_);
+            return idx < weights_.size() ? weights_[idx] : weights_.back();
+        }
+
+        /// Период полураспада (в секундах).
+        double halfLife() const { return halfLife_; }
+
+        /// Число корзин в таблице.
+        std::size_t size() const { return weights_.size(); }
+
+        /// Сколько таблиц держит процессный кэш forHalfLife().
+        static constexpr std::size_t kCachedTables = 16;
+
+        /**
+         * @brief Возвращает общую таблицу для заданного периода полураспада.
+         *
+         * Таблицы кэшируются процессно, не больше kCachedTables, с вытеснением
+         * давно не использованных: периоды, заданные в каждом запросе, не растят
+         * память без предела. Последняя использованная таблица дополнительно
+         * запоминается в thread_local, поэтому повторные запросы с тем же
+         * периодом не берут блокировку.
+         */
+        static std::shared_ptr<const DecayTable> forHalfLife(double halfLifeSeconds);
+
+        /// Оценка памяти таблицы (см. MemoryReport).
+        std::size_t memoryBytes() const;
+
+        /**
+         * @brief Память процессного кэша таблиц forHalfLife().
+         * @param tables Сюда пишется число закэшированных таблиц
+         */
+        static std::size_t cachedBytes(std::size_t& tables);
+
+    private:
+        double halfLife_;             ///< Период полураспада (в секундах)
+        double invBucketWidth_;       ///< 1 / ширина корзины
+        std::vector<double> weights_; ///< Вес для каждой корзины
+    };
+
+} // namespace recsys
@@ -1,7 +1,107 @@
 #include "Evaluation.h"
+#include "../Utils/Parallel.h"
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace recsys {
+
+    namespace {
+
+        /**
+         * @brief Суммирует ошибки позиций [begin, end).
+         *
+         * Четыре независимые дорожки накопления без ветвлений (NaN маскируется
+         * выбором) позволяют компилятору векторизовать цикл и убирают
+         * зависимость по сумме между соседними итерациями.
+         */
+        template <class Get>
+        Evaluation::ErrorAccumulator sumRange(std::size_t begin, std::size_t end, Get get) {
+            constexpr std::size_t kLanes = 4;
+            double abs[kLanes] = {}, sq[kLanes] = {}, diff[kLanes] = {};
+            std::size_t count[kLanes] = {};
+
+            std::size_t i = begin;
+            for (; i + kLanes <= end; i += kLanes) {
+                for (std::size_t l = 0; l < kLanes; ++l) {
+                    const auto [p, a] = get(i + l);
+                    const bool ok = p == p; // ложно только для NaN
+                    const double d = ok ? p - a : 0.0;
+                    abs[l] += std::abs(d);
+                    sq[l] += d * d;
+                    diff[l] += d;
+                    count[l] += ok;
+                }
+            }
+            for (; i < end; ++i) {
+                const auto [p, a] = get(i);
+                const bool ok = p == p;
+                const double d = ok ? p - a : 0.0;
+                abs[0] += std::abs(d);
+                sq[0] += d * d;
+                diff[0] += d;
+                count[0] += ok;
+            }
+
+            Evaluation::ErrorAccumulator sums;
+            for (std::size_t l = 0; l < kLanes; ++l) {
+                sums.abs += abs[l];
+                sums.sq += sq[l];
+                sums.diff += diff[l];
+                sums.count += count[l];
+            }
+            return sums;
+        }
+
+        /**
+         * @brief Параллельная редукция по блокам фиксированного размера.
+         *
+         * Границы блоков и порядок слияния не зависят от числа потоков,
+         * поэтому результат воспроизводим бит в бит.
+         */
+        template <class Get>
+        Evaluation::ErrorMetrics reduce(std::size_t n, Get get, std::size_t threads) {
+            constexpr std::size_t kBlock = 1 << 16;
+            Evaluation::ErrorAccumulator total = parallelReduce(
+                n, kBlock, Evaluation::ErrorAccumulator{},
+                [&](std::size_t begin, std::size_t end) { return sumRange(begin, end, get); },
+                [](Evaluation::ErrorAccumulator a, const Evaluation::ErrorAccumulator& b) {
+                    a.merge(b);
+                    return a;
+                },
+                threads);
+            return total.metrics();
+        }
+
+        /**
+         * @brief Ошибки по словарю предсказаний.
+         *
+         * Обходятся только сделанные предсказания: фактическая оценка ищется
+         * у пользователя по индексу ID, а не перебором всех оценок всех пользователей.
+         */
+        Evaluation::ErrorMetrics nestedErrors(
+            const std::vector<User>& users,
+            const std::unordered_map<int, std::unordered_map<int, double>>& predicted) {
+            std::unordered_map<int, const User*> byId;
+            byId.reserve(users.size());
+            for (const auto& u : users) byId.emplace(u.getId(), &u);
+
+            Evaluation::ErrorAccumulator sums;
+            for (const auto& [userId, items] : predicted) {
+                auto itUser = byId.find(userId);
+                if (itUser == byId.end()) continue;
+                const auto& ratings = itUser->second->getRatings();
+
+                for (const auto& [itemId, value] : items) {
+                    auto itRating = ratings.find(itemId);
+                    if (itRating == ratings.end()) continue;
+                    sums.add(value, itRating->second.score);
+                }
+            }
+            return sums.metrics();
+        }
+
+    } // namespace
     /**
      * @brief Вычисляет среднюю абсолютную ошибку (MAE) между предсказанными и фактическими оценками
      * 
@@ -11,25 +111,20 @@ namespace recsys {
      * @return double Значение MAE. Возвращает 0.0 если нет совпадающих оценок.
      */
 
+    Evaluation::ErrorMetrics Evaluation::ErrorAccumulator::metrics() const {
+        ErrorMetrics m;
+        m.count = count;
+        if (count == 0) return m;
+        const double n = static_cast<double>(count);
+        m.mae = abs / n;
+        m.rmse = std::sqrt(sq / n);
+        m.bias = diff / n;
+        return m;
+    }
+
     double Evaluation::computeMAE(const std::vector<User>& users,
                                    const std::unordered_map<int, std::unordered_map<int, double>>& predicted) {
-        double totalError = 0.0;
-        int count = 0;
-
-        for (const auto& user : users) {
-            int uid = user.getId();
-            for (const auto& [itemId, actual] : user.getRatings()) {
-                auto itUser = predicted.find(uid);
-                if (itUser != predicted.end()) {
-                    auto itItem = itUser->second.find(itemId);
-                    if (itItem != itUser->second.end()) {
-                        totalError += std::abs(actual.score - itItem->second);
-                        count++;
-                    }
-                }
-            }
-        }
-        return (count > 0) ? totalError / count : 0.0;
+        return nestedErrors(users, predicted).mae;
     }
     /**
      * @brief Вычисляет среднеквадратичную ошибку (RMSE) между предсказанными и фактическими оценками
@@ -42,24 +137,38 @@ namespace recsys {
 
     double Evaluation::computeRMSE(const std::vector<User>& users,
                                    const std::unordered_map<int, std::unordered_map<int, double>>& predicted) {
-        double totalSquaredError = 0.0;
-        int count = 0;
-
-        for (const auto& user : users) {
-            int uid = user.getId();
-            for (const auto& [itemId, actual] : user.getRatings()) {
-                auto itUser = predicted.find(uid);
-                if (itUser != predicted.end()) {
-                    auto itItem = itUser->second.find(itemId);
-                    if (itItem != itUser->second.end()) {
-                        double diff = actual.score - itItem->second;
-                        totalSquaredError += diff * diff;
-                        count++;
-                    }
-                }
-            }
+        return nestedErrors(users, predicted).rmse;
+    }
+
+    Evaluation::ErrorMetrics Evaluation::computeErrors(const PredictionRecord* records,
+                                                       std::size_t count,
+                                                       std::size_t threads) {
+        return reduce(count, [records](std::size_t i) {
+            return std::pair<double, double>(records[i].predicted, records[i].actual);
+        }, threads);
+    }
+
+    Evaluation::ErrorMetrics Evaluation::computeErrors(const std::vector<PredictionRecord>& records,
+                                                       std::size_t threads) {
+        return computeErrors(records.data(), records.size(), threads);
+    }
+
+    Evaluation::ErrorMetrics Evaluation::computeErrors(const double* predicted,
+                                                       const double* actual,
+                                                       std::size_t count,
+                                                       std::size_t threads) {
+        return reduce(count, [predicted, actual](std::size_t i) {
+            return std::pair<double, double>(predicted[i], actual[i]);
+        }, threads);
+    }
+
+    Evaluation::ErrorMetrics Evaluation::computeErrors(const std::vector<double>& predicted,
+                                                       const std::vector<double>& actual,
+                                                       std::size_t threads) {
+        if (predicted.size() != actual.size()) {
+            throw std::invalid_argument("Prediction and actual columns must have the same length");
         }
-        return (count > 0) ? std::sqrt(totalSquaredError / count) : 0.0;
+        return computeErrors(predicted.data(), actual.data(), predicted.size(), threads);
     }
 
 }
@@ -1,9 +1,25 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <Models/User.h>
 
 namespace recsys {
+    /**
+     * @struct PredictionRecord
+     * @brief Одно предсказание в плоском буфере: индексы пользователя и товара, предсказание и факт.
+     *
+     * Индексы — позиции во внешних массивах пользователей/товаров
+     * (метрики ошибок их не используют, но они позволяют агрегировать по срезам).
+     */
+    struct PredictionRecord {
+        std::uint32_t userIndex;  ///< Индекс пользователя
+        std::uint32_t itemIndex;  ///< Индекс товара
+        double predicted;         ///< Предсказанная оценка; NaN — предсказания нет
+        double actual;            ///< Фактическая оценка
+    };
+
     /**
      * @class Evaluation
      * @brief Класс для оценки качества рекомендательных систем
@@ -13,6 +29,48 @@ namespace recsys {
 
     class Evaluation {
     public:
+        /**
+         * @struct ErrorMetrics
+         * @brief Метрики ошибок, считаемые за один проход
+         */
+        struct ErrorMetrics {
+            double mae = 0.0;        ///< Средняя абсолютная ошибка
+            double rmse = 0.0;       ///< Корень из средней квадратичной ошибки
+            double bias = 0.0;       ///< Средняя ошибка со знаком (predicted − actual)
+            std::size_t count = 0;   ///< Число учтённых предсказаний
+        };
+
+        /**
+         * @struct ErrorAccumulator
+         * @brief Суммы ошибок части предсказаний; сливаются в фиксированном порядке
+         */
+        struct ErrorAccumulator {
+            double abs = 0.0;
+            double sq = 0.0;
+            double diff = 0.0;
+            std::size_t count = 0;
+
+            /// Учитывает одно предсказание.
+            void add(double predicted, double actual) {
+                double d = predicted - actual;
+                abs += d < 0.0 ? -d : d;
+                sq += d * d;
+                diff += d;
+                ++count;
+            }
+
+            /// Прибавляет суммы другого аккумулятора.
+            void merge(const ErrorAccumulator& other) {
+                abs += other.abs;
+                sq += other.sq;
+                diff += other.diff;
+                count += other.count;
+            }
+
+            /// Средние значения.
+            ErrorMetrics metrics() const;
+        };
+
         /**
          * @brief Вычисляет среднюю абсолютную ошибку (MAE)
          * 
@@ -38,6 +96,48 @@ namespace recsys {
 
         static double computeRMSE(const std::vector<User>& users,
                                   const std::unordered_map<int, std::unordered_map<int, double>>& predicted);
+
+        /**
+         * @brief Метрики ошибок по плоскому буферу предсказаний
+         *
+         * Записи с предсказанием NaN пропускаются.
+         *
+         * @param records Начало буфера
+         * @param count Число записей
+         * @param threads Число потоков; 0 — весь общий пул
+         * @return MAE, RMSE и смещение за один проход
+         */
+        static ErrorMetrics computeErrors(const PredictionRecord* records,
+                                          std::size_t count,
+                                          std::size_t threads = 0);
+
+        /// То же для вектора записей.
+        static ErrorMetrics computeErrors(const std::vector<PredictionRecord>& records,
+                                          std::size_t threads = 0);
+
+        /**
+         * @brief Метрики ошибок по столбцам предсказаний и фактических оценок
+         *
+         * Столбцы выровнены между собой (например, с тестовой частью разбиения);
+         * позиции с предсказанием NaN пропускаются.
+         *
+         * @param predicted Столбец предсказаний
+         * @param actual Столбец фактических оценок
+         * @param count Длина столбцов
+         * @param threads Число потоков; 0 — весь общий пул
+         */
+        static ErrorMetrics computeErrors(const double* predicted,
+                                          const double* actual,
+                                          std::size_t count,
+                                          std::size_t threads = 0);
+
+        /**
+         * @brief То же для векторов
+         * @throws std::invalid_argument Если длины столбцов различаются
+         */
+        static ErrorMetrics computeErrors(const std::vector<double>& predicted,
+                                          const std::vector<double>& actual,
+                                          std::size_t threads = 0);
     };
 
 }
@@ -0,0 +1,241 @@
+#include "HyperparameterSweep.h"
+#include "DecayTable.h"
+#include "NeighborhoodPredictor.h"
+#include "Similarity.h"
+#include "../Utils/Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+namespace recsys {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double msSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        /**
+         * @brief Предсказания user-based части для всех k за один проход по соседям.
+         *
+         * @param ks Отсортированные без повторов значения k
+         * @param out out[i] — предсказание при k = ks[i]
+         */
+        template <class Weight, class Agg>
+        void userPrefix(const User& target, const std::vector<Neighbor>& nbrs, int itemId,
+                        const std::vector<int>& ks, const Weight& weight, double* out) {
+            Agg agg;
+            agg.begin(target);
+
+            std::size_t next = 0;
+            int taken = 0;
+            for (const auto& [sim, u_ptr] : nbrs) {
+                const auto& ratings = u_ptr->getRatings();
+                auto it = ratings.find(itemId);
+                if (it == ratings.end()) continue;
+
+                agg.add(sim, weight(it->second), it->second.score, *u_ptr);
+                ++taken;
+                if (taken == ks[next]) {
+                    out[next++] = agg.result();
+                    if (next == ks.size()) return;
+                }
+            }
+            const double last = agg.result();
+            while (next < ks.size()) out[next++] = last;
+        }
+
+        /// Выбор специализации userPrefix по политикам веса и агрегации.
+        void userPrefix(const User& target, const std::vector<Neighbor>& nbrs, int itemId,
+                        const std::vector<int>& ks, const Predictor::Options& options,
+                        const DecayTable* table, long now, double* out) {
+            const bool meanCentered = options.aggregation == Predictor::Aggregation::MeanCentered;
+            if (table) {
+                DecayTableWeight w{table, now};
+                meanCentered ? userPrefix<DecayTableWeight, MeanCentered>(target, nbrs, itemId, ks, w, out)
+                             : userPrefix<DecayTableWeight, WeightedAverage>(target, nbrs, itemId, ks, w, out);
+            } else {
+                meanCentered ? userPrefix<UniformWeight, MeanCentered>(target, nbrs, itemId, ks, UniformWeight{}, out)
+                             : userPrefix<UniformWeight, WeightedAverage>(target, nbrs, itemId, ks, UniformWeight{}, out);
+            }
+        }
+
+        /**
+         * @brief Предсказания item-based части для всех k (как Predictor::predictItemBased).
+         *
+         * Схожести с товарами пользователя считаются и сортируются один раз,
+         * дальше — префиксные суммы Σ sim·w·r и Σ sim·w.
+         */
+        void itemPrefix(const User& target, int itemId, const std::vector<User>& users,
+                        const std::vector<int>& ks, const DecayTable* table, long now, double* out) {
+            struct ItemNeighbor {
+                double sim;
+                double score;
+                double w;
+            };
+            std::vector<ItemNeighbor> sims;
+            for (const auto& [otherItemId, r] : target.getRatings()) {
+                if (otherItemId == itemId) continue;
+                double sim = Similarity::adjustedCosine(users, itemId, otherItemId);
+                if (sim > 0.0) {
+                    double w = table ? table->weight(now - static_cast<long>(r.timestamp)) : 1.0;
+                    sims.push_back({sim, r.score, w});
+                }
+            }
+            std::sort(sims.begin(), sims.end(), [](auto& a, auto& b) { return a.sim > b.sim; });
+
+            double num = 0.0, den = 0.0;
+            std::size_t next = 0;
+            int taken = 0;
+            for (const auto& n : sims) {
+                num += n.sim * n.w * n.score;
+                den += n.sim * n.w;
+                ++taken;
+                if (taken == ks[next]) {
+                    out[next++] = den > 0 ? num / den : 0.0;
+                    if (next == ks.size()) return;
+                }
+            }
+            const double last = den > 0 ? num / den : 0.0;
+            while (next < ks.size()) out[next++] = last;
+        }
+
+    } // namespace
+
+    std::size_t HyperparameterSweep::Report::best() const {
+        std::size_t best = 0;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (points[i].errors.count == 0) continue;
+            if (points[best].errors.count == 0 || points[i].errors.rmse < points[best].errors.rmse) best = i;
+        }
+        return best;
+    }
+/**
+     * @brief Выполняет перебор сетки параметров
+     *
+     * @details Задачи (фолд, пользователь) группируются в блоки фиксированного
+     * размера; у каждого блока свой массив аккумуляторов на все точки сетки.
+     * Блоки раздаются потокам динамически и сливаются в порядке номеров,
+     * поэтому таблица не зависит от числа потоков.
+     */
+
+    HyperparameterSweep::Report HyperparameterSweep::run(const std::vector<User>& users,
+                                                         const CrossValidation::Config& config,
+                                                         Grid grid) {
+        std::sort(grid.ks.begin(), grid.ks.end());
+        grid.ks.erase(std::unique(grid.ks.begin(), grid.ks.end()), grid.ks.end());
+        std::sort(grid.alphas.begin(), grid.alphas.end(), std::greater<double>());
+        grid.alphas.erase(std::unique(grid.alphas.begin(), grid.alphas.end()), grid.alphas.end());
+
+        if (grid.metrics.empty() || grid.ks.empty() || grid.alphas.empty()) {
+            throw std::invalid_argument("Sweep grid must not be empty");
+        }
+        if (grid.ks.front() <= 0) throw std::invalid_argument("k must be positive");
+        if (grid.alphas.back() < 0.0 || grid.alphas.front() > 1.0) {
+            throw std::invalid_argument("alpha must be in [0, 1]");
+        }
+
+        const auto runStart = Clock::now();
+        Report report;
+
+        const std::size_t M = grid.metrics.size(), K = grid.ks.size(), A = grid.alphas.size();
+        const bool needItem = grid.alphas.back() < 1.0;
+        const bool needUser = grid.alphas.front() > 0.0;
+
+        std::shared_ptr<const DecayTable> table;
+        long now = 0;
+        if (config.options.weighting == Predictor::Weighting::TimeDecay) {
+            if (!(config.options.halfLifeDays > 0.0)) {
+                throw std::invalid_argument("Decay half-life must be positive");
+            }
+            table = DecayTable::forHalfLife(config.options.halfLifeDays * 86400.0);
+            now = config.options.now != 0 ? config.options.now : static_cast<long>(std::time(nullptr));
+        }
+
+        auto folds = CrossValidation::prepare(users, config, needItem, report.timings);
+        report.testSize = folds.testOrder.size();
+
+        // --- Проход по всем точкам сетки ---
+        auto phaseStart = Clock::now();
+        constexpr std::size_t kTasksPerBlock = 64;
+        const std::size_t blocks = (folds.tasks.size() + kTasksPerBlock - 1) / kTasksPerBlock;
+        std::vector<std::vector<Evaluation::ErrorAccumulator>> partial(blocks);
+
+        parallelFor(blocks, [&](std::size_t b) {
+            auto& acc = partial[b];
+            acc.resize(M * K * A);
+
+            std::vector<std::vector<Neighbor>> nbrs(M);
+            std::vector<double> userPred(M * K), itemPred(K);
+
+            const std::size_t end = std::min(folds.tasks.size(), (b + 1) * kTasksPerBlock);
+            for (std::size_t t = b * kTasksPerBlock; t < end; ++t) {
+                const auto& task = folds.tasks[t];
+                const auto& model = folds.models[task.fold];
+                const User& target = model.users[task.user];
+                if (target.getRatings().empty()) continue; // холодный старт
+
+                if (needUser) {
+                    for (std::size_t m = 0; m < M; ++m) {
+                        nbrs[m] = Predictor::neighbors(target, model.users, grid.metrics[m]);
+                    }
+                }
+
+                for (std::size_t pos = task.begin; pos < task.end; ++pos) {
+                    const Rating& rating = *folds.view.ratings[folds.testOrder[pos]];
+
+                    std::fill(userPred.begin(), userPred.end(), 0.0);
+                    std::fill(itemPred.begin(), itemPred.end(), 0.0);
+                    if (needUser) {
+                        for (std::size_t m = 0; m < M; ++m) {
+                            userPrefix(target, nbrs[m], rating.itemId, grid.ks, config.options,
+                                       table.get(), now, &userPred[m * K]);
+                        }
+                    }
+                    if (needItem) {
+                        itemPrefix(target, rating.itemId, model.users, grid.ks, table.get(), now, itemPred.data());
+                    }
+
+                    for (std::size_t m = 0; m < M; ++m) {
+                        for (std::size_t ki = 0; ki < K; ++ki) {
+                            for (std::size_t ai = 0; ai < A; ++ai) {
+                                const double alpha = grid.alphas[ai];
+                                const double value = alpha * userPred[m * K + ki] + (1.0 - alpha) * itemPred[ki];
+                                if (value > 0.0) acc[(m * K + ki) * A + ai].add(value, rating.score);
+                            }
+                        }
+                    }
+                }
+            }
+        }, config.threads);
+        report.timings.predictMs = msSince(phaseStart);
+
+        // --- Слияние ---
+        phaseStart = Clock::now();
+        std::vector<Evaluation::ErrorAccumulator> total(M * K * A);
+        for (const auto& block : partial) {
+            for (std::size_t p = 0; p < total.size(); ++p) total[p].merge(block[p]);
+        }
+        for (std::size_t m = 0; m < M; ++m) {
+            for (std::size_t ki = 0; ki < K; ++ki) {
+                for (std::size_t ai = 0; ai < A; ++ai) {
+                    Point point;
+                    point.metric = grid.metrics[m];
+                    point.k = grid.ks[ki];
+                    point.alpha = grid.alphas[ai];
+                    point.errors = total[(m * K + ki) * A + ai].metrics();
+                    report.points.push_back(point);
+                }
+            }
+        }
+        report.timings.scoreMs = msSince(phaseStart);
+        report.timings.totalMs = msSince(runStart);
+        return report;
+    }
+
+} // namespace recsys
@@ -0,0 +1,82 @@
+/**
+ * @file HyperparameterSweep.h
+ * @brief Перебор k, метрики и alpha за один проход кросс-валидации.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "CrossValidation.h"
+#include "Evaluation.h"
+#include "Predictor.h"
+
+namespace recsys {
+
+    /**
+     * @class HyperparameterSweep
+     * @brief Оценивает сетку (metric × k × alpha), переиспользуя соседей и префиксные суммы.
+     *
+     * Для каждой пары (фолд, пользователь) соседи ищутся один раз на метрику.
+     * Для тестового товара список соседей, оценивших его, проходится один раз
+     * до max(k); агрегатор накапливает суммы, и его значение после первых k
+     * соседей и есть предсказание для этого k. Item-based часть считается так же:
+     * один отсортированный список похожих товаров на все k. Гибрид для каждого
+     * alpha — линейная комбинация уже готовых предсказаний.
+     *
+     * Результат каждой точки совпадает с CrossValidation::run при тех же
+     * параметрах (alpha = 1 — UserBased, alpha = 0 — ItemBased, иначе Hybrid).
+     */
+    class HyperparameterSweep {
+    public:
+        /**
+         * @struct Grid
+         * @brief Значения перебираемых параметров
+         *
+         * Перед прогоном k и alpha сортируются и очищаются от повторов.
+         */
+        struct Grid {
+            std::vector<Predictor::Metric> metrics{Predictor::Metric::Cosine};
+            std::vector<int> ks{5};
+            std::vector<double> alphas{1.0};  ///< Вес user-based части: 1 — только user, 0 — только item
+        };
+
+        /**
+         * @struct Point
+         * @brief Результат одной точки сетки
+         */
+        struct Point {
+            Predictor::Metric metric = Predictor::Metric::Cosine;
+            int k = 0;
+            double alpha = 1.0;
+            Evaluation::ErrorMetrics errors;  ///< MAE/RMSE по всем фолдам
+        };
+
+        /**
+         * @struct Report
+         * @brief Таблица результатов в порядке metric → k → alpha
+         */
+        struct Report {
+            std::vector<Point> points;
+            std::size_t testSize = 0;           ///< Тестовых оценок во всех фолдах
+            CrossValidation::Timings timings;   ///< predictMs — проход по всем точкам сразу
+
+            /// Индекс точки с наименьшим RMSE среди точек хотя бы с одним предсказанием.
+            std::size_t best() const;
+        };
+
+        /**
+         * @brief Выполняет перебор.
+         *
+         * @param users Все пользователи с оценками
+         * @param config Разбиение, потоки и политики; поля algorithm, k, metric и alpha не используются
+         * @param grid Сетка параметров
+         * @return Метрики каждой точки сетки
+         * @throws std::invalid_argument Если сетка пуста, k ≤ 0 или alpha вне [0, 1]
+         */
+        static Report run(const std::vector<User>& users,
+                          const CrossValidation::Config& config,
+                          Grid grid);
+    };
+
+} // namespace recsys
@@ -0,0 +1,222 @@
+#include "LeaveOneOut.h"
+#include "BatchSimilarity.h"
+#include "../Models/Item.h"
+#include "../Utils/Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace recsys {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double msSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        /// Небольшой генератор SplitMix64: дёшево создаётся на каждого пользователя.
+        struct SplitMix64 {
+            std::uint64_t state;
+
+            std::uint64_t next() {
+                std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            }
+
+            /// Равномерное число из [0, n).
+            std::size_t below(std::size_t n) { return static_cast<std::size_t>(next() % n); }
+        };
+
+        /**
+         * @brief Выбирает count товаров каталога, не оценённых пользователем.
+         *
+         * Если пользователь оценил меньше половины каталога и неоценённых товаров
+         * хотя бы вдвое больше, чем нужно, — отбор с отказами (в среднем меньше
+         * двух попыток на товар). Иначе перечисляются
+         * все неоценённые товары и берётся их частичная случайная перестановка.
+         */
+        std::vector<int> sampleNegatives(const User& user, const std::vector<int>& catalogue,
+                                         std::size_t count, SplitMix64& rng) {
+            const auto& rated = user.getRatings();
+            std::vector<int> result;
+            result.reserve(count);
+
+            const std::size_t unrated = catalogue.size() - std::min(catalogue.size(), rated.size());
+            if (rated.size() * 2 < catalogue.size() && count * 2 <= unrated) {
+                while (result.size() < count) {
+                    int itemId = catalogue[rng.below(catalogue.size())];
+                    if (rated.count(itemId)) continue;
+                    if (std::find(result.begin(), result.end(), itemId) != result.end()) continue;
+                    result.push_back(itemId);
+                }
+                return result;
+            }
+
+            for (int itemId : catalogue) {
+                if (!rated.count(itemId)) result.push_back(itemId);
+            }
+            count = std::min(count, result.size());
+            for (std::size_t i = 0; i < count; ++i) {
+                std::swap(result[i], result[i + rng.below(result.size() - i)]);
+            }
+            result.resize(count);
+            return result;
+        }
+
+    } // namespace
+/**
+     * @brief Выполняет оценку leave-last-out
+     *
+     * @details Фазы:
+     * 1. Отбор: для каждого пользователя ищется самая поздняя оценка.
+     * 2. Модель: копия пользователей без отложенных оценок и товары по ней.
+     * 3. Ранжирование (параллельно по пользователям): выборка негативов,
+     *    оценка negatives + 1 кандидатов, ранг отложенного товара.
+     * 4. Метрики по массиву рангов в порядке пользователей.
+     */
+
+    LeaveOneOut::Report LeaveOneOut::run(const std::vector<User>& users, const Config& config) {
+        if (config.negatives <= 0) throw std::invalid_argument("Number of negatives must be positive");
+        if (config.k <= 0) throw std::invalid_argument("k must be positive");
+        if (config.alpha < 0.0 || config.alpha > 1.0) throw std::invalid_argument("alpha must be in [0, 1]");
+        for (int c : config.cutoffs) {
+            if (c <= 0) throw std::invalid_argument("Cutoff K must be positive");
+        }
+
+        const auto runStart = Clock::now();
+        Report report;
+
+        // --- 1. Отложенные оценки ---
+        auto phaseStart = Clock::now();
+        std::vector<const Rating*> heldOut(users.size(), nullptr);
+        std::vector<int> catalogue;
+        for (std::size_t j = 0; j < users.size(); ++j) {
+            const auto& ratings = users[j].getRatings();
+            for (const auto& [itemId, r] : ratings) {
+                catalogue.push_back(itemId);
+                if (ratings.size() < 2) continue;
+                const Rating* last = heldOut[j];
+                if (!last || r.timestamp > last->timestamp ||
+                    (r.timestamp == last->timestamp && r.itemId > last->itemId)) {
+                    heldOut[j] = &r;
+                }
+            }
+        }
+        std::sort(catalogue.begin(), catalogue.end());
+        catalogue.erase(std::unique(catalogue.begin(), catalogue.end()), catalogue.end());
+        report.timings.splitMs = msSince(phaseStart);
+
+        // --- 2. Модель без отложенных оценок ---
+        phaseStart = Clock::now();
+        const bool needUser = config.algorithm != CrossValidation::Algorithm::ItemBased;
+        const bool needItem = config.algorithm != CrossValidation::Algorithm::UserBased;
+        std::vector<User> train = users;
+        for (std::size_t j = 0; j < users.size(); ++j) {
+            if (heldOut[j]) train[j].removeRating(heldOut[j]->itemId);
+        }
+        std::vector<Item> items;
+        if (needItem) {
+            std::unordered_map<int, std::size_t> itemIndex;
+            for (const auto& u : train) {
+                for (const auto& [itemId, r] : u.getRatings()) {
+                    auto [it, inserted] = itemIndex.try_emplace(itemId, items.size());
+                    if (inserted) items.emplace_back(itemId);
+                    items[it->second].addRating(r);
+                }
+            }
+        }
+        report.timings.buildMs = msSince(phaseStart);
+
+        // --- 3. Ранжирование ---
+        phaseStart = Clock::now();
+        Predictor::Options options = config.options;
+        options.useCache = false;
+        constexpr int kSkipped = -1;
+        std::vector<int> ranks(users.size(), kSkipped);
+
+        // Соседи считаются пакетами: строки товаров читаются один раз на пакет
+        std::optional<BatchSimilarity> batch;
+        if (needUser) batch.emplace(train);
+        BatchSimilarity::Options batchOptions;
+        batchOptions.threads = 1;   // параллельность — по пакетам во внешнем цикле
+
+        parallelForRange(users.size(), batchOptions.batchSize, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::size_t> queries;
+            for (std::size_t j = begin; j < end; ++j) {
+                if (heldOut[j]) queries.push_back(j);
+            }
+            std::vector<std::vector<Neighbor>> batchNbrs;
+            if (needUser) batchNbrs = batch->neighbors(queries, config.metric, batchOptions);
+
+            for (std::size_t q = 0; q < queries.size(); ++q) {
+                const std::size_t j = queries[q];
+
+                // Негативы выбираются по полному профилю: отложенный товар среди них не окажется
+                SplitMix64 rng{config.seed * 0x9E3779B97F4A7C15ull + j};
+                std::vector<int> candidates = sampleNegatives(users[j], catalogue,
+                                                              static_cast<std::size_t>(config.negatives), rng);
+                candidates.push_back(heldOut[j]->itemId);
+
+                const User& target = train[j];
+                const std::vector<Neighbor> nbrs = needUser ? std::move(batchNbrs[q]) : std::vector<Neighbor>{};
+
+                auto score = [&](int itemId) {
+                    double userPred = needUser
+                        ? Predictor::predictFromNeighbors(target, nbrs, itemId, config.k, options) : 0.0;
+                    double itemPred = needItem
+                        ? Predictor::predictItemBased(target.getId(), itemId, train, items, config.k, options) : 0.0;
+                    switch (config.algorithm) {
+                        case CrossValidation::Algorithm::UserBased: return userPred;
+                        case CrossValidation::Algorithm::ItemBased: return itemPred;
+                        case CrossValidation::Algorithm::Hybrid: break;
+                    }
+                    return config.alpha * userPred + (1.0 - config.alpha) * itemPred;
+                };
+
+                const double positive = score(candidates.back());
+                int rank = 0;
+                for (std::size_t c = 0; c + 1 < candidates.size(); ++c) {
+                    if (score(candidates[c]) >= positive) ++rank;
+                }
+                ranks[j] = rank;
+            }
+        }, config.threads);
+        report.timings.predictMs = msSince(phaseStart);
+
+        // --- 4. Метрики ---
+        phaseStart = Clock::now();
+        report.results.resize(config.cutoffs.size());
+        for (std::size_t c = 0; c < config.cutoffs.size(); ++c) report.results[c].cutoff = config.cutoffs[c];
+
+        for (int rank : ranks) {
+            if (rank == kSkipped) {
+                ++report.skipped;
+                continue;
+            }
+            ++report.users;
+            for (auto& result : report.results) {
+                if (rank >= result.cutoff) continue;
+                result.hitRate += 1.0;
+                result.ndcg += 1.0 / std::log2(static_cast<double>(rank) + 2.0);
+            }
+        }
+        if (report.users > 0) {
+            for (auto& result : report.results) {
+                result.hitRate /= static_cast<double>(report.users);
+                result.ndcg /= static_cast<double>(report.users);
+            }
+        }
+        report.timings.scoreMs = msSince(phaseStart);
+        report.timings.totalMs = msSince(runStart);
+        return report;
+    }
+
+} // namespace recsys
@@ -0,0 +1,86 @@
+/**
+ * @file LeaveOneOut.h
+ * @brief Оценка leave-last-out с выборкой негативных товаров (HR@K, NDCG@K).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "CrossValidation.h"
+#include "Predictor.h"
+#include "../Models/User.h"
+
+namespace recsys {
+
+    /**
+     * @class LeaveOneOut
+     * @brief Быстрая оценка ранжирования: последняя оценка против выборки негативов.
+     *
+     * Для каждого пользователя хотя бы с двумя оценками откладывается самая
+     * поздняя по Rating::timestamp (при равенстве — с большим ID товара).
+     * Модель строится один раз без отложенных оценок всех пользователей.
+     * Отложенный товар ранжируется среди negatives случайных товаров,
+     * которых пользователь не оценивал: оценивается всего negatives + 1
+     * кандидатов на пользователя вместо всего каталога.
+     *
+     * Ранг — число негативов с оценкой не ниже отложенного товара
+     * (ничьи считаются не в пользу модели, так что непредсказанный товар
+     * не попадает в топ). HR@K — доля пользователей с рангом < K,
+     * NDCG@K — среднее 1 / log2(ранг + 2) по таким пользователям.
+     *
+     * Пользователи обрабатываются параллельно; генератор негативов каждого
+     * пользователя инициализируется от (seed, индекс пользователя), поэтому
+     * результат не зависит от числа потоков.
+     */
+    class LeaveOneOut {
+    public:
+        /**
+         * @struct Config
+         * @brief Параметры оценки
+         */
+        struct Config {
+            int negatives = 100;                                            ///< Негативов на пользователя
+            std::vector<int> cutoffs{5, 10, 20};                            ///< Значения K
+            CrossValidation::Algorithm algorithm = CrossValidation::Algorithm::UserBased;
+            int k = 5;                                                      ///< Число соседей
+            Predictor::Metric metric = Predictor::Metric::Cosine;
+            Predictor::Options options;                                     ///< Политики; кэш всегда отключён
+            double alpha = 0.5;                                             ///< Вес user-based части гибрида
+            unsigned seed = 42;                                             ///< Зерно выборки негативов
+            std::size_t threads = 0;                                        ///< Потоки; 0 — весь общий пул
+        };
+
+        /**
+         * @struct Result
+         * @brief Метрики при одном K
+         */
+        struct Result {
+            int cutoff = 0;
+            double hitRate = 0.0;  ///< HR@K
+            double ndcg = 0.0;     ///< NDCG@K
+        };
+
+        /**
+         * @struct Report
+         * @brief Итог оценки
+         */
+        struct Report {
+            std::vector<Result> results;        ///< По одному на каждый K из config.cutoffs
+            std::size_t users = 0;              ///< Оценённых пользователей
+            std::size_t skipped = 0;            ///< Пропущено (меньше двух оценок)
+            CrossValidation::Timings timings;   ///< splitMs — отбор, buildMs — модель, predictMs — ранжирование
+        };
+
+        /**
+         * @brief Выполняет оценку.
+         *
+         * @param users Все пользователи с оценками
+         * @param config Параметры
+         * @return HR@K и NDCG@K для каждого K
+         * @throws std::invalid_argument При некорректных параметрах
+         */
+        static Report run(const std::vector<User>& users, const Config& config);
+    };
+
+} // namespace recsys
@@ -0,0 +1,216 @@
+/**
+ * @file NeighborhoodPredictor.h
+ * @brief Шаблонный k-NN предсказатель, параметризованный политиками.
+ *
+ * Предсказатель собирается из трёх политик:
+ * - политики схожести (CosineSimilarity, PearsonSimilarity, ...);
+ * - политики веса оценки соседа (UniformWeight, DecayTableWeight);
+ * - политики агрегации (WeightedAverage, MeanCentered).
+ *
+ * Для каждой комбинации компилятор порождает отдельную специализацию,
+ * в которой внутренний цикл по соседям полностью встраивается.
+ * Predictor отображает runtime-перечисления на заранее инстанцированные
+ * специализации через таблицу указателей на функции.
+ */
+
+#pragma once
+
+#include "../Models/User.h"
+#include "DecayTable.h"
+#include "SimilarityPolicies.h"
+#include "../Utils/Tracing.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @struct Neighbor
+     * @brief Сосед целевого пользователя и его схожесть с ним.
+     */
+    struct Neighbor {
+        double similarity;   ///< Схожесть с целевым пользователем (> 0)
+        const User* user;    ///< Указатель на соседа внутри вектора пользователей
+    };
+
+    /**
+     * @struct UniformWeight
+     * @brief Все оценки соседей имеют одинаковый вес 1.0.
+     */
+    struct UniformWeight {
+        double operator()(const Rating&) const { return 1.0; }
+    };
+
+    /**
+     * @struct DecayTableWeight
+     * @brief Вес оценки затухает с возрастом; значения берутся из DecayTable.
+     *
+     * Вместо std::exp на каждую оценку соседа — одно чтение из таблицы.
+     */
+    struct DecayTableWeight {
+        const DecayTable* table = nullptr; ///< Таблица весов (владеет вызывающий код)
+        long now = 0;                      ///< Текущее время (секунды UNIX)
+
+        double operator()(const Rating& r) const {
+            return table->weight(now - static_cast<long>(r.timestamp));
+        }
+    };
+
+    /**
+     * @struct WeightedAverage
+     * @brief Взвешенное среднее оценок соседей: Σ sim·w·r / Σ sim·w.
+     */
+    struct WeightedAverage {
+        double num = 0.0;
+        double den = 0.0;
+
+        void begin(const User&) {}
+
+        void add(double sim, double w, double rating, const User&) {
+            num += sim * rating * w;
+            den += sim * w;
+        }
+
+        double result() const { return den > 0.0 ? num / den : 0.0; }
+    };
+
+    /**
+     * @struct MeanCentered
+     * @brief Агрегация Резника: r̄_u + Σ sim·w·(r_v − r̄_v) / Σ sim·w.
+     *
+     * Результат ограничивается диапазоном оценок [0, 5].
+     */
+    struct MeanCentered {
+        double base = 0.0;
+        double num = 0.0;
+        double den = 0.0;
+
+        void begin(const User& target) { base = target.getAverageRating(); }
+
+        void add(double sim, double w, double rating, const User& neighbor) {
+            num += sim * w * (rating - neighbor.getAverageRating());
+            den += sim * w;
+        }
+
+        double result() const {
+            if (den <= 0.0) return 0.0;
+            return std::clamp(base + num / den, 0.0, 5.0);
+        }
+    };
+
+    /**
+     * @class NeighborhoodPredictor
+     * @brief User-based k-NN предсказание для фиксированной комбинации политик.
+     *
+     * @tparam Sim Политика схожести (статический compute(const User&, const User&))
+     * @tparam Weight Политика веса (функтор от const Rating&)
+     * @tparam Agg Политика агрегации (begin/add/result)
+     */
+    template <class Sim, class Weight, class Agg>
+    class NeighborhoodPredictor {
+    public:
+        /// Пользователей между проверками часов при поиске соседей со сроком.
+        static constexpr std::size_t kClockCheck = 256;
+
+        /**
+         * @brief Находит всех пользователей с положительной схожестью.
+         *
+         * @param target Целевой пользователь
+         * @param users Вектор всех пользователей
+         * @return Соседи, отсортированные по убыванию схожести
+         */
+        static std::vector<Neighbor> neighbors(const User& target, const std::vector<User>& users) {
+            bool cut = false;
+            return neighbors(target, users, std::chrono::steady_clock::time_point::max(), cut);
+        }
+
+        /**
+         * @brief Поиск соседей, прерываемый по сроку.
+         *
+         * Часы проверяются раз в kClockCheck пользователей; после срока
+         * просмотр прекращается, и найденные к этому моменту соседи
+         * сортируются так же, как при полном поиске.
+         *
+         * @param target Целевой пользователь
+         * @param users Вектор всех пользователей
+         * @param until Срок окончания поиска (time_point::max() — без срока)
+         * @param cut Выход: true, если просмотрены не все пользователи
+         * @return Соседи, отсортированные по убыванию схожести
+         */
+        static std::vector<Neighbor> neighbors(const User& target,
+                                               const std::vector<User>& users,
+                                               std::chrono::steady_clock::time_point until,
+                                               bool& cut) {
+            RECSYS_TIME_STAGE(Neighbors);
+            RECSYS_TRACE_SCOPE("similarity.neighbors", "similarity");
+            const bool bounded = until != std::chrono::steady_clock::time_point::max();
+            std::vector<Neighbor> result;
+            result.reserve(users.size());
+            cut = false;
+
+            for (std::size_t i = 0; i < users.size(); ++i) {
+                if (bounded && i % kClockCheck == 0 && std::chrono::steady_clock::now() >= until) {
+                    cut = true;
+                    break;
+                }
+                const User& u = users[i];
+                if (u.getId() == target.getId()) continue;
+                double s = Sim::compute(target, u);
+                if (s > 0.0) result.push_back({s, &u});
+            }
+
+            RECSYS_COUNT(NeighborsFound, result.size());
+            // При равной схожести — по позиции в users, как в BatchSimilarity
+            std::sort(result.begin(), result.end(), [](const Neighbor& a, const Neighbor& b) {
+                return a.similarity != b.similarity ? a.similarity > b.similarity : a.user < b.user;
+            });
+            return result;
+        }
+
+        /**
+         * @brief Агрегирует оценки первых k соседей, оценивших товар.
+         *
+         * @param target Целевой пользователь
+         * @param nbrs Соседи в порядке убывания схожести
+         * @param itemId ID товара
+         * @param k Максимальное число учитываемых соседей
+         * @param weight Экземпляр политики веса
+         * @return Предсказание или 0.0, если ни один сосед не оценил товар
+         */
+        static double aggregate(const User& target,
+                                const std::vector<Neighbor>& nbrs,
+                                int itemId,
+                                int k,
+                                const Weight& weight) {
+            RECSYS_TIME_STAGE(Aggregate);
+            Agg agg;
+            agg.begin(target);
+
+            int taken = 0;
+            std::size_t examined = 0;
+            for (const auto& [sim, u_ptr] : nbrs) {
+                ++examined;
+                const auto& ratings = u_ptr->getRatings();
+                auto it = ratings.find(itemId);
+                if (it == ratings.end()) continue;
+
+                agg.add(sim, weight(it->second), it->second.score, *u_ptr);
+                if (++taken >= k) break;
+            }
+            RECSYS_COUNT(NeighborsExamined, examined);
+            return agg.result();
+        }
+
+        /// Полное предсказание: поиск соседей и агрегация.
+        static double predict(const User& target,
+                              int itemId,
+                              const std::vector<User>& users,
+                              int k,
+                              const Weight& weight) {
+            return aggregate(target, neighbors(target, users), itemId, k, weight);
+        }
+    };
+
+} // namespace recsys
@@ -1,8 +1,13 @@
 #include "Predictor.h"
+#include "NeighborhoodPredictor.h"
+#include "DecayTable.h"
 #include <algorithm>
+#include <array>
 #include <stdexcept>
 #include "../Models/Item.h"
-#include "../Utils/Cache.h"
+#include "../Utils/PredictionCache.h"
+#include "../Utils/Instrumentation.h"
+#include "../Utils/Tracing.h"
 #include "../Algorithms/Similarity.h"
 #include <ctime>
 
@@ -10,18 +15,146 @@ namespace recsys {
 /**
      * @brief Глобальный кэш для предсказаний user-based подхода
      * 
-     * Ключ: пара (user_id, item_id)
+     * Ключ: (user_id, item_id, вариант алгоритма)
      * Значение: предсказанная оценка
      */
 
-    std::unordered_map<std::pair<int, int>, double, pair_hash> userItemCache;
+    PredictionCache& Predictor::userBasedCache() {
+        static PredictionCache cache;
+        return cache;
+    }
 /**
      * @brief Глобальный кэш для предсказаний item-based подхода
      * 
-     * Ключ: пара (user_id, item_id)
+     * Ключ: (user_id, item_id, k)
      * Значение: предсказанная оценка
      */
-    std::unordered_map<std::pair<int, int>, double, pair_hash> itemItemCache;
+
+    PredictionCache& Predictor::itemBasedCache() {
+        static PredictionCache cache;
+        return cache;
+    }
+
+    void Predictor::clearCache() {
+        userBasedCache().clear();
+        itemBasedCache().clear();
+    }
+
+    void Predictor::reportMemory(MemoryReport& report) {
+        report.add("user-based prediction cache", userBasedCache().size(), userBasedCache().memoryBytes());
+        report.add("item-based prediction cache", itemBasedCache().size(), itemBasedCache().memoryBytes());
+        std::size_t tables = 0;
+        std::size_t bytes = DecayTable::cachedBytes(tables);
+        report.add("decay tables", tables, bytes);
+    }
+
+    namespace {
+
+        /// Сигнатура заранее инстанцированной специализации предсказателя.
+        using PredictFn = double (*)(const User&, int, const std::vector<User>&, int, const Predictor::Options&);
+
+        /// Текущее время запроса: options.now или системное время.
+        long currentTime(const Predictor::Options& options) {
+            return options.now != 0 ? options.now : static_cast<long>(std::time(nullptr));
+        }
+
+        /// Таблица весов для периода полураспада из options.
+        std::shared_ptr<const DecayTable> decayTableFor(const Predictor::Options& options) {
+            constexpr double kSecondsPerDay = 86400.0;
+            if (!(options.halfLifeDays > 0.0)) {
+                throw std::invalid_argument("Decay half-life must be positive");
+            }
+            return DecayTable::forHalfLife(options.halfLifeDays * kSecondsPerDay);
+        }
+
+        template <class Sim, class Agg>
+        double predictWith(UniformWeight, const User& target, int itemId,
+                           const std::vector<User>& users, int k, const Predictor::Options&) {
+            return NeighborhoodPredictor<Sim, UniformWeight, Agg>::predict(
+                target, itemId, users, k, UniformWeight{});
+        }
+
+        template <class Sim, class Agg>
+        double predictWith(DecayTableWeight, const User& target, int itemId,
+                           const std::vector<User>& users, int k, const Predictor::Options& options) {
+            // Таблица удерживается shared_ptr на время запроса; политика хранит сырой указатель.
+            auto table = decayTableFor(options);
+            return NeighborhoodPredictor<Sim, DecayTableWeight, Agg>::predict(
+                target, itemId, users, k, DecayTableWeight{table.get(), currentTime(options)});
+        }
+
+        template <class Sim, class Weight, class Agg>
+        double predictWith(const User& target, int itemId, const std::vector<User>& users,
+                           int k, const Predictor::Options& options) {
+            return predictWith<Sim, Agg>(Weight{}, target, itemId, users, k, options);
+        }
+
+        template <class Sim, class Weight>
+        constexpr std::array<PredictFn, 2> byAggregation() {
+            return {&predictWith<Sim, Weight, WeightedAverage>,
+                    &predictWith<Sim, Weight, MeanCentered>};
+        }
+
+        template <class Sim>
+        constexpr std::array<std::array<PredictFn, 2>, 2> byWeighting() {
+            return {byAggregation<Sim, UniformWeight>(),
+                    byAggregation<Sim, DecayTableWeight>()};
+        }
+
+        /// Таблица специализаций: [Metric][Weighting][Aggregation].
+        /// Порядок строк обязан совпадать с порядком перечислений в Predictor.
+        constexpr std::array<std::array<std::array<PredictFn, 2>, 2>, 4> kDispatch = {
+            byWeighting<CosineSimilarity>(),
+            byWeighting<PearsonSimilarity>(),
+            byWeighting<JaccardSimilarity>(),
+            byWeighting<ManhattanSimilarity>()
+        };
+
+        /// Сигнатура поиска соседей для заданной политики схожести.
+        using NeighborsFn = std::vector<Neighbor> (*)(const User&, const std::vector<User>&);
+
+        /// Поиск соседей: [Metric]. Политики веса и агрегации на него не влияют.
+        constexpr std::array<NeighborsFn, 4> kNeighbors = {
+            &NeighborhoodPredictor<CosineSimilarity, UniformWeight, WeightedAverage>::neighbors,
+            &NeighborhoodPredictor<PearsonSimilarity, UniformWeight, WeightedAverage>::neighbors,
+            &NeighborhoodPredictor<JaccardSimilarity, UniformWeight, WeightedAverage>::neighbors,
+            &NeighborhoodPredictor<ManhattanSimilarity, UniformWeight, WeightedAverage>::neighbors
+        };
+
+        /// Сигнатура поиска соседей, прерываемого по сроку.
+        using NeighborsUntilFn = std::vector<Neighbor> (*)(const User&, const std::vector<User>&,
+                                                          std::chrono::steady_clock::time_point, bool&);
+
+        /// Поиск соседей со сроком: [Metric].
+        constexpr std::array<NeighborsUntilFn, 4> kNeighborsUntil = {
+            &NeighborhoodPredictor<CosineSimilarity, UniformWeight, WeightedAverage>::neighbors,
+            &NeighborhoodPredictor<PearsonSimilarity, UniformWeight, WeightedAverage>::neighbors,
+            &NeighborhoodPredictor<JaccardSimilarity, UniformWeight, WeightedAverage>::neighbors,
+            &NeighborhoodPredictor<ManhattanSimilarity, UniformWeight, WeightedAverage>::neighbors
+        };
+
+        /// Агрегация по готовому списку соседей; схожесть в ней не участвует.
+        template <class Agg>
+        double aggregateWith(const User& target, const std::vector<Neighbor>& nbrs,
+                             int itemId, int k, const Predictor::Options& options) {
+            if (options.weighting == Predictor::Weighting::TimeDecay) {
+                auto table = decayTableFor(options);
+                return NeighborhoodPredictor<CosineSimilarity, DecayTableWeight, Agg>::aggregate(
+                    target, nbrs, itemId, k, DecayTableWeight{table.get(), currentTime(options)});
+            }
+            return NeighborhoodPredictor<CosineSimilarity, UniformWeight, Agg>::aggregate(
+                target, nbrs, itemId, k, UniformWeight{});
+        }
+
+        /// Кодирует параметры, влияющие на результат, в поле variant ключа кэша.
+        int encodeVariant(Predictor::Metric metric, const Predictor::Options& options, int k) {
+            return (static_cast<int>(metric) << 28)
+                 | (static_cast<int>(options.aggregation) << 24)
+                 | (k & 0xFFFFFF);
+        }
+
+    } // namespace
+
 /**
      * @brief Предсказывает оценку пользователя для товара (user-based подход)
      * 
@@ -31,34 +164,39 @@ namespace recsys {
      * @param itemId ID товара, для которого делается предсказание
      * @param users Вектор всех пользователей системы
      * @param k Количество ближайших соседей для использования
-     * @param metric Используемая метрика схожести (Cosine, Pearson, Jaccard)
+     * @param metric Используемая метрика схожести (Cosine, Pearson, Jaccard, Manhattan)
      * @return double Предсказанная оценка в диапазоне [0, 1]
      * 
      * @throws std::runtime_error Если пользователь не найден в системе
+     */
+
+    double Predictor::predict(int userId,
+                              int itemId,
+                              const std::vector<User>& users,
+                              int k,
+                              Metric metric) {
+        return predict(userId, itemId, users, k, metric, Options{});
+    }
+/**
+     * @brief Предсказывает оценку с заданными политиками веса и агрегации
      * 
      * @details Алгоритм:
      * 1. Находит целевого пользователя
-     * 2. Проверяет кэш предсказаний
-     * 3. Вычисляет схожесть со всеми другими пользователями
-     * 4. Сортирует пользователей по убыванию схожести
-     * 5. Усредняет оценки k ближайших соседей, оценивших товар
-     * 6. Сохраняет результат в кэш
+     * 2. Проверяет кэш предсказаний (только без затухания)
+     * 3. Выбирает специализацию NeighborhoodPredictor из таблицы kDispatch
+     * 4. Специализация находит соседей с положительной схожестью,
+     *    сортирует их и агрегирует оценки k ближайших, оценивших товар
+     * 5. Сохраняет результат в кэш
      */
 
     double Predictor::predict(int userId,
                               int itemId,
                               const std::vector<User>& users,
                               int k,
-                              Metric metric) {
-        auto getSim = [&](const User& a, const User& b) {
-            switch (metric) {
-                case Metric::Cosine:  return Similarity::cosine(a, b);
-                case Metric::Pearson: return Similarity::pearson(a, b);
-                case Metric::Jaccard: return Similarity::jaccard(a, b);
-            }
-            return 0.0;
-        };
-
+                              Metric metric,
+                              const Options& options) {
+        RECSYS_TIME_STAGE(PredictUser);
+        RECSYS_TRACE_SCOPE("predict.user", "predict");
         const User* target = nullptr;
         for (auto const& u : users) {
             if (u.getId() == userId) {
@@ -70,46 +208,47 @@ namespace recsys {
             throw std::runtime_error("User not found");
         }
 
-        auto key = std::make_pair(userId, itemId);
-        if (userItemCache.count(key)) return userItemCache[key];
-
-        std::vector<std::pair<double, const User*>> sims;
-        sims.reserve(users.size() - 1);
-
-        for (auto const& u : users) {
-            if (u.getId() == userId) continue;
-            double s = getSim(*target, u);
-            sims.emplace_back(s, &u);
+        const bool cacheable = options.useCache && options.weighting == Weighting::None;
+        PredictionKey key{userId, itemId, encodeVariant(metric, options, k)};
+        if (cacheable) {
+            if (auto cached = userBasedCache().find(key)) {
+                RECSYS_COUNT(CacheHits, 1);
+                return *cached;
+            }
+            RECSYS_COUNT(CacheMisses, 1);
         }
 
-        std::sort(sims.begin(), sims.end(),
-                  [](auto &a, auto &b) { return a.first > b.first; });
-
-        double num = 0.0, den = 0.0;
-        int taken = 0;
-        long now = std::time(nullptr);
+        PredictFn fn = kDispatch[static_cast<std::size_t>(metric)]
+                                [static_cast<std::size_t>(options.weighting)]
+                                [static_cast<std::size_t>(options.aggregation)];
+        double prediction = fn(*target, itemId, users, k, options);
 
-        for (auto const& [sim, u_ptr] : sims) {
-            if (sim <= 0.0) break;
-
-            const auto& ratings = u_ptr->getRatings();
-            auto it = ratings.find(itemId);
-            if (it == ratings.end()) continue;
-
-            double r = it->second.score;
-            long ts = it->second.timestamp;
+        if (cacheable) userBasedCache().insert(key, prediction);
+        return prediction;
+    }
+    std::vector<Neighbor> Predictor::neighbors(const User& target,
+                                               const std::vector<User>& users,
+                                               Metric metric) {
+        return kNeighbors[static_cast<std::size_t>(metric)](target, users);
+    }
 
-            //double w = Similarity::decayWeight(ts, now);
-            double w = 1.0; // на время тестов
-            num += sim * r * w;
-            den += sim * w;
+    std::vector<Neighbor> Predictor::neighbors(const User& target,
+                                               const std::vector<User>& users,
+                                               Metric metric,
+                                               std::chrono::steady_clock::time_point until,
+                                               bool& cut) {
+        return kNeighborsUntil[static_cast<std::size_t>(metric)](target, users, until, cut);
+    }
 
-            if (++taken >= k) break;
+    double Predictor::predictFromNeighbors(const User& target,
+                                           const std::vector<Neighbor>& nbrs,
+                                           int itemId,
+                                           int k,
+                                           const Options& options) {
+        if (options.aggregation == Aggregation::MeanCentered) {
+            return aggregateWith<MeanCentered>(target, nbrs, itemId, k, options);
         }
-
-        double prediction = den > 0.0 ? num / den : 0.0;
-        userItemCache[key] = prediction;
-        return prediction;
+        return aggregateWith<WeightedAverage>(target, nbrs, itemId, k, options);
     }
 /**
      * @brief Предсказывает оценку пользователя для товара (item-based подход)
@@ -141,7 +280,24 @@ namespace recsys {
                                    const std::vector<User>& users,
                                    const std::vector<Item>& items,
                                    int k) {
+        return predictItemBased(userId, itemId, users, items, k, Options{});
+    }
+/**
+     * @brief Item-based предсказание с политикой веса из options
+     *
+     * При Weighting::TimeDecay вклад каждого товара умножается на вес
+     * возраста оценки пользователя из таблицы DecayTable:
+     * \f$\hat r = \sum sim \cdot w \cdot r / \sum sim \cdot w\f$.
+     */
 
+    double Predictor::predictItemBased(int userId,
+                                   int itemId,
+                                   const std::vector<User>& users,
+                                   const std::vector<Item>& /*items*/,
+                                   int k,
+                                   const Options& options) {
+        RECSYS_TIME_STAGE(PredictItem);
+        RECSYS_TRACE_SCOPE("predict.item", "predict");
         const User* user = nullptr;
         for (const auto& u : users) {
             if (u.getId() == userId) {
@@ -151,36 +307,53 @@ namespace recsys {
         }
         if (!user) throw std::runtime_error("User not found");
 
-        auto key = std::make_pair(userId, itemId);
-        if (itemItemCache.count(key)) return itemItemCache[key];
+        const bool cacheable = options.useCache && options.weighting == Weighting::None;
+        PredictionKey key{userId, itemId, k};
+        if (cacheable) {
+            if (auto cached = itemBasedCache().find(key)) {
+                RECSYS_COUNT(CacheHits, 1);
+                return *cached;
+            }
+            RECSYS_COUNT(CacheMisses, 1);
+        }
 
-        std::vector<std::pair<double, double>> sims;
-        long now = std::time(nullptr);
+        std::shared_ptr<const DecayTable> table;
+        long now = 0;
+        if (options.weighting == Weighting::TimeDecay) {
+            table = decayTableFor(options);
+            now = currentTime(options);
+        }
+
+        struct ItemNeighbor {
+            double sim;   ///< Схожесть товара с целевым
+            double score; ///< Оценка пользователя этому товару
+            double w;     ///< Вес оценки по её возрасту
+        };
+        std::vector<ItemNeighbor> sims;
 
         for (const auto& [otherItemId, r] : user->getRatings()) {
             if (otherItemId == itemId) continue;
 
             double sim = Similarity::adjustedCosine(users, itemId, otherItemId);
             if (sim > 0.0) {
-                //double w = Similarity::decayWeight(r.timestamp, now);
-                double w = 1.0;
-                sims.emplace_back(sim, r.score * w);
+                double w = table ? table->weight(now - static_cast<long>(r.timestamp)) : 1.0;
+                sims.push_back({sim, r.score, w});
             }
         }
 
         std::sort(sims.begin(), sims.end(),
-                  [](auto& a, auto& b) { return a.first > b.first; });
+                  [](auto& a, auto& b) { return a.sim > b.sim; });
 
         double num = 0.0, den = 0.0;
         int taken = 0;
-        for (const auto& [sim, weightedScore] : sims) {
-            num += sim * weightedScore;
-            den += sim;
+        for (const auto& n : sims) {
+            num += n.sim * n.w * n.score;
+            den += n.sim * n.w;
             if (++taken >= k) break;
         }
 
         double prediction = (den > 0 ? num / den : 0.0);
-        itemItemCache[key] = prediction;
+        if (cacheable) itemBasedCache().insert(key, prediction);
         return prediction;
     }
 
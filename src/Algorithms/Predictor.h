@@ -3,6 +3,10 @@
 #include "../Models/User.h"
 #include "Similarity.h"
 #include "../Models/Item.h"
+#include "../Utils/PredictionCache.h"
+#include "../Utils/MemoryReport.h"
+#include "NeighborhoodPredictor.h"
+#include <chrono>
 #include <vector>
 
 namespace recsys {
@@ -28,7 +32,35 @@ namespace recsys {
         enum class Metric {
             Cosine,
             Pearson,
-            Jaccard
+            Jaccard,
+            Manhattan
+        };
+/**
+         * @enum Weighting
+         * @brief Политика веса оценок соседей
+         */
+        enum class Weighting {
+            None,       ///< Все оценки имеют вес 1.0
+            TimeDecay   ///< Затухание по возрасту оценки (таблица DecayTable)
+        };
+/**
+         * @enum Aggregation
+         * @brief Способ агрегации оценок соседей
+         */
+        enum class Aggregation {
+            WeightedAverage,  ///< Σ sim·r / Σ sim
+            MeanCentered      ///< Среднее пользователя + взвешенные отклонения соседей
+        };
+/**
+         * @struct Options
+         * @brief Дополнительные параметры user-based предсказания
+         */
+        struct Options {
+            Weighting weighting = Weighting::None;                  ///< Политика веса
+            Aggregation aggregation = Aggregation::WeightedAverage; ///< Политика агрегации
+            double halfLifeDays = 30.0; ///< Период полураспада для Weighting::TimeDecay (в днях)
+            long now = 0;               ///< Текущее время; 0 — взять std::time(nullptr)
+            bool useCache = true;       ///< Читать и пополнять глобальные кэши предсказаний
         };
 /**
          * @brief Предсказание оценки (user-based подход)
@@ -57,6 +89,72 @@ namespace recsys {
                               const std::vector<User>& users,
                               int k = 5,
                               Metric metric = Metric::Cosine);
+/**
+         * @brief Предсказание оценки с явными политиками веса и агрегации
+         *
+         * Комбинация (metric, weighting, aggregation) отображается на заранее
+         * инстанцированную специализацию NeighborhoodPredictor.
+         * Предсказания с затуханием зависят от текущего времени и не кэшируются.
+         *
+         * @param options Политики веса и агрегации
+         * @throws std::runtime_error Если пользователь не найден
+         */
+        static double predict(int userId,
+                              int itemId,
+                              const std::vector<User>& users,
+                              int k,
+                              Metric metric,
+                              const Options& options);
+/**
+         * @brief Соседи пользователя с положительной схожестью по метрике metric
+         *
+         * Вместе с predictFromNeighbors позволяет найти соседей один раз
+         * и предсказать по ним оценки многих товаров (оценка качества, подбор k).
+         *
+         * @param target Целевой пользователь
+         * @param users Вектор всех пользователей системы
+         * @param metric Метрика схожести
+         * @return Соседи в порядке убывания схожести
+         */
+        static std::vector<Neighbor> neighbors(const User& target,
+                                               const std::vector<User>& users,
+                                               Metric metric);
+/**
+         * @brief Соседи пользователя, поиск которых прерывается по сроку
+         *
+         * Порядок соседей тот же, что у neighbors() без срока; при cut == true
+         * это соседи лишь среди просмотренной части users.
+         *
+         * @param target Целевой пользователь
+         * @param users Вектор всех пользователей системы
+         * @param metric Метрика схожести
+         * @param until Срок окончания поиска
+         * @param cut Выход: true, если поиск прерван до конца users
+         * @return Соседи в порядке убывания схожести
+         */
+        static std::vector<Neighbor> neighbors(const User& target,
+                                               const std::vector<User>& users,
+                                               Metric metric,
+                                               std::chrono::steady_clock::time_point until,
+                                               bool& cut);
+/**
+         * @brief Агрегирует оценки k ближайших соседей, оценивших товар
+         *
+         * Результат совпадает с predict() при тех же metric, k и options,
+         * если nbrs получены через neighbors(). Кэш не используется.
+         *
+         * @param target Целевой пользователь
+         * @param nbrs Соседи в порядке убывания схожести
+         * @param itemId ID товара
+         * @param k Количество ближайших соседей
+         * @param options Политики веса и агрегации
+         * @return Предсказание или 0.0, если ни один сосед не оценил товар
+         */
+        static double predictFromNeighbors(const User& target,
+                                           const std::vector<Neighbor>& nbrs,
+                                           int itemId,
+                                           int k,
+                                           const Options& options);
 /**
          * @brief Предсказание оценки (item-based подход)
          * 
@@ -78,6 +176,41 @@ namespace recsys {
                                const std::vector<User>& users,
                                const std::vector<Item>& items,
                                int k = 5);
+/**
+         * @brief Item-based предсказание с политикой веса
+         *
+         * @param options Политика веса; поле aggregation не используется
+         * @throws std::runtime_error Если пользователь не найден
+         * @throws std::invalid_argument Если halfLifeDays ≤ 0 при TimeDecay
+         */
+        static double predictItemBased(int userId, int itemId,
+                               const std::vector<User>& users,
+                               const std::vector<Item>& items,
+                               int k,
+                               const Options& options);
+/**
+         * @brief Кэш user-based предсказаний
+         *
+         * Потокобезопасен; RatingIngestor сбрасывает в нём записи,
+         * затронутые новыми оценками.
+         */
+        static PredictionCache& userBasedCache();
+/**
+         * @brief Кэш item-based предсказаний
+         */
+        static PredictionCache& itemBasedCache();
+/**
+         * @brief Полностью очищает оба кэша предсказаний
+         *
+         * Нужен, если набор данных заменён целиком (например, загружен заново).
+         */
+        static void clearCache();
+/**
+         * @brief Добавляет в отчёт память кэшей предсказаний и таблиц затухания
+         *
+         * Строки: "user-based prediction cache", "item-based prediction cache", "decay tables".
+         */
+        static void reportMemory(MemoryReport& report);
     };
 
 } // namespace recsys
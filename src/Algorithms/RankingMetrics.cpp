@@ -0,0 +1,88 @@
+#include "RankingMetrics.h"
+#include "../Utils/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace recsys {
+
+    void RankingMetrics::Accumulator::add(const std::vector<std::pair<int, double>>& topN,
+                                          const std::vector<int>& relevant,
+                                          int K) {
+        if (relevant.empty() || K <= 0) return;
+
+        const std::size_t cutoff = std::min(topN.size(), static_cast<std::size_t>(K));
+        const std::size_t ideal = std::min(relevant.size(), static_cast<std::size_t>(K));
+
+        std::size_t hits = 0;
+        double dcg = 0.0, apSum = 0.0, reciprocal = 0.0;
+        for (std::size_t pos = 0; pos < cutoff; ++pos) {
+            if (!std::binary_search(relevant.begin(), relevant.end(), topN[pos].first)) continue;
+            ++hits;
+            dcg += 1.0 / std::log2(static_cast<double>(pos) + 2.0);
+            apSum += static_cast<double>(hits) / static_cast<double>(pos + 1);
+            if (reciprocal == 0.0) reciprocal = 1.0 / static_cast<double>(pos + 1);
+        }
+
+        double idcg = 0.0;
+        for (std::size_t pos = 0; pos < ideal; ++pos) idcg += 1.0 / std::log2(static_cast<double>(pos) + 2.0);
+
+        precision += static_cast<double>(hits) / K;
+        recall += static_cast<double>(hits) / relevant.size();
+        ndcg += dcg / idcg;
+        ap += apSum / ideal;
+        rr += reciprocal;
+        ++users;
+    }
+
+    void RankingMetrics::Accumulator::merge(const Accumulator& other) {
+        precision += other.precision;
+        recall += other.recall;
+        ndcg += other.ndcg;
+        ap += other.ap;
+        rr += other.rr;
+        users += other.users;
+    }
+
+    RankingMetrics::Result RankingMetrics::Accumulator::result() const {
+        Result r;
+        r.users = users;
+        if (users == 0) return r;
+        const double n = static_cast<double>(users);
+        r.precision = precision / n;
+        r.recall = recall / n;
+        r.ndcg = ndcg / n;
+        r.map = ap / n;
+        r.mrr = rr / n;
+        return r;
+    }
+
+    RankingMetrics::Result RankingMetrics::evaluate(
+        const std::vector<std::vector<std::pair<int, double>>>& topN,
+        const std::vector<std::vector<int>>& relevant,
+        int K,
+        std::size_t threads) {
+        if (K <= 0) throw std::invalid_argument("K must be positive");
+        if (topN.size() != relevant.size()) {
+            throw std::invalid_argument("Top-N lists and relevant sets must be aligned");
+        }
+
+        // Блоки фиксированного размера: границы, а значит и порядок слияния,
+        // не зависят от числа потоков
+        constexpr std::size_t kBlock = 4096;
+        Accumulator total = parallelReduce(
+            topN.size(), kBlock, Accumulator{},
+            [&](std::size_t begin, std::size_t end) {
+                Accumulator acc;
+                for (std::size_t i = begin; i < end; ++i) acc.add(topN[i], relevant[i], K);
+                return acc;
+            },
+            [](Accumulator a, const Accumulator& b) {
+                a.merge(b);
+                return a;
+            },
+            threads);
+        return total.result();
+    }
+
+} // namespace recsys
@@ -0,0 +1,93 @@
+/**
+ * @file RankingMetrics.h
+ * @brief Метрики качества top-N списков: precision@K, recall@K, NDCG@K, MAP@K, MRR.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class RankingMetrics
+     * @brief Считает метрики ранжирования по top-N спискам и отложенным релевантным товарам.
+     *
+     * Релевантные товары пользователя задаются отсортированным массивом ID;
+     * попадание проверяется бинарным поиском. Метрики усредняются по
+     * пользователям, у которых есть хотя бы один релевантный товар.
+     *
+     * Определения для списка, обрезанного до K позиций (pos с нуля), R — число релевантных:
+     * - precision@K = hits / K;
+     * - recall@K = hits / R;
+     * - NDCG@K = Σ_hit 1/log2(pos + 2) / Σ_{pos < min(R, K)} 1/log2(pos + 2);
+     * - AP@K = Σ_hit precision@(pos + 1) / min(R, K), MAP — среднее AP;
+     * - MRR = 1 / (pos первого попадания + 1).
+     */
+    class RankingMetrics {
+    public:
+        /**
+         * @struct Result
+         * @brief Средние значения метрик
+         */
+        struct Result {
+            double precision = 0.0;
+            double recall = 0.0;
+            double ndcg = 0.0;
+            double map = 0.0;
+            double mrr = 0.0;
+            std::size_t users = 0;  ///< Пользователей, вошедших в усреднение
+        };
+
+        /**
+         * @struct Accumulator
+         * @brief Суммы метрик по части пользователей.
+         *
+         * Каждый поток ведёт свой аккумулятор; в конце они сливаются merge()
+         * в фиксированном порядке, поэтому результат не зависит от числа потоков.
+         */
+        struct Accumulator {
+            double precision = 0.0;
+            double recall = 0.0;
+            double ndcg = 0.0;
+            double ap = 0.0;
+            double rr = 0.0;
+            std::size_t users = 0;
+
+            /**
+             * @brief Добавляет метрики одного пользователя.
+             *
+             * @param topN Рекомендации в порядке убывания оценки (item_id, score)
+             * @param relevant Отсортированные ID релевантных товаров; пустой — пользователь пропускается
+             * @param K Длина отсечения
+             */
+            void add(const std::vector<std::pair<int, double>>& topN,
+                     const std::vector<int>& relevant,
+                     int K);
+
+            /// Прибавляет суммы другого аккумулятора.
+            void merge(const Accumulator& other);
+
+            /// Средние значения.
+            Result result() const;
+        };
+
+        /**
+         * @brief Вычисляет метрики по всем пользователям параллельно.
+         *
+         * @param topN Списки рекомендаций, по одному на пользователя
+         * @param relevant Отсортированные релевантные товары, выровненные с topN
+         * @param K Длина отсечения
+         * @param threads Число потоков; 0 — весь общий пул
+         * @return Средние метрики
+         * @throws std::invalid_argument Если K ≤ 0 или размеры массивов различаются
+         */
+        static Result evaluate(const std::vector<std::vector<std::pair<int, double>>>& topN,
+                               const std::vector<std::vector<int>>& relevant,
+                               int K,
+                               std::size_t threads = 0);
+    };
+
+} // namespace recsys
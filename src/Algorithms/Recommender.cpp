@@ -1,9 +1,217 @@
 #include "Recommender.h"
 #include "Predictor.h"
+#include "Similarity.h"
+#include "../Utils/EpochSet.h"
+#include "../Utils/Instrumentation.h"
+#include "../Utils/Parallel.h"
+#include "../Utils/Tracing.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <stdexcept>
 
 namespace recsys {
+
+    namespace {
+
+        using Scored = std::pair<int, double>;
+
+        std::atomic<std::size_t> parallelMinCandidates{Recommender::Parallelism{}.minCandidates};
+        std::atomic<std::size_t> parallelThreads{Recommender::Parallelism{}.threads};
+        std::atomic<bool> candidateGenerationEnabled{true};
+
+        /// Наименьший блок каталога для одной задачи параллельной оценки.
+        constexpr std::size_t kMinScoreBlock = 256;
+
+        /// Популярнее: больше оценок, при равенстве меньше item_id.
+        bool morePopular(const Item& a, const Item& b) {
+            return a.getRatingCount() > b.getRatingCount() ||
+                   (a.getRatingCount() == b.getRatingCount() && a.getId() < b.getId());
+        }
+
+        /// Порядок выдачи: выше оценка, при равенстве меньше item_id.
+        bool better(const Scored& a, const Scored& b) {
+            return a.second > b.second || (a.second == b.second && a.first < b.first);
+        }
+
+        /**
+         * @class BoundedHeap
+         * @brief N лучших предсказаний с оценкой > 0; в вершине — худшее из них
+         */
+        class BoundedHeap {
+        public:
+            explicit BoundedHeap(std::size_t capacity) : capacity_(capacity) {
+                heap_.reserve(capacity);
+            }
+
+            void push(int itemId, double score) {
+                if (capacity_ == 0 || score <= 0.0) return;
+                const Scored candidate{itemId, score};
+                if (heap_.size() < capacity_) {
+                    heap_.push_back(candidate);
+                    std::push_heap(heap_.begin(), heap_.end(), better);
+                } else if (better(candidate, heap_.front())) {
+                    std::pop_heap(heap_.begin(), heap_.end(), better);
+                    heap_.back() = candidate;
+                    std::push_heap(heap_.begin(), heap_.end(), better);
+                }
+            }
+
+            std::vector<Scored> take() { return std::move(heap_); }
+
+        private:
+            std::size_t capacity_;
+            std::vector<Scored> heap_;
+        };
+
+        /**
+         * @brief Рабочее множество кандидатов потока; очищается за O(1) на каждый запрос.
+         *
+         * Запрос строит его целиком до параллельной оценки, а блоки пула
+         * только читают, поэтому буфера вызывающего потока достаточно.
+         */
+        EpochSet& candidateScratch() {
+            thread_local EpochSet scratch;
+            return scratch;
+        }
+
+        /// Товары соседей: только их user-based предсказание может быть > 0.
+        void addNeighborItems(const std::vector<Neighbor>& nbrs, EpochSet& candidates) {
+            for (const auto& neighbor : nbrs) {
+                for (const auto& [itemId, rating] : neighbor.user->getRatings()) candidates.insert(itemId);
+            }
+        }
+
+        /**
+         * @brief Товары пользователей, имеющих с user хотя бы одну общую оценку.
+         *
+         * Надмножество товаров соседей при любой метрике (всем нужна общая
+         * оценка) и товаров с положительной adjusted cosine хотя бы с одним
+         * товаром user: у такой пары есть общий оценщик, а он пересекается с user.
+         */
+        void addCoRatedItems(const User& user, const std::vector<User>& users, EpochSet& candidates) {
+            const auto& own = user.getRatings();
+            for (const auto& other : users) {
+                if (other.getId() == user.getId()) continue;
+                const auto& theirs = other.getRatings();
+                const auto& small = own.size() <= theirs.size() ? own : theirs;
+                const auto& large = own.size() <= theirs.size() ? theirs : own;
+                bool overlap = false;
+                for (const auto& entry : small) {
+                    if (large.count(entry.first)) {
+                        overlap = true;
+                        break;
+                    }
+                }
+                if (!overlap) continue;
+                for (const auto& [itemId, rating] : theirs) candidates.insert(itemId);
+            }
+        }
+
+        /**
+         * @brief Множество кандидатов запроса или nullptr, если генерация выключена.
+         *
+         * fill заполняет очищенный буфер потока.
+         */
+        template <class Fill>
+        const EpochSet* generateCandidates(Fill&& fill) {
+            if (!candidateGenerationEnabled.load(std::memory_order_relaxed)) return nullptr;
+            RECSYS_TRACE_SCOPE("recommend.candidates", "recommend");
+            EpochSet& candidates = candidateScratch();
+            candidates.clear();
+            fill(candidates);
+            RECSYS_COUNT(CandidatesGenerated, candidates.size());
+            return &candidates;
+        }
+
+        /**
+         * @brief Оценивает не исключённые товары функцией score и отбирает N лучших.
+         *
+         * Сначала за один проход по каталогу собираются идентификаторы товаров,
+         * которые действительно придётся оценить: вне candidates (если задано)
+         * предсказание заведомо 0, исключённые не выдаются. Ниже порога
+         * Recommender::Parallelism::minCandidates они оцениваются в вызывающем
+         * потоке и целиком уходят в selectTopN. Выше — делятся на блоки по
+         * потокам общего пула, каждый блок держит собственную кучу из N лучших,
+         * и в selectTopN попадают только блоки × N кандидатов. Порядок при
+         * равных оценках задаёт item_id, поэтому результат не зависит от режима
+         * и числа потоков.
+         */
+        template <class Score>
+        std::vector<Scored> scoreCandidates(const std::vector<Item>& items, int N, const EpochSet& excluded,
+                                            const EpochSet* candidates, Score&& score) {
+            std::vector<int> pending;
+            pending.reserve(candidates ? candidates->size() : items.size());
+            for (const auto& item : items) {
+                int itemId = item.getId();
+                if (candidates && !candidates->contains(itemId)) continue;
+                if (excluded.contains(itemId)) continue;
+                pending.push_back(itemId);
+            }
+            RECSYS_COUNT(CandidatesScored, pending.size());
+
+            const bool small = pending.size() < parallelMinCandidates.load(std::memory_order_relaxed);
+            std::size_t threads = parallelThreads.load(std::memory_order_relaxed);
+            if (!small && threads == 0) threads = poolThreads();
+            if (small || threads <= 1) {
+                std::vector<Scored> predictions;
+                predictions.reserve(pending.size());
+                for (int itemId : pending) predictions.emplace_back(itemId, score(itemId));
+                return Recommender::selectTopN(std::move(predictions), N);
+            }
+
+            const std::size_t keep = static_cast<std::size_t>(std::max(N, 0));
+            const std::size_t grain = std::max(kMinScoreBlock, (pending.size() + 4 * threads - 1) / (4 * threads));
+            std::vector<std::vector<Scored>> partial((pending.size() + grain - 1) / grain);
+
+            parallelForRange(pending.size(), grain, [&](std::size_t begin, std::size_t end) {
+                RECSYS_TRACE_SCOPE("recommend.score_block", "recommend");
+                BoundedHeap heap(keep);
+                for (std::size_t i = begin; i < end; ++i) heap.push(pending[i], score(pending[i]));
+                partial[begin / grain] = heap.take();
+            }, threads);
+
+            std::vector<Scored> merged;
+            merged.reserve(partial.size() * keep);
+            for (auto& block : partial) merged.insert(merged.end(), block.begin(), block.end());
+            return Recommender::selectTopN(std::move(merged), N);
+        }
+
+    } // namespace
+
+    void Recommender::setParallelism(Parallelism parallelism) {
+        parallelMinCandidates.store(parallelism.minCandidates, std::memory_order_relaxed);
+        parallelThreads.store(parallelism.threads, std::memory_order_relaxed);
+    }
+
+    void Recommender::collectExclusions(const User& user, const std::vector<int>& extra, EpochSet& out) {
+        out.clear();
+        for (const auto& [itemId, rating] : user.getRatings()) out.insert(itemId);
+        for (int itemId : extra) out.insert(itemId);
+    }
+
+    const EpochSet& Recommender::scratchExclusions(const User& user, const std::vector<int>& extra) {
+        // Отдельный буфер от candidateScratch: оба множества живут одновременно
+        thread_local EpochSet scratch;
+        collectExclusions(user, extra, scratch);
+        return scratch;
+    }
+
+    void Recommender::setCandidateGeneration(bool enabled) {
+        candidateGenerationEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool Recommender::candidateGeneration() {
+        return candidateGenerationEnabled.load(std::memory_order_relaxed);
+    }
+
+    Recommender::Parallelism Recommender::parallelism() {
+        Parallelism result;
+        result.minCandidates = parallelMinCandidates.load(std::memory_order_relaxed);
+        result.threads = parallelThreads.load(std::memory_order_relaxed);
+        return result;
+    }
+
 /**
      * @brief Формирует топ-N рекомендаций для пользователя (user-based подход)
      * 
@@ -31,7 +239,10 @@ namespace recsys {
         const std::vector<Item>& items,
         int N,
         int k,
-        Predictor::Metric metric) {
+        Predictor::Metric metric,
+        const std::vector<int>& exclude) {
+        RECSYS_TIME_STAGE(RecommendTopN);
+        RECSYS_TRACE_SCOPE("recommend.topn", "recommend");
 
         const User* user = nullptr;
         for (const auto& u : users) {
@@ -50,29 +261,10 @@ namespace recsys {
      *         (item_id, rating_count), отсортированный по убыванию количества оценок
      */
 
-        std::vector<std::pair<int, double>> predictions;
-
-        for (const auto& item : items) {
-            int itemId = item.getId();
-            if (user->getRatingForItem(itemId) > 0.0) continue;
-
-            double predicted = Predictor::predict(userId, itemId, users, k, metric);
-            predictions.emplace_back(itemId, predicted);
-        }
-
-        std::sort(predictions.begin(), predictions.end(),
-                  [](auto& a, auto& b) { return a.second > b.second; });
-
-        predictions.erase(
-            std::remove_if(predictions.begin(), predictions.end(),
-                           [](auto& p) { return p.second <= 0.0; }),
-            predictions.end()
-        );
-
-        if (predictions.size() > N)
-            predictions.resize(N);
-
-        return predictions;
+        const EpochSet* candidates = generateCandidates([&](EpochSet& set) { addCoRatedItems(*user, users, set); });
+        return scoreCandidates(items, N, scratchExclusions(*user, exclude), candidates, [&](int itemId) {
+            return Predictor::predict(userId, itemId, users, k, metric);
+        });
     }
 /**
      * @brief Формирует гибридные рекомендации (user-based + item-based)
@@ -120,7 +312,23 @@ namespace recsys {
         int N,
         int k,
         Predictor::Metric metric,
-        double alpha) {
+        double alpha,
+        const std::vector<int>& exclude) {
+        return recommendHybrid(userId, users, items, N, k, metric, alpha, Predictor::Options{}, exclude);
+    }
+
+    std::vector<std::pair<int, double>> Recommender::recommendHybrid(
+        int userId,
+        const std::vector<User>& users,
+        const std::vector<Item>& items,
+        int N,
+        int k,
+        Predictor::Metric metric,
+        double alpha,
+        const Predictor::Options& options,
+        const std::vector<int>& exclude) {
+        RECSYS_TIME_STAGE(RecommendHybrid);
+        RECSYS_TRACE_SCOPE("recommend.hybrid", "recommend");
 
         const User* user = nullptr;
         for (const auto& u : users) {
@@ -131,32 +339,15 @@ namespace recsys {
         }
         if (!user) throw std::runtime_error("User not found");
 
-        std::vector<std::pair<int, double>> predictions;
-
-        for (const auto& item : items) {
-            int itemId = item.getId();
-            if (user->getRatingForItem(itemId) > 0.0) continue;
-
-            double userPred = Predictor::predict(userId, itemId, users, k, metric);
-            double itemPred = Predictor::predictItemBased(userId, itemId, users, items, k);
-            double combined = alpha * userPred + (1.0 - alpha) * itemPred;
-
-            predictions.emplace_back(itemId, combined);
-        }
-
-        std::sort(predictions.begin(), predictions.end(),
-                  [](auto& a, auto& b) { return a.second > b.second; });
-
-        predictions.erase(
-            std::remove_if(predictions.begin(), predictions.end(),
-                           [](auto& p) { return p.second <= 0.0; }),
-            predictions.end()
-        );
-
-        if (predictions.size() > N)
-            predictions.resize(N);
-
-        return predictions;
+        // Сумма с весами alpha и 1 − alpha положительна, только если положительна одна из частей
+        const EpochSet* candidates = generateCandidates([&](EpochSet& set) { addCoRatedItems(*user, users, set); });
+        const std::vector<Neighbor> nbrs = alpha > 0.0 ? Predictor::neighbors(*user, users, metric)
+                                                       : std::vector<Neighbor>{};
+        return scoreCandidates(items, N, scratchExclusions(*user, exclude), candidates, [&](int itemId) {
+            double userPred = Predictor::predictFromNeighbors(*user, nbrs, itemId, k, options);
+            double itemPred = Predictor::predictItemBased(userId, itemId, users, items, k, options);
+            return alpha * userPred + (1.0 - alpha) * itemPred;
+        });
     }
 /**
      * @brief Формирует топ-N рекомендаций (item-based подход)
@@ -179,7 +370,10 @@ namespace recsys {
         int userId,
         const std::vector<User>& users,
         const std::vector<Item>& items,
-        int N) {
+        int N,
+        const std::vector<int>& exclude) {
+        RECSYS_TIME_STAGE(RecommendItemBased);
+        RECSYS_TRACE_SCOPE("recommend.item_based", "recommend");
 
         const User* user = nullptr;
         for (const auto& u : users) {
@@ -190,18 +384,176 @@ namespace recsys {
         }
         if (!user) throw std::runtime_error("User not found");
 
-        std::vector<std::pair<int, double>> predictions;
+        const EpochSet* candidates = generateCandidates([&](EpochSet& set) { addCoRatedItems(*user, users, set); });
+        return scoreCandidates(items, N, scratchExclusions(*user, exclude), candidates, [&](int itemId) {
+            return Predictor::predictItemBased(userId, itemId, users, items);
+        });
+    }
 
-        for (const auto& item : items) {
-            int itemId = item.getId();
-            if (user->getRatingForItem(itemId) > 0.0) continue;
+/**
+     * @brief Top-N с ограничением по времени и ступенчатой деградацией
+     *
+     * @details Ступени включаются по одной, когда оценка оставшихся
+     * кандидатов по текущему темпу не успевает к сроку:
+     * 1. список соседей урезается до maxNeighbors;
+     * 2. оставшиеся кандидаты урезаются до maxCandidates самых популярных;
+     * 3. гибрид теряет item-based часть (она дороже: схожесть товаров
+     *    считается заново для каждого кандидата, а соседи уже найдены).
+     * После каждой ступени темп измеряется заново.
+     */
+
+    Recommender::Budgeted Recommender::recommendWithDeadline(
+        int userId,
+        const std::vector<User>& users,
+        const std::vector<Item>& items,
+        int N,
+        int k,
+        Predictor::Metric metric,
+        double alpha,
+        const Deadline& deadline,
+        const std::vector<int>& exclude) {
+        RECSYS_TIME_STAGE(RecommendWithDeadline);
+        RECSYS_TRACE_SCOPE("recommend.deadline", "recommend");
+        using Clock = std::chrono::steady_clock;
 
-            double predicted = Predictor::predictItemBased(userId, itemId, users, items);
-            predictions.emplace_back(itemId, predicted);
+        const User* user = nullptr;
+        for (const auto& u : users) {
+            if (u.getId() == userId) {
+                user = &u;
+                break;
+            }
         }
+        if (!user) throw std::runtime_error("User not found");
 
-        std::sort(predictions.begin(), predictions.end(),
-                  [](auto& a, auto& b) { return a.second > b.second; });
+        Budgeted result;
+        auto degrade = [&](Degradation level) { result.degradation = std::max(result.degradation, level); };
+        const bool bounded = deadline.at != Clock::time_point::max();
+        const bool useUser = alpha > 0.0;
+        const bool useItem = alpha < 1.0;
+        const auto start = Clock::now();
+
+        // Соседи ищутся один раз и не дольше половины бюджета
+        std::vector<Neighbor> nbrs;
+        if (useUser) {
+            const auto searchUntil = bounded ? start + (deadline.at - start) / 2 : deadline.at;
+            bool cut = false;
+            nbrs = Predictor::neighbors(*user, users, metric, searchUntil, cut);
+            if (cut) degrade(Degradation::CappedNeighbors);
+            if (result.degraded() && nbrs.size() > deadline.maxNeighbors) nbrs.resize(deadline.maxNeighbors);
+        }
+
+        const EpochSet* candidates = generateCandidates([&](EpochSet& set) {
+            if (useItem) addCoRatedItems(*user, users, set);
+            else addNeighborItems(nbrs, set);
+        });
+        const EpochSet& excluded = scratchExclusions(*user, exclude);
+        std::vector<std::size_t> order;
+        order.reserve(candidates ? candidates->size() : items.size());
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            const int itemId = items[i].getId();
+            if (candidates && !candidates->contains(itemId)) continue;
+            if (!excluded.contains(itemId)) order.push_back(i);
+        }
+
+        // Глобальные кэши не трогаем: выдача со сроком — путь сервиса, читающего снимок модели
+        Predictor::Options options;
+        options.useCache = false;
+        bool singleModel = false;
+        auto score = [&](int itemId) {
+            double userPred = useUser ? Predictor::predictFromNeighbors(*user, nbrs, itemId, k, options) : 0.0;
+            if (!useItem || singleModel) return userPred;
+            double itemPred = Predictor::predictItemBased(userId, itemId, users, items, k, options);
+            if (!useUser) return itemPred;
+            return alpha * userPred + (1.0 - alpha) * itemPred;
+        };
+
+        std::size_t next = 0, end = order.size();
+        auto escalate = [&] {
+            if (useUser && nbrs.size() > deadline.maxNeighbors) {
+                nbrs.resize(deadline.maxNeighbors);
+                degrade(Degradation::CappedNeighbors);
+                return true;
+            }
+            if (end - next > deadline.maxCandidates) {
+                std::nth_element(order.begin() + next, order.begin() + next + deadline.maxCandidates,
+                                 order.begin() + end,
+                                 [&](std::size_t a, std::size_t b) { return morePopular(items[a], items[b]); });
+                end = next + deadline.maxCandidates;
+                degrade(Degradation::CappedCandidates);
+                return true;
+            }
+            if (useUser && useItem && !singleModel) {
+                singleModel = true;
+                degrade(Degradation::SingleModel);
+                return true;
+            }
+            return false;
+        };
+
+        std::vector<Scored> predictions;
+        predictions.reserve(order.size());
+        auto paceStart = Clock::now();
+        std::size_t paced = 0;
+        // Срок мог истечь ещё при поиске соседей: тогда кандидатов от них нет вовсе
+        bool expired = bounded && paceStart >= deadline.at;
+        while (!expired && next < end) {
+            if (bounded) {
+                const auto now = Clock::now();
+                if (now >= deadline.at) {
+                    expired = true;
+                    break;
+                }
+                if (paced > 0) {
+                    const auto perCandidate = (now - paceStart) / static_cast<Clock::rep>(paced);
+                    const auto projected = now + perCandidate * static_cast<Clock::rep>(end - next);
+                    if (projected > deadline.at && escalate()) {
+                        paceStart = now;
+                        paced = 0;
+                    }
+                }
+            }
+            int itemId = items[order[next++]].getId();
+            predictions.emplace_back(itemId, score(itemId));
+            ++paced;
+        }
+        RECSYS_COUNT(CandidatesScored, predictions.size());
+        result.items = selectTopN(std::move(predictions), N);
+
+        // Срок истёк: свободные места — популярные товары каталога, которых нет в выдаче
+        // и среди исключённых (не только кандидаты: их набор мог остаться пустым)
+        const std::size_t want = static_cast<std::size_t>(std::max(N, 0));
+        if (expired) {
+            degrade(Degradation::Popular);
+            std::vector<const Item*> popular;
+            for (const Item& item : items) {
+                if (item.getRatingCount() == 0 || excluded.contains(item.getId())) continue;
+                bool chosen = std::any_of(result.items.begin(), result.items.end(),
+                                          [&](const Scored& p) { return p.first == item.getId(); });
+                if (!chosen) popular.push_back(&item);
+            }
+            const std::size_t fill = std::min(popular.size(), want - std::min(want, result.items.size()));
+            std::partial_sort(popular.begin(), popular.begin() + fill, popular.end(),
+                              [](const Item* a, const Item* b) { return morePopular(*a, *b); });
+            for (std::size_t i = 0; i < fill; ++i) {
+                result.items.emplace_back(popular[i]->getId(), popular[i]->getAverageRating());
+            }
+        }
+        if (result.degraded()) RECSYS_COUNT(DegradedResponses, 1);
+        return result;
+    }
+/**
+     * @brief Отбирает N лучших предсказаний
+     *
+     * @details Сначала отбрасываются непредсказанные товары (оценка ≤ 0),
+     * затем частичная сортировка упорядочивает только первые N позиций:
+     * O(M log N) вместо полной сортировки всех M кандидатов.
+     */
+
+    std::vector<std::pair<int, double>> Recommender::selectTopN(
+        std::vector<std::pair<int, double>> predictions,
+        int N) {
+        RECSYS_TIME_STAGE(SelectTopN);
+        RECSYS_TRACE_SCOPE("recommend.select_topn", "recommend");
 
         predictions.erase(
             std::remove_if(predictions.begin(), predictions.end(),
@@ -209,10 +561,34 @@ namespace recsys {
             predictions.end()
         );
 
-        if (predictions.size() > N)
-            predictions.resize(N);
+        std::size_t n = std::min(predictions.size(), static_cast<std::size_t>(std::max(N, 0)));
+        std::partial_sort(predictions.begin(), predictions.begin() + n, predictions.end(), better);
+        predictions.resize(n);
 
         return predictions;
     }
+/**
+     * @brief Top-N по готовому списку соседей (user-based)
+     *
+     * Соседи ищутся вызывающим один раз (Predictor::neighbors), после чего
+     * каждый кандидат стоит один проход по списку соседей.
+     */
+
+    std::vector<std::pair<int, double>> Recommender::recommendFromNeighbors(
+        const User& user,
+        const std::vector<Neighbor>& nbrs,
+        const std::vector<Item>& items,
+        int N,
+        int k,
+        const Predictor::Options& options,
+        const std::vector<int>& exclude) {
+        RECSYS_TIME_STAGE(RecommendFromNeighbors);
+        RECSYS_TRACE_SCOPE("recommend.from_neighbors", "recommend");
+
+        const EpochSet* candidates = generateCandidates([&](EpochSet& set) { addNeighborItems(nbrs, set); });
+        return scoreCandidates(items, N, scratchExclusions(user, exclude), candidates, [&](int itemId) {
+            return Predictor::predictFromNeighbors(user, nbrs, itemId, k, options);
+        });
+    }
 
 }
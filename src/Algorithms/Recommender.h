@@ -3,6 +3,9 @@
 #include "../Models/User.h"
 #include "../Models/Item.h"
 #include "Predictor.h"
+#include "../Utils/EpochSet.h"
+#include <chrono>
+#include <cstddef>
 #include <vector>
 #include <utility>
 
@@ -20,6 +23,102 @@ namespace recsys {
 
     class Recommender {
     public:
+        /**
+         * @struct Parallelism
+         * @brief Параллельная оценка кандидатов внутри одного запроса
+         *
+         * Если товаров к оценке (кандидатов без исключённых) не меньше
+         * minCandidates, они делятся на блоки, каждый блок оценивается на
+         * потоке общего пула в собственную кучу из N лучших, и кучи сливаются
+         * в конце. На небольших запросах раздача задач стоит дороже самой
+         * оценки, поэтому они остаются последовательными, как бы ни был велик каталог.
+         */
+        struct Parallelism {
+            std::size_t minCandidates = 2048;   ///< Порог включения (товаров к оценке); SIZE_MAX — выключено
+            std::size_t threads = 0;            ///< Предел потоков на запрос; 0 — весь общий пул
+        };
+
+        /**
+         * @enum Degradation
+         * @brief Насколько урезан расчёт, чтобы уложиться в срок (по возрастанию)
+         */
+        enum class Degradation {
+            None,              ///< Полный расчёт
+            CappedNeighbors,   ///< Соседи — не более maxNeighbors лучших из просмотренных
+            CappedCandidates,  ///< Оставшиеся кандидаты урезаны до maxCandidates самых популярных
+            SingleModel,       ///< Гибрид сведён к user-based части
+            Popular            ///< Оценены не все кандидаты; недостающие места — популярные товары
+        };
+
+        /**
+         * @struct Deadline
+         * @brief Срок ответа и пределы работы при деградации
+         */
+        struct Deadline {
+            std::chrono::steady_clock::time_point at = std::chrono::steady_clock::time_point::max(); ///< max — без срока
+            std::size_t maxNeighbors = 200;    ///< Соседей после урезания
+            std::size_t maxCandidates = 500;   ///< Кандидатов после урезания
+
+            /// Срок через budget от текущего момента.
+            static Deadline after(std::chrono::microseconds budget) {
+                Deadline deadline;
+                deadline.at = std::chrono::steady_clock::now() + budget;
+                return deadline;
+            }
+        };
+
+        /**
+         * @struct Budgeted
+         * @brief Выдача с пометкой, урезался ли расчёт
+         */
+        struct Budgeted {
+            std::vector<std::pair<int, double>> items;         ///< (item_id, оценка) как у recommendTopN
+            Degradation degradation = Degradation::None;      ///< Самая глубокая применённая ступень
+
+            bool degraded() const { return degradation != Degradation::None; }
+        };
+
+        /**
+         * @brief Исключения выдачи: все товары с оценкой пользователя (в том числе 0) и extra.
+         *
+         * Все top-N функции строят его на каждый запрос в буфере потока
+         * и принимают extra последним параметром exclude (например, уже
+         * показанные товары): проверка товара — одна проба в плоской
+         * таблице вместо поиска в хеш-таблице оценок пользователя.
+         *
+         * @param out Множество-приёмник; предварительно очищается
+         */
+        static void collectExclusions(const User& user, const std::vector<int>& extra, EpochSet& out);
+
+        /**
+         * @brief collectExclusions в буфер текущего потока.
+         *
+         * Буфер общий для всех top-N функций и внешних циклов ранжирования
+         * (CrossValidation::runRanking), поэтому ссылка действительна до
+         * следующего вызова в том же потоке.
+         */
+        static const EpochSet& scratchExclusions(const User& user, const std::vector<int>& extra = {});
+
+        /**
+         * @brief Включает отбор кандидатов перед оценкой (по умолчанию включён).
+         *
+         * Вместо прохода по всему каталогу оцениваются только товары,
+         * оценённые пользователями с общими с целевым оценками (для
+         * recommendFromNeighbors — переданными соседями): у прочих товаров
+         * предсказание заведомо 0. Множество собирается в буфере потока
+         * (EpochSet) без выделений памяти на запрос. Выдача не меняется.
+         */
+        static void setCandidateGeneration(bool enabled);
+
+        /// Включён ли отбор кандидатов.
+        static bool candidateGeneration();
+
+        /// Задаёт параллельный режим для всех последующих запросов.
+        static void setParallelism(Parallelism parallelism);
+
+        /// Текущие параметры параллельного режима.
+        static Parallelism parallelism();
+
 /**
          * @brief Генерирует топ-N рекомендаций (user-based подход)
          * 
@@ -29,6 +128,7 @@ namespace recsys {
          * @param N Количество возвращаемых рекомендаций (по умолчанию 5)
          * @param k Количество соседей для алгоритма предсказания (по умолчанию 5)
          * @param metric Метрика схожести пользователей (по умолчанию Cosine)
+         * @param exclude Товары, которые не попадут в выдачу помимо оценённых (см. collectExclusions)
          * @return std::vector<std::pair<int, double>> Вектор пар (item_id, predicted_rating)
          *         отсортированный по убыванию предсказанного рейтинга
          */
@@ -40,7 +140,8 @@ namespace recsys {
             const std::vector<Item>& items,
             int N = 5,
             int k = 5,
-            Predictor::Metric metric = Predictor::Metric::Cosine);
+            Predictor::Metric metric = Predictor::Metric::Cosine,
+            const std::vector<int>& exclude = {});
 /**
          * @brief Возвращает топ-N самых популярных товаров
          * 
@@ -65,6 +166,7 @@ namespace recsys {
          * @param alpha Коэффициент взвешивания:
          *              - 0.0 = только item-based
          *              - 1.0 = только user-based
+         * @param exclude Товары, которые не попадут в выдачу помимо оценённых (см. collectExclusions)
          * @return std::vector<std::pair<int, double>> Вектор пар (item_id, combined_rating)
          *         отсортированный по убыванию комбинированного рейтинга
          */
@@ -78,8 +180,30 @@ namespace recsys {
             int N,
             int k,
             Predictor::Metric metric,
-            double alpha
+            double alpha,
+            const std::vector<int>& exclude = {}
             );
+/**
+         * @brief Гибридные рекомендации с политиками предсказания
+         *
+         * Соседи ищутся один раз на запрос, user-based часть агрегируется по ним
+         * (Predictor::predictFromNeighbors), item-based — Predictor::predictItemBased
+         * с теми же options. При options.useCache == false глобальные кэши
+         * предсказаний не читаются и не пополняются.
+         *
+         * @param options Политики веса и агрегации, использование кэша
+         * @throws std::runtime_error Если пользователь не найден в системе
+         */
+        static std::vector<std::pair<int, double>> recommendHybrid(
+            int userId,
+            const std::vector<User>& users,
+            const std::vector<Item>& items,
+            int N,
+            int k,
+            Predictor::Metric metric,
+            double alpha,
+            const Predictor::Options& options,
+            const std::vector<int>& exclude = {});
 /**
          * @brief Генерирует топ-N рекомендаций (item-based подход)
          * 
@@ -87,6 +211,7 @@ namespace recsys {
          * @param users Вектор всех пользователей системы
          * @param items Вектор всех товаров системы
          * @param N Количество возвращаемых рекомендаций
+         * @param exclude Товары, которые не попадут в выдачу помимо оценённых (см. collectExclusions)
          * @return std::vector<std::pair<int, double>> Вектор пар (item_id, predicted_rating)
          *         отсортированный по убыванию предсказанного рейтинга
          */
@@ -95,9 +220,71 @@ namespace recsys {
             int userId,
             const std::vector<User>& users,
             const std::vector<Item>& items,
-            int N
+            int N,
+            const std::vector<int>& exclude = {}
         );
 
+/**
+         * @brief Top-N рекомендаций по заранее найденным соседям пользователя
+         *
+         * @param user Целевой пользователь
+         * @param nbrs Соседи в порядке убывания схожести (Predictor::neighbors)
+         * @param items Кандидаты; уже оценённые пользователем пропускаются
+         * @param N Количество возвращаемых рекомендаций
+         * @param k Количество соседей для предсказания
+         * @param options Политики веса и агрегации
+         * @param exclude Товары, которые не попадут в выдачу помимо оценённых (см. collectExclusions)
+         * @return Вектор пар (item_id, predicted_rating) по убыванию рейтинга
+         */
+        static std::vector<std::pair<int, double>> recommendFromNeighbors(
+            const User& user,
+            const std::vector<Neighbor>& nbrs,
+            const std::vector<Item>& items,
+            int N,
+            int k,
+            const Predictor::Options& options,
+            const std::vector<int>& exclude = {});
+/**
+         * @brief Top-N (user-based или гибрид) с ограничением по времени
+         *
+         * Соседи ищутся один раз; поиск может занять не больше половины
+         * бюджета, иначе остаются лучшие из просмотренных. Перед каждым
+         * кандидатом время экстраполируется на оставшихся (часы стоят десятки
+         * наносекунд, оценка одного кандидата — микросекунды и больше); если
+         * срок под угрозой, включается следующая ступень Degradation. Когда
+         * срок истёк, оценка прекращается, а недостающие до N места
+         * занимают популярные неоценённые товары со средней оценкой.
+         * Без срока результат совпадает с recommendTopN (alpha = 1) или
+         * recommendHybrid. Кандидаты оцениваются последовательно; глобальные
+         * кэши предсказаний не используются.
+         *
+         * @param alpha Вес user-based части: 1 — только user-based, 0 — только item-based
+         * @param deadline Срок и пределы урезания
+         * @param exclude Товары, которые не попадут в выдачу помимо оценённых (см. collectExclusions)
+         * @throws std::runtime_error Если пользователь не найден в системе
+         */
+        static Budgeted recommendWithDeadline(
+            int userId,
+            const std::vector<User>& users,
+            const std::vector<Item>& items,
+            int N,
+            int k,
+            Predictor::Metric metric,
+            double alpha,
+            const Deadline& deadline,
+            const std::vector<int>& exclude = {});
+/**
+         * @brief Оставляет N предсказаний с наибольшей оценкой
+         *
+         * @param predictions Пары (item_id, predicted_rating) в любом порядке
+         * @param N Количество возвращаемых рекомендаций
+         * @return Предсказания с оценкой > 0 по убыванию оценки (при равенстве —
+         *         по возрастанию item_id), не более N
+         */
+        static std::vector<std::pair<int, double>> selectTopN(
+            std::vector<std::pair<int, double>> predictions,
+            int N);
+
     };
 
 }
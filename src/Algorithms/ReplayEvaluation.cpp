@@ -0,0 +1,228 @@
+#include "ReplayEvaluation.h"
+#include "../DataHandler/CSVLoader.h"
+#include "../DataHandler/RatingIngestor.h"
+#include "../DataHandler/WindowedDataset.h"
+#include "../Models/Dataset.h"
+#include "../Utils/Parallel.h"
+#include "../Utils/Tracing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+namespace recsys {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double msSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        /// Номер интервала длиной length, содержащего t (с округлением вниз).
+        long bucketOf(long t, long length) {
+            long q = t / length;
+            return (t % length != 0 && t < 0) ? q - 1 : q;
+        }
+
+        /**
+         * @brief Модель, в которую принимаются окна: весь поток или скользящее окно.
+         */
+        class ReplayModel {
+        public:
+            explicit ReplayModel(const ReplayEvaluation::Config& config) {
+                if (config.modelWindowSeconds > 0) {
+                    long segment = std::min(config.windowSeconds, config.modelWindowSeconds);
+                    windowed_ = std::make_unique<WindowedDataset>(config.modelWindowSeconds, segment, false);
+                } else {
+                    ingestor_ = std::make_unique<RatingIngestor>(dataset_, nullptr, nullptr, nullptr);
+                }
+            }
+
+            const Dataset& dataset() const { return windowed_ ? windowed_->dataset() : dataset_; }
+
+            /// Отбрасывает оценки, вышедшие за горизонт модели к моменту now.
+            void advanceTo(long now) {
+                if (windowed_) windowed_->advanceTo(now);
+            }
+
+            void ingest(const std::vector<Rating>& ratings) {
+                RECSYS_TRACE_SCOPE("replay.ingest", "evaluation");
+                if (!windowed_) {
+                    ingestor_->applyBatch(ratings);
+                    return;
+                }
+                for (const auto& r : ratings) {
+                    try {
+                        windowed_->append(r);
+                    } catch (const std::invalid_argument&) {
+                        // Некорректная оценка пропускается, как в RatingIngestor::applyBatch
+                    }
+                }
+            }
+
+        private:
+            Dataset dataset_;
+            std::unique_ptr<RatingIngestor> ingestor_;
+            std::unique_ptr<WindowedDataset> windowed_;
+        };
+
+        /**
+         * @brief Предсказывает оценки окна по текущей модели.
+         *
+         * Оценки группируются по пользователю, чтобы соседи искались один раз
+         * на пользователя окна; группы обрабатываются параллельно.
+         *
+         * @param out out[i] — предсказание для ratings[i] или NaN
+         */
+        void predictWindow(const std::vector<Rating>& ratings, const Dataset& model,
+                           const ReplayEvaluation::Config& config, const Predictor::Options& options,
+                           std::vector<double>& out) {
+            RECSYS_TRACE_SCOPE("replay.predict", "evaluation");
+            out.assign(ratings.size(), std::numeric_limits<double>::quiet_NaN());
+
+            std::vector<std::size_t> order(ratings.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return ratings[a].userId < ratings[b].userId;
+            });
+            std::vector<std::size_t> groups;
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                if (i == 0 || ratings[order[i]].userId != ratings[order[i - 1]].userId) groups.push_back(i);
+            }
+            groups.push_back(order.size());
+
+            const bool needUser = config.algorithm != CrossValidation::Algorithm::ItemBased;
+            const bool needItem = config.algorithm != CrossValidation::Algorithm::UserBased;
+            const auto& users = model.users();
+            const auto& items = model.items();
+
+            parallelFor(groups.size() - 1, [&](std::size_t g) {
+                const int userId = ratings[order[groups[g]]].userId;
+                const User* target = model.findUser(userId);
+                if (!target || target->getRatings().empty()) return; // холодный старт
+
+                std::vector<Neighbor> nbrs;
+                if (needUser) nbrs = Predictor::neighbors(*target, users, config.metric);
+
+                for (std::size_t pos = groups[g]; pos < groups[g + 1]; ++pos) {
+                    const int itemId = ratings[order[pos]].itemId;
+                    double userPred = needUser
+                        ? Predictor::predictFromNeighbors(*target, nbrs, itemId, config.k, options) : 0.0;
+                    double itemPred = needItem
+                        ? Predictor::predictItemBased(userId, itemId, users, items, config.k, options) : 0.0;
+
+                    double value = userPred;
+                    if (config.algorithm == CrossValidation::Algorithm::ItemBased) value = itemPred;
+                    if (config.algorithm == CrossValidation::Algorithm::Hybrid) {
+                        value = config.alpha * userPred + (1.0 - config.alpha) * itemPred;
+                    }
+                    if (value > 0.0) out[order[pos]] = value;
+                }
+            }, config.threads);
+        }
+
+    } // namespace
+
+    double ReplayEvaluation::Window::throughput() const {
+        double ms = predictMs + ingestMs;
+        return ms > 0.0 ? static_cast<double>(ratings) * 1000.0 / ms : 0.0;
+    }
+
+    ReplayEvaluation::Report ReplayEvaluation::run(const std::string& filename,
+                                                   const Config& config,
+                                                   const WindowCallback& onWindow) {
+        const auto start = Clock::now();
+        RatingSorter sorter(config.sort);
+        CSVLoader::stream(filename, [&](const Rating& r) { sorter.add(r); });
+        const double loadMs = msSince(start);
+
+        Report report = run(sorter, config, onWindow);
+        report.loadMs += loadMs;
+        report.totalMs = msSince(start);
+        return report;
+    }
+/**
+     * @brief Проигрывает отсортированный поток оценок
+     *
+     * @details Слияние серий сортировки выдаёт оценки по одной; они копятся
+     * в буфере окна. Первая оценка следующего интервала (или превышение
+     * maxWindowRatings) закрывает окно: оно предсказывается по модели,
+     * затем принимается в неё. Ошибки окна суммируются последовательно
+     * в порядке оценок, поэтому результат не зависит от числа потоков.
+     */
+
+    ReplayEvaluation::Report ReplayEvaluation::run(RatingSorter& sorter,
+                                                   const Config& config,
+                                                   const WindowCallback& onWindow) {
+        if (config.windowSeconds <= 0) throw std::invalid_argument("Replay window must be positive");
+        if (config.modelWindowSeconds < 0) throw std::invalid_argument("Model window must not be negative");
+        if (config.k <= 0) throw std::invalid_argument("k must be positive");
+        if (config.alpha < 0.0 || config.alpha > 1.0) throw std::invalid_argument("alpha must be in [0, 1]");
+
+        const auto runStart = Clock::now();
+        Report report;
+        ReplayModel model(config);
+        Evaluation::ErrorAccumulator total;
+
+        std::vector<Rating> window;
+        std::vector<double> predicted;
+        long bucket = 0;
+
+        auto flush = [&]() {
+            if (window.empty()) return;
+
+            Window result;
+            result.index = report.windows.size();
+            result.first = static_cast<long>(window.front().timestamp);
+            result.last = static_cast<long>(window.back().timestamp);
+            result.ratings = window.size();
+
+            Predictor::Options options = config.options;
+            options.useCache = false;
+            if (options.now == 0) options.now = result.first;
+
+            auto phaseStart = Clock::now();
+            model.advanceTo(result.first);
+            predictWindow(window, model.dataset(), config, options, predicted);
+            result.predictMs = msSince(phaseStart);
+
+            phaseStart = Clock::now();
+            model.ingest(window);
+            result.ingestMs = msSince(phaseStart);
+            result.modelRatings = model.dataset().ratingCount();
+
+            Evaluation::ErrorAccumulator acc;
+            for (std::size_t i = 0; i < window.size(); ++i) {
+                if (!std::isnan(predicted[i])) acc.add(predicted[i], window[i].score);
+            }
+            result.errors = acc.metrics();
+            total.merge(acc);
+
+            report.ratings += window.size();
+            report.windows.push_back(result);
+            if (onWindow) onWindow(result);
+            window.clear();
+        };
+
+        sorter.merge([&](const Rating& r) {
+            long b = bucketOf(static_cast<long>(r.timestamp), config.windowSeconds);
+            if (!window.empty() &&
+                (b != bucket || (config.maxWindowRatings > 0 && window.size() >= config.maxWindowRatings))) {
+                flush();
+            }
+            bucket = b;
+            window.push_back(r);
+        });
+        flush();
+
+        report.errors = total.metrics();
+        report.totalMs = msSince(runStart);
+        return report;
+    }
+
+} // namespace recsys
@@ -0,0 +1,119 @@
+/**
+ * @file ReplayEvaluation.h
+ * @brief Оценка онлайн-модели повторным проигрыванием оценок в порядке времени.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "CrossValidation.h"
+#include "Evaluation.h"
+#include "Predictor.h"
+#include "../DataHandler/RatingSorter.h"
+
+namespace recsys {
+
+    /**
+     * @class ReplayEvaluation
+     * @brief Проигрывает оценки по возрастанию timestamp окнами: сначала предсказание окна, затем его приём.
+     *
+     * Оценки внешне сортируются (RatingSorter) и выдаются потоком. Окно —
+     * подряд идущие оценки одного интервала [n·windowSeconds, (n+1)·windowSeconds);
+     * при maxWindowRatings > 0 окно дополнительно режется по числу оценок.
+     * Для каждого окна:
+     * 1. каждая оценка предсказывается по модели, видевшей только прошлые окна
+     *    (пользователь без истории — холодный старт, предсказания нет);
+     * 2. окно применяется к модели инкрементально: через RatingIngestor
+     *    или, если задан modelWindowSeconds, через WindowedDataset, который
+     *    отбрасывает оценки старше окна модели.
+     *
+     * В памяти одновременно находятся только буфер сортировки, текущее окно
+     * и модель; с modelWindowSeconds размер модели тоже ограничен, так что
+     * проигрывать можно историю за годы. Результат окна передаётся в
+     * onWindow сразу после его обработки.
+     *
+     * При Weighting::TimeDecay и options.now == 0 «текущим временем»
+     * предсказаний окна считается метка его первой оценки.
+     */
+    class ReplayEvaluation {
+    public:
+        /**
+         * @struct Config
+         * @brief Параметры проигрывания
+         */
+        struct Config {
+            long windowSeconds = 86400;              ///< Длина окна предсказания
+            std::size_t maxWindowRatings = 0;        ///< Предел оценок в окне; 0 — без предела
+            long modelWindowSeconds = 0;             ///< Горизонт модели; 0 — вся история
+            CrossValidation::Algorithm algorithm = CrossValidation::Algorithm::UserBased;
+            int k = 5;                               ///< Число соседей
+            Predictor::Metric metric = Predictor::Metric::Cosine;
+            Predictor::Options options;              ///< Политики; кэш всегда отключён
+            double alpha = 0.5;                      ///< Вес user-based части гибрида
+            RatingSorter::Options sort;              ///< Параметры внешней сортировки
+            std::size_t threads = 0;                 ///< Потоки; 0 — весь общий пул
+        };
+
+        /**
+         * @struct Window
+         * @brief Результат одного окна
+         */
+        struct Window {
+            std::size_t index = 0;            ///< Номер окна
+            long first = 0;                   ///< Метка первой оценки окна
+            long last = 0;                    ///< Метка последней оценки окна
+            std::size_t ratings = 0;          ///< Оценок в окне
+            Evaluation::ErrorMetrics errors;  ///< Ошибки предсказаний (count — предсказано)
+            std::size_t modelRatings = 0;     ///< Оценок в модели после приёма окна
+            double predictMs = 0.0;           ///< Время предсказания окна
+            double ingestMs = 0.0;            ///< Время приёма окна
+
+            /// Обработанных оценок в секунду (предсказание и приём).
+            double throughput() const;
+        };
+
+        /**
+         * @struct Report
+         * @brief Итог проигрывания
+         */
+        struct Report {
+            std::vector<Window> windows;      ///< Окна в порядке времени
+            Evaluation::ErrorMetrics errors;  ///< Ошибки по всем окнам
+            std::size_t ratings = 0;          ///< Проиграно оценок
+            double loadMs = 0.0;              ///< Чтение и запись серий сортировки
+            double totalMs = 0.0;
+
+            /// Доля оценок, для которых было предсказание.
+            double coverage() const {
+                return ratings == 0 ? 0.0 : static_cast<double>(errors.count) / static_cast<double>(ratings);
+            }
+        };
+
+        /// Обработчик готового окна.
+        using WindowCallback = std::function<void(const Window&)>;
+
+        /**
+         * @brief Проигрывает оценки из CSV-файла.
+         *
+         * @param filename CSV в формате CSVLoader
+         * @param config Параметры
+         * @param onWindow Вызывается после каждого окна (может быть пустым)
+         * @throws std::invalid_argument При некорректных параметрах
+         * @throws std::runtime_error Если файл не открывается
+         */
+        static Report run(const std::string& filename,
+                          const Config& config,
+                          const WindowCallback& onWindow = {});
+
+        /**
+         * @brief Проигрывает оценки, уже добавленные в сортировщик; после вызова он пуст.
+         */
+        static Report run(RatingSorter& sorter,
+                          const Config& config,
+                          const WindowCallback& onWindow = {});
+    };
+
+} // namespace recsys
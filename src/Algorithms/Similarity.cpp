@@ -1,5 +1,8 @@
 #include "Algorithms/Similarity.h"
+#include "Algorithms/SimilarityPolicies.h"
 #include "../Models/User.h"
+#include <algorithm>
+#include <cmath>
 
 
 namespace recsys {
@@ -21,22 +24,7 @@ namespace recsys {
      */
 
     double Similarity::cosine(const User& u1, const User& u2) {
-        const auto& r1 = u1.getRatings();
-        const auto& r2 = u2.getRatings();
-
-        double dot = 0.0, norm1 = 0.0, norm2 = 0.0;
-        for (auto& [item, rating] : r1) {
-            norm1 += rating.score * rating.score;
-            auto it = r2.find(item);
-            if (it != r2.end()) {
-                dot += rating.score * it->second.score;
-            }
-        }
-        for (auto& [item, rating] : r2) {
-            norm2 += rating.score * rating.score;
-        }
-        if (norm1 == 0.0 || norm2 == 0.0) return 0.0;
-        return dot / (std::sqrt(norm1) * std::sqrt(norm2));
+        return CosineSimilarity::compute(u1, u2);
     }
 /**
      * @brief Вычисляет корреляцию Пирсона между двумя пользователями
@@ -56,31 +44,7 @@ namespace recsys {
      */
 
     double Similarity::pearson(const User& u1, const User& u2) {
-        const auto& r1 = u1.getRatings();
-        const auto& r2 = u2.getRatings();
-
-        std::vector<std::pair<double,double>> common;
-        for (auto& [item, rating1] : r1) {
-            auto it = r2.find(item);
-            if (it != r2.end()) {
-                common.emplace_back(rating1.score, it->second.score);
-            }
-        }
-        int n = common.size();
-        if (n == 0) return 0.0;
-        if (n == 1) return 1.0;
-
-        double sum1=0, sum2=0, sum1Sq=0, sum2Sq=0, pSum=0;
-        for (auto& [x,y] : common) {
-            sum1   += x;
-            sum2   += y;
-            sum1Sq += x*x;
-            sum2Sq += y*y;
-            pSum   += x*y;
-        }
-        double num = pSum - (sum1 * sum2 / n);
-        double den = std::sqrt((sum1Sq - sum1*sum1/n) * (sum2Sq - sum2*sum2/n));
-        return (den == 0.0) ? 0.0 : num/den;
+        return PearsonSimilarity::compute(u1, u2);
     }
 /**
      * @brief Вычисляет схожесть Жаккара между двумя пользователями
@@ -100,14 +64,7 @@ namespace recsys {
      */
 
     double Similarity::jaccard(const User& u1, const User& u2) {
-        const auto& r1 = u1.getRatings();
-        const auto& r2 = u2.getRatings();
-        int inter = 0;
-        for (auto& [item, _] : r1) {
-            if (r2.count(item)) inter++;
-        }
-        int uni = r1.size() + r2.size() - inter;
-        return uni == 0 ? 0.0 : static_cast<double>(inter)/uni;
+        return JaccardSimilarity::compute(u1, u2);
     }
 /**
      * @brief Вычисляет скорректированную косинусную схожесть между двумя товарами
@@ -144,6 +101,8 @@ namespace recsys {
             }
         }
 
+        RECSYS_COUNT(SimilarityEvaluations, 1);
+        RECSYS_COUNT(OverlapItems, common.size());
         if (common.empty()) return 0.0;
 
         double num = 0.0, den1 = 0.0, den2 = 0.0;
@@ -171,18 +130,7 @@ namespace recsys {
      */
 
     double Similarity::manhattan(const User& u1, const User& u2) {
-        const auto& r1 = u1.getRatings();
-        const auto& r2 = u2.getRatings();
-        double sum = 0.0;
-        int count = 0;
-        for (auto& [item, rating] : r1) {
-            auto it = r2.find(item);
-            if (it != r2.end()) {
-                sum += std::abs(rating.score - it->second.score);
-                count++;
-            }
-        }
-        return count == 0 ? 0.0 : 1.0 / (1.0 + sum);
+        return ManhattanSimilarity::compute(u1, u2);
     }
 /**
      * @brief Вычисляет весовой коэффициент с временным затуханием
@@ -192,9 +140,9 @@ namespace recsys {
      * @param halfLife Период полураспада (в секундах)
      * @return double Весовой коэффициент в диапазоне (0, 1]
      * 
-     * @details Формула экспоненциального затухания:
+     * @details Тот же закон, что у DecayTable (за halfLife вес падает вдвое):
      * \f[
-     * w = e^{-\frac{\text{age}}{\text{halfLife}}}
+     * w = 2^{-\frac{\text{age}}{\text{halfLife}}}
      * \f]
      * где:
      * - \f$\text{age} = \text{now} - \text{timestamp}\f$
@@ -202,7 +150,7 @@ namespace recsys {
 
     double Similarity::decayWeight(long timestamp, long now, double halfLife) {
         double age = std::max(0.0, static_cast<double>(now - timestamp));
-        return std::exp(-age / halfLife);
+        return std::exp2(-age / halfLife);
     }
 
 
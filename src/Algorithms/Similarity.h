@@ -69,7 +69,7 @@ namespace recsys {
 
         static double manhattan(const User& u1, const User& u2);
 /**
-         * @brief Вычисляет весовой коэффициент с экспоненциальным затуханием
+         * @brief Вычисляет весовой коэффициент с экспоненциальным затуханием 2^(-age / halfLife)
          * 
          * @param timestamp Время события (в секундах с эпохи UNIX)
          * @param now Текущее время (в секундах с эпохи UNIX)
@@ -77,7 +77,7 @@ namespace recsys {
          * @return double Весовой коэффициент в диапазоне (0, 1]
          */
 
-        static double decayWeight(long timestamp, long now, double lambda = 0.01);
+        static double decayWeight(long timestamp, long now, double halfLife = 0.01);
 
     };
 
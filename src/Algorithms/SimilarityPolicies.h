@@ -0,0 +1,148 @@
+/**
+ * @file SimilarityPolicies.h
+ * @brief Политики схожести пользователей для шаблонного предсказателя.
+ *
+ * Каждая политика — структура со статическим inline-методом compute(),
+ * поэтому при инстанцировании NeighborhoodPredictor вычисление схожести
+ * встраивается во внутренний цикл без косвенных вызовов.
+ * Методы класса Similarity делегируют сюда, чтобы формулы жили в одном месте.
+ * Итоговая формула по накопленным суммам вынесена в статический finish():
+ * им же завершает ячейки BatchSimilarity, копящий те же суммы по-другому.
+ */
+
+#pragma once
+
+#include "../Models/User.h"
+#include "../Utils/Instrumentation.h"
+#include <cmath>
+#include <cstddef>
+
+namespace recsys {
+
+    /**
+     * @struct CosineSimilarity
+     * @brief Косинусная близость (скалярное произведение по общим товарам / полные нормы).
+     */
+    struct CosineSimilarity {
+        static double compute(const User& u1, const User& u2) {
+            const auto& r1 = u1.getRatings();
+            const auto& r2 = u2.getRatings();
+
+            double dot = 0.0, norm1 = 0.0, norm2 = 0.0;
+            std::size_t overlap = 0;
+            for (const auto& [item, rating] : r1) {
+                norm1 += rating.score * rating.score;
+                auto it = r2.find(item);
+                if (it != r2.end()) {
+                    dot += rating.score * it->second.score;
+                    ++overlap;
+                }
+            }
+            for (const auto& [item, rating] : r2) {
+                norm2 += rating.score * rating.score;
+            }
+            RECSYS_COUNT(SimilarityEvaluations, 1);
+            RECSYS_COUNT(OverlapItems, overlap);
+            return finish(dot, norm1, norm2);
+        }
+
+        /// Итог по скалярному произведению и квадратам полных норм.
+        static double finish(double dot, double norm1, double norm2) {
+            if (norm1 == 0.0 || norm2 == 0.0) return 0.0;
+            return dot / (std::sqrt(norm1) * std::sqrt(norm2));
+        }
+    };
+
+    /**
+     * @struct PearsonSimilarity
+     * @brief Корреляция Пирсона по общим товарам (0 — нет общих, 1 — один общий).
+     */
+    struct PearsonSimilarity {
+        static double compute(const User& u1, const User& u2) {
+            const auto& r1 = u1.getRatings();
+            const auto& r2 = u2.getRatings();
+
+            int n = 0;
+            double sum1 = 0, sum2 = 0, sum1Sq = 0, sum2Sq = 0, pSum = 0;
+            for (const auto& [item, rating1] : r1) {
+                auto it = r2.find(item);
+                if (it == r2.end()) continue;
+                double x = rating1.score;
+                double y = it->second.score;
+                sum1   += x;
+                sum2   += y;
+                sum1Sq += x * x;
+                sum2Sq += y * y;
+                pSum   += x * y;
+                ++n;
+            }
+            RECSYS_COUNT(SimilarityEvaluations, 1);
+            RECSYS_COUNT(OverlapItems, n);
+            return finish(static_cast<std::size_t>(n), sum1, sum2, sum1Sq, sum2Sq, pSum);
+        }
+
+        /// Итог по n общим товарам и суммам x, y, x², y², xy по ним.
+        static double finish(std::size_t n, double sum1, double sum2, double sum1Sq, double sum2Sq, double pSum) {
+            if (n == 0) return 0.0;
+            if (n == 1) return 1.0;
+
+            const double count = static_cast<double>(n);
+            double num = pSum - (sum1 * sum2 / count);
+            double den = std::sqrt((sum1Sq - sum1 * sum1 / count) * (sum2Sq - sum2 * sum2 / count));
+            return (den == 0.0) ? 0.0 : num / den;
+        }
+    };
+
+    /**
+     * @struct JaccardSimilarity
+     * @brief Мера Жаккара по множествам оценённых товаров.
+     */
+    struct JaccardSimilarity {
+        static double compute(const User& u1, const User& u2) {
+            const auto& r1 = u1.getRatings();
+            const auto& r2 = u2.getRatings();
+            int inter = 0;
+            for (const auto& [item, _] : r1) {
+                if (r2.count(item)) inter++;
+            }
+            RECSYS_COUNT(SimilarityEvaluations, 1);
+            RECSYS_COUNT(OverlapItems, inter);
+            return finish(static_cast<std::size_t>(inter), r1.size(), r2.size());
+        }
+
+        /// Итог по размеру пересечения и размерам обоих профилей.
+        static double finish(std::size_t inter, std::size_t size1, std::size_t size2) {
+            const std::size_t uni = size1 + size2 - inter;
+            return uni == 0 ? 0.0 : static_cast<double>(inter) / static_cast<double>(uni);
+        }
+    };
+
+    /**
+     * @struct ManhattanSimilarity
+     * @brief Схожесть 1 / (1 + L1-расстояние) по общим товарам.
+     */
+    struct ManhattanSimilarity {
+        static double compute(const User& u1, const User& u2) {
+            const auto& r1 = u1.getRatings();
+            const auto& r2 = u2.getRatings();
+            double sum = 0.0;
+            int count = 0;
+            for (const auto& [item, rating] : r1) {
+                auto it = r2.find(item);
+                if (it != r2.end()) {
+                    sum += std::abs(rating.score - it->second.score);
+                    count++;
+                }
+            }
+            RECSYS_COUNT(SimilarityEvaluations, 1);
+            RECSYS_COUNT(OverlapItems, count);
+            return finish(static_cast<std::size_t>(count), sum);
+        }
+
+        /// Итог по числу общих товаров и сумме модулей разностей по ним.
+        static double finish(std::size_t count, double sum) {
+            return count == 0 ? 0.0 : 1.0 / (1.0 + sum);
+        }
+    };
+
+} // namespace recsys
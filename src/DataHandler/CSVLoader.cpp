@@ -1,4 +1,5 @@
 #include "CSVLoader.h"
+#include "../Utils/Tracing.h"
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -8,6 +9,42 @@
 
 namespace recsys {
 
+namespace {
+
+    /**
+     * @brief Разбирает строку `userId,itemId,rating[,timestamp]`.
+     *
+     * Без метки времени берётся текущее время.
+     * @return false, если в строке меньше трёх колонок
+     * @throws std::exception Если число в колонке некорректно
+     */
+    bool parseLine(const std::string& line, Rating& out) {
+        // Разделение строки по запятой
+        std::istringstream ss(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (std::getline(ss, token, ',')) {
+            auto l = token.find_first_not_of(" \t\r\n");
+            auto r = token.find_last_not_of(" \t\r\n");
+            tokens.push_back((l != std::string::npos) ? token.substr(l, r - l + 1) : "");
+        }
+
+        if (tokens.size() < 3) return false;
+
+        int userId    = std::stoi(tokens[0]);       ///< ID пользователя
+        int itemId    = std::stoi(tokens[1]);       ///< ID товара
+        double rating = std::stod(tokens[2]);       ///< Оценка
+        long timestamp = std::time(nullptr);        ///< Временная метка
+
+        if (tokens.size() >= 4 && !tokens[3].empty()) {
+            timestamp = std::stol(tokens[3]);
+        }
+        out = Rating(userId, itemId, rating, timestamp);
+        return true;
+    }
+
+} // namespace
+
 /**
  * @brief Загружает пользователей, товары и оценки из CSV-файла.
  *
@@ -25,6 +62,7 @@ void CSVLoader::load(const std::string& filename,
                      std::vector<User>& users,
                      std::vector<Item>& items,
                      bool verbose) {
+    RECSYS_TRACE_SCOPE("csv.load", "io");
     std::ifstream file(filename);
     if (!file)
         throw std::runtime_error("Cannot open file: " + filename);
@@ -41,30 +79,15 @@ void CSVLoader::load(const std::string& filename,
         ++lineNum;
         if (lineNum == 1 || line.empty()) continue; // пропуск заголовка
 
-        // Разделение строки по запятой
-        std::istringstream ss(line);
-        std::vector<std::string> tokens;
-        std::string token;
-        while (std::getline(ss, token, ',')) {
-            auto l = token.find_first_not_of(" \t\r\n");
-            auto r = token.find_last_not_of(" \t\r\n");
-            tokens.push_back((l != std::string::npos) ? token.substr(l, r - l + 1) : "");
-        }
-
-        if (tokens.size() < 3) {
-            ++badLines;
-            continue;
-        }
-
         try {
-            int userId    = std::stoi(tokens[0]);       ///< ID пользователя
-            int itemId    = std::stoi(tokens[1]);       ///< ID товара
-            double rating = std::stod(tokens[2]);       ///< Оценка
-            long timestamp = std::time(nullptr);        ///< Временная метка
-
-            if (tokens.size() >= 4 && !tokens[3].empty()) {
-                timestamp = std::stol(tokens[3]);
+            Rating r;
+            if (!parseLine(line, r)) {
+                ++badLines;
+                continue;
             }
+            const int userId = r.userId;
+            const int itemId = r.itemId;
+            const double rating = r.score;
 
             if (!userIndex.count(userId)) {
                 users.emplace_back(userId);
@@ -80,7 +103,6 @@ void CSVLoader::load(const std::string& filename,
 
             auto& u = users[userIndex[userId]];
             auto& it = items[itemIndex[itemId]];
-            Rating r(userId, itemId, rating, timestamp);
             u.addRating(r);
             it.addRating(r);
 
@@ -104,4 +126,43 @@ void CSVLoader::load(const std::string& filename,
     }
 }
 
+/**
+ * @brief Потоковое чтение CSV-файла без построения пользователей и товаров.
+ */
+std::size_t CSVLoader::stream(const std::string& filename,
+                              const std::function<void(const Rating&)>& callback,
+                              bool verbose) {
+    RECSYS_TRACE_SCOPE("csv.stream", "io");
+    std::ifstream file(filename);
+    if (!file)
+        throw std::runtime_error("Cannot open file: " + filename);
+
+    std::string line;
+    int lineNum = 0;
+    std::size_t count = 0;
+    Rating rating;
+
+    while (std::getline(file, line)) {
+        ++lineNum;
+        if (lineNum == 1 || line.empty()) continue; // пропуск заголовка
+
+        bool parsed = false;
+        try {
+            parsed = parseLine(line, rating);
+        } catch (const std::exception& e) {
+            if (verbose) {
+                std::cerr << "Error parsing line " << lineNum
+                          << ": " << e.what() << "\n";
+            }
+            continue;
+        }
+        if (!parsed) continue;
+
+        // Исключения обработчика не считаются ошибками разбора и пробрасываются
+        callback(rating);
+        ++count;
+    }
+    return count;
+}
+
 } // namespace recsys
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 #include "../Models/User.h"
@@ -46,6 +48,22 @@ namespace recsys {
                          std::vector<User>& users,
                          std::vector<Item>& items,
                          bool verbose = true);
+
+        /**
+         * @brief Читает CSV-файл построчно и передаёт каждую корректную оценку в callback.
+         *
+         * В памяти держится только текущая строка, поэтому так можно пройти
+         * файл любого размера. Формат и правила пропуска строк — как у load().
+         *
+         * @param filename Путь к CSV-файлу.
+         * @param callback Обработчик оценки (в порядке строк файла).
+         * @param verbose Если `true`, сообщает о некорректных строках.
+         * @return Число переданных оценок.
+         * @throw std::runtime_error Если файл не может быть открыт.
+         */
+        static std::size_t stream(const std::string& filename,
+                                  const std::function<void(const Rating&)>& callback,
+                                  bool verbose = false);
     };
 
 } // namespace recsys
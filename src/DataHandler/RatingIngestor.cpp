@@ -0,0 +1,157 @@
+#include "RatingIngestor.h"
+#include <stdexcept>
+
+namespace recsys {
+
+    RatingIngestor::RatingIngestor(Dataset& dataset,
+                                   CoRatingIndex* coRatings,
+                                   PredictionCache* userCache,
+                                   PredictionCache* itemCache,
+                                   std::size_t maxFanout)
+        : dataset_(dataset),
+          coRatings_(coRatings),
+          userCache_(userCache),
+          itemCache_(itemCache),
+          maxFanout_(maxFanout) {}
+
+    bool RatingIngestor::apply(const Rating& rating) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Touched touched;
+        bool changed = applyLocked(rating, touched);
+        if (changed) invalidate(touched);
+        return changed;
+    }
+
+    std::size_t RatingIngestor::applyBatch(const std::vector<Rating>& ratings) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Touched touched;
+        std::size_t applied = 0;
+        for (const auto& r : ratings) {
+            try {
+                if (applyLocked(r, touched)) ++applied;
+            } catch (const std::invalid_argument&) {
+                // Некорректная оценка не должна останавливать всю пачку
+            }
+        }
+        if (applied > 0) invalidate(touched);
+        return applied;
+    }
+
+    bool RatingIngestor::remove(int userId, int itemId) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Touched touched;
+        bool removed = removeLocked(userId, itemId, touched);
+        if (removed) invalidate(touched);
+        return removed;
+    }
+
+    RatingIngestor::Stats RatingIngestor::stats() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return stats_;
+    }
+
+    bool RatingIngestor::applyLocked(const Rating& rating, Touched& touched) {
+        if (const Rating* current = dataset_.findRating(rating.userId, rating.itemId)) {
+            if (current->score == rating.score) {
+                // Значение не изменилось — достаточно обновить метку времени
+                if (current->timestamp != rating.timestamp) dataset_.upsert(rating);
+                ++stats_.unchanged;
+                return false;
+            }
+        }
+
+        auto previous = dataset_.upsert(rating);
+        if (coRatings_) {
+            const Item& item = *dataset_.findItem(rating.itemId);
+            if (previous) coRatings_->removeRating(*previous, item);
+            coRatings_->addRating(rating, item);
+        }
+
+        touched.users.insert(rating.userId);
+        touched.items.insert(rating.itemId);
+        ++stats_.applied;
+        return true;
+    }
+
+    bool RatingIngestor::removeLocked(int userId, int itemId, Touched& touched) {
+        const Rating* current = dataset_.findRating(userId, itemId);
+        if (!current) return false;
+
+        if (coRatings_) coRatings_->removeRating(*current, *dataset_.findItem(itemId));
+        dataset_.remove(userId, itemId);
+
+        touched.users.insert(userId);
+        touched.items.insert(itemId);
+        ++stats_.removed;
+        return true;
+    }
+/**
+     * @brief Сбрасывает записи кэшей, зависящие от изменённых оценок
+     *
+     * @details User-based предсказание (x, j) зависит от оценок соседей x
+     * и от схожести x с ними. Изменение оценки (u, i) меняет:
+     * - все предсказания самого u;
+     * - предсказания товара i для любого пользователя;
+     * - схожесть u с каждым пользователем, имеющим с u общий товар.
+     *
+     * Item-based предсказание (x, j) зависит от adjusted cosine (j, m) по
+     * товарам m пользователя x; среднее u входит в эту схожесть для всех пар
+     * товаров, оценённых u, поэтому сбрасываются все эти товары.
+     */
+
+    void RatingIngestor::invalidate(const Touched& touched) {
+        std::size_t invalidated = 0;
+
+        if (userCache_) {
+            std::unordered_set<int> neighbors;
+            std::size_t visited = 0;
+            bool flushAll = false;
+
+            for (int userId : touched.users) {
+                const User* user = dataset_.findUser(userId);
+                if (!user || flushAll) continue;
+                for (const auto& [itemId, r] : user->getRatings()) {
+                    const Item* item = dataset_.findItem(itemId);
+                    visited += item->getRatings().size();
+                    if (visited > maxFanout_) {
+                        flushAll = true;
+                        break;
+                    }
+                    for (const auto& other : item->getRatings()) neighbors.insert(other.userId);
+                }
+            }
+            // Удалённая оценка уже не видна в профиле, но её бывшие соавторы тоже затронуты
+            for (int itemId : touched.items) {
+                const Item* item = dataset_.findItem(itemId);
+                if (!item || flushAll) continue;
+                for (const auto& other : item->getRatings()) neighbors.insert(other.userId);
+            }
+
+            if (flushAll) {
+                invalidated += userCache_->size();
+                userCache_->clear();
+                ++stats_.fullFlushes;
+            } else {
+                for (int userId : touched.users) invalidated += userCache_->invalidateUser(userId);
+                for (int userId : neighbors) {
+                    if (!touched.users.count(userId)) invalidated += userCache_->invalidateUser(userId);
+                }
+                for (int itemId : touched.items) invalidated += userCache_->invalidateItem(itemId);
+            }
+        }
+
+        if (itemCache_) {
+            std::unordered_set<int> items(touched.items.begin(), touched.items.end());
+            for (int userId : touched.users) {
+                invalidated += itemCache_->invalidateUser(userId);
+                if (const User* user = dataset_.findUser(userId)) {
+                    for (const auto& [itemId, r] : user->getRatings()) items.insert(itemId);
+                }
+            }
+            for (int itemId : items) invalidated += itemCache_->invalidateItem(itemId);
+        }
+
+        stats_.invalidated += invalidated;
+    }
+
+} // namespace recsys
@@ -0,0 +1,131 @@
+/**
+ * @file RatingIngestor.h
+ * @brief Онлайн-приём оценок в живой набор данных.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <vector>
+#include "../Models/Dataset.h"
+#include "../Algorithms/CoRatingIndex.h"
+#include "../Algorithms/Predictor.h"
+#include "../Utils/PredictionCache.h"
+
+namespace recsys {
+
+    /**
+     * @class RatingIngestor
+     * @brief Применяет новые и изменённые оценки к Dataset и поддерживает производные структуры.
+     *
+     * На каждую оценку (u, i):
+     * - обновляются суммы пользователя и товара (через Dataset::upsert);
+     * - обновляются суммы CoRatingIndex для пар (u, v), v — оценившие i;
+     * - из кэша user-based сбрасываются записи u, товара i и пользователей,
+     *   имеющих общие товары с u (их схожесть с u изменилась);
+     * - из кэша item-based сбрасываются записи u и всех товаров, оценённых u
+     *   (среднее u входит в adjusted cosine для каждой пары этих товаров).
+     *
+     * Если обход соседей u превышает maxFanout оценок, кэш user-based
+     * очищается целиком — это дешевле точечной инвалидации для «тяжёлых» пользователей.
+     *
+     * Читатели (Predictor, Recommender) должны держать readLock() на время
+     * работы с dataset(): тогда они не видят полупримененных оценок и не могут
+     * положить в кэш результат, посчитанный по уже устаревшим данным.
+     */
+    class RatingIngestor {
+    public:
+        /**
+         * @struct Stats
+         * @brief Счётчики работы приёмника.
+         */
+        struct Stats {
+            std::size_t applied = 0;      ///< Применено оценок (новых и изменённых)
+            std::size_t unchanged = 0;    ///< Пропущено оценок, совпавших с текущими
+            std::size_t removed = 0;      ///< Удалено оценок
+            std::size_t invalidated = 0;  ///< Сброшено записей кэшей
+            std::size_t fullFlushes = 0;  ///< Полных очисток кэша user-based
+        };
+
+        /**
+         * @brief Создаёт приёмник поверх набора данных.
+         *
+         * @param dataset Живой набор данных (должен пережить приёмник)
+         * @param coRatings Суммы по общим оценкам или nullptr
+         * @param userCache Кэш user-based предсказаний (по умолчанию глобальный кэш Predictor) или nullptr
+         * @param itemCache Кэш item-based предсказаний (по умолчанию глобальный кэш Predictor) или nullptr
+         * @param maxFanout Порог обхода оценок соседей для точечной инвалидации
+         */
+        explicit RatingIngestor(Dataset& dataset,
+                                CoRatingIndex* coRatings = nullptr,
+                                PredictionCache* userCache = &Predictor::userBasedCache(),
+                                PredictionCache* itemCache = &Predictor::itemBasedCache(),
+                                std::size_t maxFanout = 100000);
+
+        /**
+         * @brief Применяет одну оценку (добавление или замена).
+         * @return false, если оценка совпала с текущей и ничего не изменилось
+         * @throws std::invalid_argument Если оценка некорректна
+         */
+        bool apply(const Rating& rating);
+
+        /**
+         * @brief Применяет пачку оценок под одной блокировкой.
+         *
+         * Инвалидация кэшей выполняется один раз для объединения затронутых
+         * пользователей и товаров, что существенно дешевле поштучного apply().
+         * Некорректные оценки пропускаются.
+         *
+         * @return Число применённых оценок
+         */
+        std::size_t applyBatch(const std::vector<Rating>& ratings);
+
+        /**
+         * @brief Удаляет оценку пары (user, item).
+         * @return true, если оценка существовала
+         */
+        bool remove(int userId, int itemId);
+
+        /// Разделяемая блокировка для читателей dataset().
+        std::shared_lock<std::shared_mutex> readLock() const {
+            return std::shared_lock<std::shared_mutex>(mutex_);
+        }
+
+        /// Набор данных (читать под readLock()).
+        const Dataset& dataset() const { return dataset_; }
+
+        /// Снимок счётчиков.
+        Stats stats() const;
+
+    private:
+        /**
+         * @struct Touched
+         * @brief Пользователи и товары, затронутые изменениями.
+         */
+        struct Touched {
+            std::unordered_set<int> users;
+            std::unordered_set<int> items;
+        };
+
+        /// Применяет изменение без блокировки и запоминает затронутые ключи.
+        bool applyLocked(const Rating& rating, Touched& touched);
+
+        /// Удаляет оценку без блокировки и запоминает затронутые ключи.
+        bool removeLocked(int userId, int itemId, Touched& touched);
+
+        /// Сбрасывает записи кэшей, зависящие от затронутых ключей.
+        void invalidate(const Touched& touched);
+
+        Dataset& dataset_;
+        CoRatingIndex* coRatings_;
+        PredictionCache* userCache_;
+        PredictionCache* itemCache_;
+        std::size_t maxFanout_;
+        mutable std::shared_mutex mutex_;
+        Stats stats_;
+    };
+
+} // namespace recsys
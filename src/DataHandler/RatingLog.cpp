@@ -0,0 +1,219 @@
+#include "RatingLog.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace recsys {
+
+    namespace {
+
+        constexpr char kMagic[8] = {'R', 'S', 'Y', 'S', 'W', 'A', 'L', '1'};
+        constexpr std::size_t kPayloadSize = 28;
+
+        /// Таблица CRC-32 (полином 0xEDB88320).
+        std::array<std::uint32_t, 256> makeCrcTable() {
+            std::array<std::uint32_t, 256> table{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            return table;
+        }
+
+        std::uint32_t crc32(const unsigned char* data, std::size_t size) {
+            static const auto table = makeCrcTable();
+            std::uint32_t c = 0xFFFFFFFFu;
+            for (std::size_t i = 0; i < size; ++i) c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+            return c ^ 0xFFFFFFFFu;
+        }
+
+        template <class T>
+        void put(unsigned char* out, std::size_t offset, T value) {
+            std::memcpy(out + offset, &value, sizeof(T));
+        }
+
+        template <class T>
+        T get(const unsigned char* in, std::size_t offset) {
+            T value;
+            std::memcpy(&value, in + offset, sizeof(T));
+            return value;
+        }
+
+        /// fsync для дескриптора FILE*.
+        void syncFile(std::FILE* file) {
+#ifdef _WIN32
+            _commit(_fileno(file));
+#else
+            ::fsync(fileno(file));
+#endif
+        }
+
+        /// Обрезает файл до size байт.
+        void truncateFile(std::FILE* file, std::size_t size) {
+#ifdef _WIN32
+            _chsize_s(_fileno(file), static_cast<long long>(size));
+#else
+            if (::ftruncate(fileno(file), static_cast<off_t>(size)) != 0) {
+                throw std::runtime_error("Cannot truncate rating log");
+            }
+#endif
+        }
+
+    } // namespace
+
+    RatingLog::RatingLog(const std::string& path, Options options)
+        : path_(path), options_(options), lastSync_(std::chrono::steady_clock::now()) {
+        file_ = std::fopen(path.c_str(), "ab+");
+        if (!file_) throw std::runtime_error("Cannot open rating log: " + path);
+
+        std::fseek(file_, 0, SEEK_END);
+        long size = std::ftell(file_);
+        if (size < static_cast<long>(sizeof(kMagic))) {
+            // Пустой файл или заголовок, оборванный сбоем при создании
+            if (size > 0) truncateFile(file_, 0);
+            std::fwrite(kMagic, 1, sizeof(kMagic), file_);
+            std::fflush(file_);
+            syncFile(file_);
+        } else {
+            // Недописанный после сбоя хвост отрезается: иначе новые записи
+            // оказались бы за повреждённой и не прочитались бы при replay.
+            try {
+                existing_ = replay(path, [](const RatingEvent&) {});
+            } catch (...) {
+                std::fclose(file_);
+                throw;
+            }
+            std::size_t valid = sizeof(kMagic) + existing_ * kRecordSize;
+            if (static_cast<long>(valid) < size) {
+                std::fflush(file_);
+                truncateFile(file_, valid);
+            }
+        }
+        buffer_.reserve(options_.syncEveryRecords * kRecordSize);
+    }
+
+    RatingLog::~RatingLog() {
+        if (!file_) return;
+        try {
+            sync();
+        } catch (...) {
+            // Деструктор не бросает; недописанный хвост отбросится при replay
+        }
+        std::fclose(file_);
+    }
+
+    void RatingLog::encode(const RatingEvent& event, unsigned char* out) {
+        std::memset(out, 0, kRecordSize);
+        put<std::uint8_t>(out, 0, static_cast<std::uint8_t>(event.type));
+        put<std::int32_t>(out, 4, event.rating.userId);
+        put<std::int32_t>(out, 8, event.rating.itemId);
+        put<double>(out, 12, event.rating.score);
+        put<std::int64_t>(out, 20, static_cast<std::int64_t>(event.rating.timestamp));
+        put<std::uint32_t>(out, kPayloadSize, crc32(out, kPayloadSize));
+    }
+
+    bool RatingLog::decode(const unsigned char* in, RatingEvent& event) {
+        if (get<std::uint32_t>(in, kPayloadSize) != crc32(in, kPayloadSize)) return false;
+
+        auto type = get<std::uint8_t>(in, 0);
+        if (type != static_cast<std::uint8_t>(RatingEvent::Type::Upsert) &&
+            type != static_cast<std::uint8_t>(RatingEvent::Type::Remove)) {
+            return false;
+        }
+        event.type = static_cast<RatingEvent::Type>(type);
+        event.rating = Rating(get<std::int32_t>(in, 4),
+                              get<std::int32_t>(in, 8),
+                              get<double>(in, 12),
+                              static_cast<std::time_t>(get<std::int64_t>(in, 20)));
+        return true;
+    }
+
+    void RatingLog::append(const RatingEvent& event) {
+        std::size_t offset = buffer_.size();
+        buffer_.resize(offset + kRecordSize);
+        encode(event, buffer_.data() + offset);
+        ++pending_;
+        ++appended_;
+
+        if (pending_ >= options_.syncEveryRecords ||
+            std::chrono::steady_clock::now() - lastSync_ >= options_.syncInterval) {
+            flushLocked();
+        }
+    }
+
+    void RatingLog::sync() {
+        flushLocked();
+    }
+
+    void RatingLog::flushLocked() {
+        if (!buffer_.empty()) {
+            if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size() ||
+                std::fflush(file_) != 0) {
+                throw std::runtime_error("Failed to write rating log: " + path_);
+            }
+            buffer_.clear();
+        }
+        if (pending_ > 0) syncFile(file_);
+        pending_ = 0;
+        lastSync_ = std::chrono::steady_clock::now();
+    }
+
+    RatingLog::Reader::Reader(const std::string& path, std::size_t blockRecords)
+        : block_(std::max<std::size_t>(blockRecords, 1) * kRecordSize) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) return;
+
+        char magic[sizeof(kMagic)] = {};
+        std::size_t got = std::fread(magic, 1, sizeof(magic), file_);
+        if (got < sizeof(magic)) {
+            std::fclose(file_);
+            file_ = nullptr;
+            return;
+        }
+        if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+            std::fclose(file_);
+            file_ = nullptr;
+            throw std::runtime_error("Not a rating log: " + path);
+        }
+    }
+
+    RatingLog::Reader::~Reader() {
+        if (file_) std::fclose(file_);
+    }
+
+    bool RatingLog::Reader::next(RatingEvent& event) {
+        if (!file_) return false;
+
+        if (end_ - pos_ < kRecordSize) {
+            // Читаем крупными блоками: журнал — чисто последовательный файл
+            end_ = std::fread(block_.data(), 1, block_.size(), file_);
+            pos_ = 0;
+        }
+        if (end_ - pos_ < kRecordSize || !decode(block_.data() + pos_, event)) {
+            // Конец файла или повреждённая запись: всё дальше считается недописанным хвостом
+            std::fclose(file_);
+            file_ = nullptr;
+            return false;
+        }
+        pos_ += kRecordSize;
+        ++count_;
+        return true;
+    }
+
+    std::size_t RatingLog::replay(const std::string& path,
+                                  const std::function<void(const RatingEvent&)>& callback) {
+        Reader reader(path);
+        RatingEvent event;
+        while (reader.next(event)) callback(event);
+        return reader.count();
+    }
+
+} // namespace recsys
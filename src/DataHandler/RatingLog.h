@@ -0,0 +1,168 @@
+/**
+ * @file RatingLog.h
+ * @brief Двоичный журнал событий оценок (write-ahead log).
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../Models/Rating.h"
+
+namespace recsys {
+
+    /**
+     * @struct RatingEvent
+     * @brief Событие журнала: установка или удаление оценки.
+     */
+    struct RatingEvent {
+        /// Тип события
+        enum class Type : std::uint8_t {
+            Upsert = 1,  ///< Добавить или заменить оценку
+            Remove = 2   ///< Удалить оценку пары (userId, itemId)
+        };
+
+        Type type = Type::Upsert; ///< Тип события
+        Rating rating;            ///< Оценка (для Remove важны только userId и itemId)
+    };
+
+    /**
+     * @class RatingLog
+     * @brief Журнал, в который события только дописываются.
+     *
+     * Формат файла: 8-байтовая сигнатура "RSYSWAL1", затем записи фиксированного
+     * размера (32 байта, little-endian):
+     * ```
+     * type:u8 pad:u8[3] userId:i32 itemId:i32 score:f64 timestamp:i64 crc32:u32
+     * ```
+     * CRC покрывает первые 28 байт записи. При чтении оборванная или
+     * повреждённая запись в конце файла (сбой во время записи) отбрасывается.
+     *
+     * Записи накапливаются в буфере и сбрасываются на диск с fsync пачками:
+     * когда набралось syncEveryRecords записей или с последней синхронизации
+     * прошло syncInterval. Явный sync() — точка долговечности для вызывающего.
+     *
+     * Класс не потокобезопасен; RatingStore сериализует доступ мьютексом.
+     */
+    class RatingLog {
+    public:
+        /// Размер одной записи в байтах.
+        static constexpr std::size_t kRecordSize = 32;
+
+        /**
+         * @struct Options
+         * @brief Параметры пакетной синхронизации.
+         */
+        struct Options {
+            std::size_t syncEveryRecords = 256;                ///< Записей до принудительного fsync
+            std::chrono::milliseconds syncInterval{20};        ///< Максимальная задержка fsync
+        };
+
+        /**
+         * @brief Открывает журнал на дозапись (создаёт при отсутствии).
+         * @throws std::runtime_error Если файл не открывается или имеет чужой формат
+         */
+        explicit RatingLog(const std::string& path, Options options);
+
+        /// Открывает журнал с параметрами по умолчанию.
+        explicit RatingLog(const std::string& path) : RatingLog(path, Options{}) {}
+
+        /// Синхронизирует хвост и закрывает файл.
+        ~RatingLog();
+
+        RatingLog(const RatingLog&) = delete;
+        RatingLog& operator=(const RatingLog&) = delete;
+
+        /**
+         * @brief Добавляет событие; fsync выполняется по правилам пакетирования.
+         * @throws std::runtime_error При ошибке записи
+         */
+        void append(const RatingEvent& event);
+
+        /**
+         * @brief Записывает буфер и выполняет fsync.
+         * @throws std::runtime_error При ошибке записи
+         */
+        void sync();
+
+        /// Число записей, добавленных через этот объект.
+        std::size_t appended() const { return appended_; }
+
+        /// Общее число записей в журнале (найденных при открытии и добавленных).
+        std::size_t records() const { return existing_ + appended_; }
+
+        /// Путь к файлу журнала.
+        const std::string& path() const { return path_; }
+
+        /**
+         * @class Reader
+         * @brief Последовательное чтение журнала по одному событию (с буферизацией блоками).
+         *
+         * Как и replay(), останавливается на первой повреждённой записи.
+         * Нужен там, где чтение управляется вызывающим, например при слиянии
+         * нескольких отсортированных журналов.
+         */
+        class Reader {
+        public:
+            /**
+             * @brief Открывает журнал на чтение; отсутствующий файл считается пустым.
+             * @throws std::runtime_error Если у файла чужая сигнатура
+             */
+            explicit Reader(const std::string& path, std::size_t blockRecords = 4096);
+
+            ~Reader();
+
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+
+            /// Читает следующее событие; false — журнал закончился.
+            bool next(RatingEvent& event);
+
+            /// Число прочитанных корректных записей.
+            std::size_t count() const { return count_; }
+
+        private:
+            std::FILE* file_ = nullptr;
+            std::vector<unsigned char> block_;
+            std::size_t pos_ = 0;   ///< Смещение следующей записи в block_
+            std::size_t end_ = 0;   ///< Байт прочитано в block_
+            std::size_t count_ = 0;
+        };
+
+        /**
+         * @brief Последовательно читает журнал и вызывает callback для каждого события.
+         *
+         * @param path Путь к журналу; отсутствующий файл считается пустым
+         * @param callback Обработчик события
+         * @return Число прочитанных корректных записей
+         * @throws std::runtime_error Если у файла чужая сигнатура
+         */
+        static std::size_t replay(const std::string& path,
+                                  const std::function<void(const RatingEvent&)>& callback);
+
+        /// Кодирует событие в запись журнала.
+        static void encode(const RatingEvent& event, unsigned char* out);
+
+        /// Декодирует запись; false, если CRC не совпал или тип неизвестен.
+        static bool decode(const unsigned char* in, RatingEvent& event);
+
+    private:
+        /// Пишет буфер в файл и делает fsync.
+        void flushLocked();
+
+        std::string path_;
+        Options options_;
+        std::FILE* file_ = nullptr;
+        std::vector<unsigned char> buffer_;
+        std::size_t pending_ = 0;
+        std::size_t appended_ = 0;
+        std::size_t existing_ = 0;
+        std::chrono::steady_clock::time_point lastSync_;
+    };
+
+} // namespace recsys
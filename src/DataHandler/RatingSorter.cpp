@@ -0,0 +1,138 @@
+#include "RatingSorter.h"
+#include "RatingLog.h"
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace recsys {
+
+    namespace fs = std::filesystem;
+
+    namespace {
+
+        bool earlier(const Rating& a, const Rating& b) {
+            return a.timestamp < b.timestamp;
+        }
+
+    } // namespace
+
+    RatingSorter::RatingSorter(Options options) : options_(std::move(options)) {
+        if (options_.runRecords == 0) throw std::invalid_argument("Run size must be positive");
+
+        fs::path dir = options_.tempDir.empty() ? fs::temp_directory_path() : fs::path(options_.tempDir);
+        std::random_device rd;
+        std::ostringstream name;
+        name << "recsys-sort-" << std::hex << rd() << rd() << "-";
+        prefix_ = (dir / name.str()).string();
+    }
+
+    RatingSorter::~RatingSorter() {
+        removeRuns();
+    }
+
+    void RatingSorter::add(const Rating& rating) {
+        buffer_.push_back(rating);
+        ++size_;
+        if (buffer_.size() >= options_.runRecords) spill();
+    }
+
+    void RatingSorter::spill() {
+        std::stable_sort(buffer_.begin(), buffer_.end(), earlier);
+
+        std::string path = prefix_ + std::to_string(runs_.size()) + ".run";
+        std::error_code ec;
+        fs::remove(path, ec); // журнал открывается на дозапись
+        runs_.push_back(path);
+        runSizes_.push_back(buffer_.size());
+
+        // Серия временная: достаточно одного fsync в конце, а не пачками
+        RatingLog::Options logOptions;
+        logOptions.syncEveryRecords = buffer_.size();
+        logOptions.syncInterval = std::chrono::hours(24);
+        RatingLog run(path, logOptions);
+        RatingEvent event;
+        for (const auto& r : buffer_) {
+            event.rating = r;
+            run.append(event);
+        }
+        run.sync();
+
+        buffer_.clear();
+    }
+
+    std::size_t RatingSorter::merge(const std::function<void(const Rating&)>& callback) {
+        std::stable_sort(buffer_.begin(), buffer_.end(), earlier);
+
+        // Источник с меньшим номером выигрывает при равных метках: серии
+        // записаны в порядке добавления, буфер в памяти — самый поздний.
+        struct Head {
+            long timestamp;
+            std::size_t source;
+            bool operator>(const Head& other) const {
+                return timestamp != other.timestamp ? timestamp > other.timestamp : source > other.source;
+            }
+        };
+
+        const std::size_t memory = runs_.size();
+        std::vector<std::unique_ptr<RatingLog::Reader>> readers;
+        std::vector<Rating> current(runs_.size() + 1);
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+        std::size_t bufferPos = 0;
+
+        auto advance = [&](std::size_t source) {
+            if (source == memory) {
+                if (bufferPos == buffer_.size()) return;
+                current[source] = buffer_[bufferPos++];
+            } else {
+                RatingEvent event;
+                if (!readers[source]->next(event)) {
+                    if (readers[source]->count() != runSizes_[source]) {
+                        throw std::runtime_error("Sort run is truncated: " + runs_[source]);
+                    }
+                    return;
+                }
+                current[source] = event.rating;
+            }
+            heap.push({static_cast<long>(current[source].timestamp), source});
+        };
+
+        try {
+            for (const auto& path : runs_) readers.push_back(std::make_unique<RatingLog::Reader>(path));
+            for (std::size_t s = 0; s <= memory; ++s) advance(s);
+
+            std::size_t count = 0;
+            while (!heap.empty()) {
+                std::size_t source = heap.top().source;
+                heap.pop();
+                callback(current[source]);
+                ++count;
+                advance(source);
+            }
+
+            readers.clear();
+            buffer_.clear();
+            removeRuns();
+            size_ = 0;
+            return count;
+        } catch (...) {
+            readers.clear();
+            buffer_.clear();
+            removeRuns();
+            size_ = 0;
+            throw;
+        }
+    }
+
+    void RatingSorter::removeRuns() {
+        std::error_code ec;
+        for (const auto& path : runs_) fs::remove(path, ec);
+        runs_.clear();
+        runSizes_.clear();
+    }
+
+} // namespace recsys
@@ -0,0 +1,88 @@
+/**
+ * @file RatingSorter.h
+ * @brief Внешняя сортировка оценок по времени с ограниченным расходом памяти.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../Models/Rating.h"
+
+namespace recsys {
+
+    /**
+     * @class RatingSorter
+     * @brief Сортирует поток оценок по Rating::timestamp, держа в памяти не больше runRecords оценок.
+     *
+     * Оценки накапливаются в буфере; заполненный буфер сортируется и
+     * сбрасывается во временный файл-серию в формате RatingLog. merge()
+     * сливает серии и остаток буфера k-путевым слиянием, читая каждую серию
+     * блоками через RatingLog::Reader, так что память — O(runRecords + число серий).
+     *
+     * Сортировка устойчива: оценки с одинаковой меткой времени выдаются
+     * в порядке добавления.
+     */
+    class RatingSorter {
+    public:
+        /**
+         * @struct Options
+         * @brief Параметры сортировки
+         */
+        struct Options {
+            std::size_t runRecords = 1 << 20;  ///< Оценок в памяти до сброса серии на диск
+            std::string tempDir;               ///< Каталог серий; пустой — системный временный
+        };
+
+        /// Создаёт пустой сортировщик.
+        explicit RatingSorter(Options options);
+
+        /// Создаёт сортировщик с параметрами по умолчанию.
+        RatingSorter() : RatingSorter(Options{}) {}
+
+        /// Удаляет оставшиеся временные файлы.
+        ~RatingSorter();
+
+        RatingSorter(const RatingSorter&) = delete;
+        RatingSorter& operator=(const RatingSorter&) = delete;
+
+        /**
+         * @brief Добавляет оценку; при заполнении буфера пишет серию на диск.
+         * @throws std::runtime_error При ошибке записи серии
+         */
+        void add(const Rating& rating);
+
+        /**
+         * @brief Выдаёт все добавленные оценки по возрастанию timestamp.
+         *
+         * После слияния сортировщик пуст и может использоваться снова.
+         * @param callback Обработчик оценки
+         * @return Число выданных оценок
+         * @throws std::runtime_error Если серия не читается целиком
+         */
+        std::size_t merge(const std::function<void(const Rating&)>& callback);
+
+        /// Число добавленных и ещё не выданных оценок.
+        std::size_t size() const { return size_; }
+
+        /// Число серий, записанных на диск.
+        std::size_t runs() const { return runs_.size(); }
+
+    private:
+        /// Сортирует буфер и записывает его в новую серию.
+        void spill();
+
+        /// Удаляет файлы серий.
+        void removeRuns();
+
+        Options options_;
+        std::string prefix_;              ///< Общий префикс путей серий этого объекта
+        std::vector<Rating> buffer_;      ///< Ещё не сброшенные оценки
+        std::vector<std::string> runs_;   ///< Пути серий в порядке записи
+        std::vector<std::size_t> runSizes_;
+        std::size_t size_ = 0;
+    };
+
+} // namespace recsys
@@ -0,0 +1,193 @@
+#include "RatingStore.h"
+#include "CSVLoader.h"
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace recsys {
+
+    namespace {
+
+        namespace fs = std::filesystem;
+
+        /// Применяет событие журнала к набору данных; некорректные оценки пропускаются.
+        void applyEvent(Dataset& dataset, const RatingEvent& event) {
+            if (event.type == RatingEvent::Type::Remove) {
+                dataset.remove(event.rating.userId, event.rating.itemId);
+                return;
+            }
+            try {
+                dataset.upsert(event.rating);
+            } catch (const std::invalid_argument&) {
+                // Такая оценка не прошла бы и CSVLoader
+            }
+        }
+
+        /// Загружает базовый CSV; повторные пары (user, item) схлопываются в последнюю.
+        Dataset loadBase(const std::string& path) {
+            Dataset dataset;
+            if (!fs::exists(path)) return dataset;
+
+            std::vector<User> users;
+            std::vector<Item> items;
+            CSVLoader::load(path, users, items, false);
+            for (const auto& u : users) {
+                for (const auto& [itemId, r] : u.getRatings()) dataset.upsert(r);
+            }
+            return dataset;
+        }
+
+        /// fsync каталога, чтобы переименование пережило сбой питания.
+        void syncDirectory(const fs::path& dir) {
+#ifndef _WIN32
+            int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                ::fsync(fd);
+                ::close(fd);
+            }
+#else
+            (void)dir;
+#endif
+        }
+
+        /// Записывает набор данных в CSV в формате CSVLoader и делает fsync.
+        void writeCsv(const Dataset& dataset, const std::string& path) {
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            if (!file) throw std::runtime_error("Cannot create file: " + path);
+
+            std::vector<char> buffer(1 << 20);
+            std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+            bool ok = std::fputs("userId,itemId,rating,timestamp\n", file) >= 0;
+            for (const auto& u : dataset.users()) {
+                for (const auto& [itemId, r] : u.getRatings()) {
+                    ok = ok && std::fprintf(file, "%d,%d,%.17g,%lld\n", r.userId, r.itemId, r.score,
+                                            static_cast<long long>(r.timestamp)) > 0;
+                }
+            }
+            ok = ok && std::fflush(file) == 0;
+#ifdef _WIN32
+            _commit(_fileno(file));
+#else
+            ok = ok && ::fsync(fileno(file)) == 0;
+#endif
+            std::fclose(file);
+            if (!ok) throw std::runtime_error("Failed to write file: " + path);
+        }
+
+    } // namespace
+
+    RatingStore::RatingStore(std::string basePath, Options options)
+        : basePath_(std::move(basePath)), options_(options) {
+        log_ = std::make_unique<RatingLog>(logPath(basePath_), options_.log);
+        if (options_.background) worker_ = std::thread(&RatingStore::backgroundLoop, this);
+    }
+
+    RatingStore::~RatingStore() {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex_);
+            stopping_ = true;
+        }
+        stopCv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+
+        std::lock_guard<std::mutex> lock(logMutex_);
+        log_.reset();
+    }
+
+    Dataset RatingStore::load(const std::string& basePath) {
+        Dataset dataset = loadBase(basePath);
+        auto apply = [&](const RatingEvent& e) { applyEvent(dataset, e); };
+        RatingLog::replay(sealedPath(basePath), apply);
+        RatingLog::replay(logPath(basePath), apply);
+        return dataset;
+    }
+
+    void RatingStore::recordUpsert(const Rating& rating) {
+        append({RatingEvent::Type::Upsert, rating});
+    }
+
+    void RatingStore::recordRemove(int userId, int itemId) {
+        append({RatingEvent::Type::Remove, Rating(userId, itemId, 0.0, 0)});
+    }
+
+    void RatingStore::append(const RatingEvent& event) {
+        std::lock_guard<std::mutex> lock(logMutex_);
+        log_->append(event);
+    }
+
+    void RatingStore::sync() {
+        std::lock_guard<std::mutex> lock(logMutex_);
+        log_->sync();
+    }
+/**
+     * @brief Сливает базовый файл с запечатанным журналом
+     *
+     * @details Шаги:
+     * 1. Под блокировкой писателей: активный журнал синхронизируется,
+     *    переименовывается в `.wal.sealed`, открывается новый пустой журнал.
+     *    Если запечатанный журнал уже есть (прошлая компактация прервалась),
+     *    ротация пропускается и доделывается прерванное слияние.
+     * 2. Без блокировки писателей: база + запечатанный журнал записываются
+     *    во временный файл, который переименованием заменяет базу.
+     * 3. Запечатанный журнал удаляется.
+     */
+
+    bool RatingStore::compact() {
+        std::lock_guard<std::mutex> compactLock(compactMutex_);
+        const std::string sealed = sealedPath(basePath_);
+
+        {
+            std::lock_guard<std::mutex> lock(logMutex_);
+            if (!fs::exists(sealed)) {
+                if (log_->records() == 0) return false;
+                log_->sync();
+                log_.reset();
+                fs::rename(logPath(basePath_), sealed);
+                log_ = std::make_unique<RatingLog>(logPath(basePath_), options_.log);
+            }
+        }
+
+        Dataset merged = loadBase(basePath_);
+        RatingLog::replay(sealed, [&](const RatingEvent& e) { applyEvent(merged, e); });
+
+        const std::string tmp = basePath_ + ".tmp";
+        writeCsv(merged, tmp);
+        fs::rename(tmp, basePath_);
+        syncDirectory(fs::path(basePath_).parent_path());
+
+        fs::remove(sealed);
+        ++compactions_;
+        return true;
+    }
+
+    void RatingStore::backgroundLoop() {
+        std::unique_lock<std::mutex> lock(stopMutex_);
+        while (!stopCv_.wait_for(lock, options_.checkInterval, [this] { return stopping_; })) {
+            lock.unlock();
+            try {
+                bool due = false;
+                {
+                    std::lock_guard<std::mutex> logLock(logMutex_);
+                    // Ограничиваем задержку долговечности простаивающего хвоста журнала
+                    log_->sync();
+                    due = log_->records() >= options_.compactAfterRecords;
+                }
+                if (due || fs::exists(sealedPath(basePath_))) compact();
+            } catch (const std::exception& e) {
+                std::cerr << "RatingStore compaction failed: " << e.what() << "\n";
+            }
+            lock.lock();
+        }
+    }
+
+} // namespace recsys
@@ -0,0 +1,123 @@
+/**
+ * @file RatingStore.h
+ * @brief Долговечное хранилище оценок: базовый CSV-снимок + журнал изменений.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "RatingLog.h"
+#include "../Models/Dataset.h"
+
+namespace recsys {
+
+    /**
+     * @class RatingStore
+     * @brief Хранит оценки в стиле LSM: неизменяемый базовый файл и журнал дельт.
+     *
+     * Файлы рядом с базовым CSV `<base>`:
+     * - `<base>.wal` — активный журнал, в который дописываются новые события;
+     * - `<base>.wal.sealed` — журнал, закрытый для записи и ожидающий слияния.
+     *
+     * Компактация: активный журнал «запечатывается» (переименование и новый
+     * пустой журнал — единственная операция под блокировкой писателей), затем
+     * в фоне базовый файл и запечатанный журнал последовательно сливаются во
+     * временный CSV, который атомарно заменяет базовый. Все операции ввода-вывода
+     * последовательные. Сбой на любом шаге безопасен: load() применяет
+     * запечатанный журнал поверх базы повторно, а события идемпотентны.
+     *
+     * Методы append/sync/compact потокобезопасны.
+     */
+    class RatingStore {
+    public:
+        /**
+         * @struct Options
+         * @brief Параметры журнала и фоновой компактации.
+         */
+        struct Options {
+            RatingLog::Options log;                            ///< Пакетирование fsync
+            std::size_t compactAfterRecords = 100000;          ///< Размер журнала, запускающий компактацию
+            std::chrono::milliseconds checkInterval{500};      ///< Период фонового потока
+            bool background = true;                            ///< Запускать ли фоновый поток
+        };
+
+        /**
+         * @brief Открывает хранилище (создаёт активный журнал при отсутствии).
+         * @param basePath Путь к базовому CSV-файлу (может ещё не существовать)
+         */
+        RatingStore(std::string basePath, Options options);
+
+        /// Открывает хранилище с параметрами по умолчанию.
+        explicit RatingStore(std::string basePath) : RatingStore(std::move(basePath), Options{}) {}
+
+        /// Останавливает фоновый поток и синхронизирует журнал.
+        ~RatingStore();
+
+        RatingStore(const RatingStore&) = delete;
+        RatingStore& operator=(const RatingStore&) = delete;
+
+        /**
+         * @brief Восстанавливает набор данных: база, затем запечатанный и активный журналы.
+         *
+         * Вызывается при старте до первых append().
+         * @param basePath Путь к базовому CSV-файлу
+         */
+        static Dataset load(const std::string& basePath);
+
+        /// Журналирует добавление или замену оценки.
+        void recordUpsert(const Rating& rating);
+
+        /// Журналирует удаление оценки.
+        void recordRemove(int userId, int itemId);
+
+        /// Журналирует произвольное событие.
+        void append(const RatingEvent& event);
+
+        /// Делает все журналированные события долговечными (fsync).
+        void sync();
+
+        /**
+         * @brief Выполняет компактацию синхронно.
+         * @return true, если новый базовый файл был записан
+         */
+        bool compact();
+
+        /// Число завершённых компактаций.
+        std::size_t compactions() const { return compactions_.load(); }
+
+        /// Путь к базовому файлу.
+        const std::string& basePath() const { return basePath_; }
+
+        /// Путь к активному журналу.
+        static std::string logPath(const std::string& basePath) { return basePath + ".wal"; }
+
+        /// Путь к запечатанному журналу.
+        static std::string sealedPath(const std::string& basePath) { return basePath + ".wal.sealed"; }
+
+    private:
+        /// Цикл фонового потока.
+        void backgroundLoop();
+
+        std::string basePath_;
+        Options options_;
+
+        std::mutex logMutex_;                ///< Защищает log_
+        std::unique_ptr<RatingLog> log_;
+
+        std::mutex compactMutex_;            ///< Не даёт двум компактациям идти одновременно
+        std::atomic<std::size_t> compactions_{0};
+
+        std::mutex stopMutex_;
+        std::condition_variable stopCv_;
+        bool stopping_ = false;
+        std::thread worker_;
+    };
+
+} // namespace recsys
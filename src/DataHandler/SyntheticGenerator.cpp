@@ -0,0 +1,331 @@
+#include "SyntheticGenerator.h"
+#include "RatingLog.h"
+#include "../Utils/Parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace recsys {
+
+    namespace {
+
+        /// SplitMix64: дёшево создаётся на каждого пользователя.
+        struct SplitMix64 {
+            std::uint64_t state;
+
+            std::uint64_t next() {
+                std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            }
+
+            /// Равномерное число из [0, n).
+            std::uint64_t below(std::uint64_t n) { return next() % n; }
+
+            /// Равномерное число из [0, 1).
+            double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+        };
+
+        /// Генератор потока stream, независимый от остальных потоков того же зерна.
+        SplitMix64 streamFor(std::uint64_t seed, std::uint64_t stream) {
+            SplitMix64 mix{seed ^ (stream * 0xD1B54A32D192ED03ull)};
+            return SplitMix64{mix.next()};
+        }
+
+        /// Поток генератора для перестановок и таблиц (не пересекается с пользователями).
+        constexpr std::uint64_t kSetupStream = ~0ull;
+
+        /// Оценок в одной пачке записи.
+        constexpr std::uint64_t kBatchRatings = 1 << 20;
+
+        /// Пользователей в одной задаче форматирования.
+        constexpr std::size_t kUsersPerTask = 256;
+
+        /// Пачки пользователей [begin, end) примерно по kBatchRatings оценок.
+        template <class Fn>
+        void forEachBatch(const std::vector<std::uint32_t>& counts, Fn&& fn) {
+            std::size_t begin = 0;
+            std::uint64_t inBatch = 0;
+            for (std::size_t u = 0; u < counts.size(); ++u) {
+                inBatch += counts[u];
+                if (inBatch >= kBatchRatings) {
+                    fn(begin, u + 1);
+                    begin = u + 1;
+                    inBatch = 0;
+                }
+            }
+            if (begin < counts.size()) fn(begin, counts.size());
+        }
+
+        void writeAll(std::FILE* file, const char* data, std::size_t size, const std::string& path) {
+            if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+                std::fclose(file);
+                throw std::runtime_error("Failed to write file: " + path);
+            }
+        }
+
+    } // namespace
+
+    SyntheticGenerator::SyntheticGenerator(Config config) : config_(std::move(config)) {
+        if (config_.users == 0 || config_.items == 0) throw std::invalid_argument("Users and items must be positive");
+        if (config_.items > 0xFFFFFFFFull || config_.users > 0x7FFFFFFFull) {
+            throw std::invalid_argument("Too many users or items");
+        }
+        if (config_.itemSkew < 0.0 || config_.userSkew < 0.0) throw std::invalid_argument("Skew must not be negative");
+        if (config_.spanSeconds <= 0) throw std::invalid_argument("Timestamp span must be positive");
+        if (config_.scoreWeights.empty()) throw std::invalid_argument("Score weights must not be empty");
+
+        double weightSum = 0.0;
+        for (double w : config_.scoreWeights) {
+            if (w < 0.0) throw std::invalid_argument("Score weights must not be negative");
+            weightSum += w;
+        }
+        if (!(weightSum > 0.0)) throw std::invalid_argument("Score weights must not all be zero");
+        for (double w : config_.scoreWeights) scoreCdf_.push_back((scoreCdf_.empty() ? 0.0 : scoreCdf_.back()) + w / weightSum);
+        scoreCdf_.back() = 1.0;
+
+        const std::size_t U = config_.users, I = config_.items;
+        const std::uint32_t cap = static_cast<std::uint32_t>(std::max<std::size_t>(1, I / 2));
+        std::uint64_t target = config_.ratings;
+        if (target == 0) {
+            if (!(config_.density > 0.0 && config_.density <= 1.0)) throw std::invalid_argument("Density must be in (0, 1]");
+            target = static_cast<std::uint64_t>(config_.density * static_cast<double>(U) * static_cast<double>(I) + 0.5);
+        }
+        target = std::min<std::uint64_t>(std::max<std::uint64_t>(target, U), static_cast<std::uint64_t>(U) * cap);
+
+        SplitMix64 rng = streamFor(config_.seed, kSetupStream);
+
+        // --- Популярность товаров: таблица alias (метод Воуза) ---
+        std::vector<double> p(I);
+        for (std::size_t r = 0; r < I; ++r) p[r] = std::pow(static_cast<double>(r + 1), -config_.itemSkew);
+        const double pSum = std::accumulate(p.begin(), p.end(), 0.0);
+        aliasProb_.resize(I);
+        alias_.resize(I);
+        std::vector<std::uint32_t> small, large;
+        for (std::size_t r = 0; r < I; ++r) {
+            p[r] *= static_cast<double>(I) / pSum;
+            (p[r] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(r));
+        }
+        while (!small.empty() && !large.empty()) {
+            std::uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            aliasProb_[s] = p[s];
+            alias_[s] = l;
+            p[l] -= 1.0 - p[s];
+            if (p[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Оставшиеся ячейки заполнены целиком (для small — с точностью до округления)
+        for (auto* rest : {&large, &small}) {
+            for (auto r : *rest) {
+                aliasProb_[r] = 1.0;
+                alias_[r] = r;
+            }
+        }
+
+        itemIds_.resize(I);
+        std::iota(itemIds_.begin(), itemIds_.end(), 1);
+        for (std::size_t i = I; i > 1; --i) std::swap(itemIds_[i - 1], itemIds_[rng.below(i)]);
+
+        // --- Активность пользователей: множитель c подбирается бинпоиском,
+        // чтобы Σ clamp(round(c · w_r), 1, cap) была как можно ближе к target ---
+        std::vector<double> w(U);
+        for (std::size_t r = 0; r < U; ++r) w[r] = std::pow(static_cast<double>(r + 1), -config_.userSkew);
+        auto sumFor = [&](double c) {
+            std::uint64_t sum = 0;
+            for (double x : w) {
+                double n = std::min<double>(cap, std::max(1.0, std::floor(c * x + 0.5)));
+                sum += static_cast<std::uint64_t>(n);
+            }
+            return sum;
+        };
+        double lo = 0.0, hi = static_cast<double>(target) / w.back() + 1.0;
+        for (int iter = 0; iter < 64 && sumFor(hi) < target; ++iter) hi *= 2.0;
+        for (int iter = 0; iter < 100; ++iter) {
+            double mid = 0.5 * (lo + hi);
+            (sumFor(mid) < target ? lo : hi) = mid;
+        }
+
+        std::vector<std::size_t> userOfRank(U);
+        std::iota(userOfRank.begin(), userOfRank.end(), 0);
+        for (std::size_t i = U; i > 1; --i) std::swap(userOfRank[i - 1], userOfRank[rng.below(i)]);
+
+        counts_.resize(U);
+        for (std::size_t r = 0; r < U; ++r) {
+            double n = std::min<double>(cap, std::max(1.0, std::floor(hi * w[r] + 0.5)));
+            counts_[userOfRank[r]] = static_cast<std::uint32_t>(n);
+            total_ += static_cast<std::uint64_t>(n);
+        }
+    }
+
+    std::uint32_t SyntheticGenerator::sampleItemRank(std::uint64_t slot, std::uint64_t coin) const {
+        auto r = static_cast<std::uint32_t>(slot % aliasProb_.size());
+        double u = static_cast<double>(coin >> 11) * 0x1.0p-53;
+        return u < aliasProb_[r] ? r : alias_[r];
+    }
+
+    void SyntheticGenerator::generateUser(std::size_t userIndex, std::vector<Rating>& out) const {
+        out.clear();
+        const std::uint32_t count = counts_[userIndex];
+        out.reserve(count);
+        SplitMix64 rng = streamFor(config_.seed, userIndex);
+        const int userId = static_cast<int>(userIndex) + 1;
+
+        // Товары без повторов: отбор с отказами, для длинных профилей — через хеш-множество.
+        // Если отказов слишком много (профиль сравним с «головой» распределения),
+        // недостающие товары добираются подряд по рангам.
+        std::vector<std::uint32_t> ranks;
+        ranks.reserve(count);
+        std::unordered_set<std::uint32_t> seen;
+        const bool useSet = count > 32;
+        if (useSet) seen.reserve(count * 2);
+        auto taken = [&](std::uint32_t r) {
+            return useSet ? seen.count(r) > 0 : std::find(ranks.begin(), ranks.end(), r) != ranks.end();
+        };
+        auto take = [&](std::uint32_t r) {
+            ranks.push_back(r);
+            if (useSet) seen.insert(r);
+        };
+
+        std::uint64_t budget = 8ull * count + 64;
+        while (ranks.size() < count && budget-- > 0) {
+            std::uint64_t slot = rng.next();
+            std::uint32_t r = sampleItemRank(slot, rng.next());
+            if (!taken(r)) take(r);
+        }
+        if (ranks.size() < count) {
+            if (!useSet) seen.insert(ranks.begin(), ranks.end());
+            const auto I = static_cast<std::uint32_t>(aliasProb_.size());
+            for (auto r = static_cast<std::uint32_t>(rng.below(I)); ranks.size() < count; r = (r + 1) % I) {
+                if (seen.insert(r).second) ranks.push_back(r);
+            }
+        }
+
+        for (std::uint32_t r : ranks) {
+            double u = rng.unit();
+            std::size_t s = 0;
+            while (s + 1 < scoreCdf_.size() && u >= scoreCdf_[s]) ++s;
+            long timestamp = config_.startTime + static_cast<long>(rng.below(static_cast<std::uint64_t>(config_.spanSeconds)));
+            out.emplace_back(userId, itemIds_[r], static_cast<double>(s + 1), timestamp);
+        }
+    }
+
+    std::uint64_t SyntheticGenerator::forEach(const std::function<void(const Rating&)>& callback) const {
+        std::vector<Rating> ratings;
+        std::uint64_t count = 0;
+        for (std::size_t u = 0; u < counts_.size(); ++u) {
+            generateUser(u, ratings);
+            for (const auto& r : ratings) callback(r);
+            count += ratings.size();
+        }
+        return count;
+    }
+
+    void SyntheticGenerator::build(std::vector<User>& users, std::vector<Item>& items) const {
+        users.clear();
+        items.clear();
+        users.reserve(counts_.size());
+        items.reserve(itemIds_.size());
+        std::unordered_map<int, std::size_t> itemIndex;
+        std::vector<Rating> ratings;
+        for (std::size_t u = 0; u < counts_.size(); ++u) {
+            generateUser(u, ratings);
+            User user(static_cast<int>(u) + 1);
+            for (const auto& r : ratings) {
+                user.addRating(r);
+                auto [it, inserted] = itemIndex.try_emplace(r.itemId, items.size());
+                if (inserted) items.emplace_back(r.itemId);
+                items[it->second].addRating(r);
+            }
+            users.push_back(std::move(user));
+        }
+    }
+
+    std::uint64_t SyntheticGenerator::writeCsv(const std::string& path, std::size_t threads) const {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) throw std::runtime_error("Cannot open file: " + path);
+        const char header[] = "userId,itemId,rating,timestamp\n";
+        writeAll(file, header, sizeof(header) - 1, path);
+
+        std::uint64_t written = 0;
+        std::vector<std::string> chunks;
+        forEachBatch(counts_, [&](std::size_t begin, std::size_t end) {
+            const std::size_t tasks = (end - begin + kUsersPerTask - 1) / kUsersPerTask;
+            chunks.assign(tasks, std::string());
+            parallelFor(tasks, [&](std::size_t t) {
+                std::vector<Rating> ratings;
+                std::string& text = chunks[t];
+                char buf[64];
+                const std::size_t last = std::min(end, begin + (t + 1) * kUsersPerTask);
+                for (std::size_t u = begin + t * kUsersPerTask; u < last; ++u) {
+                    generateUser(u, ratings);
+                    for (const auto& r : ratings) {
+                        char* p = buf;
+                        p = std::to_chars(p, buf + sizeof(buf), r.userId).ptr;
+                        *p++ = ',';
+                        p = std::to_chars(p, buf + sizeof(buf), r.itemId).ptr;
+                        *p++ = ',';
+                        p = std::to_chars(p, buf + sizeof(buf), static_cast<int>(r.score)).ptr;
+                        *p++ = ',';
+                        p = std::to_chars(p, buf + sizeof(buf), static_cast<long long>(r.timestamp)).ptr;
+                        *p++ = '\n';
+                        text.append(buf, p);
+                    }
+                }
+            }, threads);
+            for (const auto& text : chunks) writeAll(file, text.data(), text.size(), path);
+            for (std::size_t u = begin; u < end; ++u) written += counts_[u];
+        });
+
+        if (std::fclose(file) != 0) throw std::runtime_error("Failed to write file: " + path);
+        return written;
+    }
+
+    std::uint64_t SyntheticGenerator::writeBinary(const std::string& path, std::size_t threads) const {
+        // Журнал создаётся через RatingLog (сигнатура формата), записи
+        // кодируются параллельно и дописываются блоками без пакетного fsync
+        std::remove(path.c_str());
+        { RatingLog header(path); }
+        std::FILE* file = std::fopen(path.c_str(), "ab");
+        if (!file) throw std::runtime_error("Cannot open file: " + path);
+
+        std::uint64_t written = 0;
+        std::vector<std::vector<unsigned char>> chunks;
+        forEachBatch(counts_, [&](std::size_t begin, std::size_t end) {
+            const std::size_t tasks = (end - begin + kUsersPerTask - 1) / kUsersPerTask;
+            chunks.assign(tasks, {});
+            parallelFor(tasks, [&](std::size_t t) {
+                std::vector<Rating> ratings;
+                auto& bytes = chunks[t];
+                RatingEvent event;
+                const std::size_t last = std::min(end, begin + (t + 1) * kUsersPerTask);
+                for (std::size_t u = begin + t * kUsersPerTask; u < last; ++u) {
+                    generateUser(u, ratings);
+                    std::size_t offset = bytes.size();
+                    bytes.resize(offset + ratings.size() * RatingLog::kRecordSize);
+                    for (const auto& r : ratings) {
+                        event.rating = r;
+                        RatingLog::encode(event, bytes.data() + offset);
+                        offset += RatingLog::kRecordSize;
+                    }
+                }
+            }, threads);
+            for (const auto& bytes : chunks) {
+                writeAll(file, reinterpret_cast<const char*>(bytes.data()), bytes.size(), path);
+            }
+            for (std::size_t u = begin; u < end; ++u) written += counts_[u];
+        });
+
+        if (std::fclose(file) != 0) throw std::runtime_error("Failed to write file: " + path);
+        return written;
+    }
+
+} // namespace recsys
@@ -0,0 +1,124 @@
+/**
+ * @file SyntheticGenerator.h
+ * @brief Генератор синтетических оценок со степенными распределениями.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../Models/User.h"
+#include "../Models/Item.h"
+
+namespace recsys {
+
+    /**
+     * @class SyntheticGenerator
+     * @brief Детерминированно порождает набор оценок заданного размера и формы.
+     *
+     * Модель данных:
+     * - популярность товаров по закону Ципфа: товар ранга r выбирается
+     *   с вероятностью ∝ 1 / (r + 1)^itemSkew (выбор за O(1) по таблице alias);
+     * - активность пользователей тоже по Ципфу с показателем userSkew:
+     *   пользователь ранга r получает ≈ total / (r + 1)^userSkew / H оценок,
+     *   не меньше одной и не больше половины каталога;
+     * - оценки 1..N выбираются по весам scoreWeights;
+     * - метки времени равномерны в [startTime, startTime + spanSeconds).
+     *
+     * Ранги отображаются на ID случайной перестановкой, поэтому популярные
+     * товары и активные пользователи не сосредоточены в начале диапазона ID.
+     *
+     * Оценки каждого пользователя порождаются собственным генератором,
+     * инициализированным от (seed, индекс пользователя): результат не зависит
+     * от числа потоков и от того, какие пользователи генерируются.
+     * Запись в файл идёт пачками пользователей, память не зависит от объёма вывода.
+     */
+    class SyntheticGenerator {
+    public:
+        /**
+         * @struct Config
+         * @brief Параметры набора
+         */
+        struct Config {
+            std::size_t users = 1000;                      ///< Число пользователей
+            std::size_t items = 1000;                      ///< Размер каталога
+            std::uint64_t ratings = 0;                     ///< Целевое число оценок; 0 — по density
+            double density = 0.01;                         ///< Доля заполненной матрицы, если ratings = 0
+            double itemSkew = 1.0;                         ///< Показатель Ципфа популярности товаров
+            double userSkew = 0.8;                         ///< Показатель Ципфа активности пользователей
+            std::vector<double> scoreWeights{0.06, 0.11, 0.27, 0.34, 0.22}; ///< Веса оценок 1..N
+            long startTime = 1500000000;                   ///< Начало интервала меток времени
+            long spanSeconds = 3L * 365 * 86400;           ///< Длина интервала меток времени
+            std::uint64_t seed = 42;                       ///< Зерно
+        };
+
+        /**
+         * @brief Готовит таблицы распределений.
+         * @throws std::invalid_argument При некорректных параметрах
+         */
+        explicit SyntheticGenerator(Config config);
+
+        /// Параметры генератора.
+        const Config& config() const { return config_; }
+
+        /// Точное число оценок, которое будет порождено (≈ целевому).
+        std::uint64_t totalRatings() const { return total_; }
+
+        /// Число оценок пользователя с индексом userIndex.
+        std::uint32_t ratingsOf(std::size_t userIndex) const { return counts_[userIndex]; }
+
+        /**
+         * @brief Порождает оценки одного пользователя (товары без повторов).
+         *
+         * @param userIndex Индекс пользователя в [0, users)
+         * @param out Буфер; заменяется оценками пользователя
+         */
+        void generateUser(std::size_t userIndex, std::vector<Rating>& out) const;
+
+        /**
+         * @brief Передаёт все оценки в callback по порядку пользователей.
+         * @return Число оценок
+         */
+        std::uint64_t forEach(const std::function<void(const Rating&)>& callback) const;
+
+        /**
+         * @brief Строит векторы User и Item в памяти (для тестов и бенчмарков).
+         */
+        void build(std::vector<User>& users, std::vector<Item>& items) const;
+
+        /**
+         * @brief Пишет CSV в формате CSVLoader.
+         *
+         * @param path Путь к файлу
+         * @param threads Потоки форматирования; 0 — весь общий пул
+         * @return Число записанных оценок
+         * @throws std::runtime_error При ошибке записи
+         */
+        std::uint64_t writeCsv(const std::string& path, std::size_t threads = 0) const;
+
+        /**
+         * @brief Пишет двоичный файл в формате RatingLog (события Upsert).
+         *
+         * Файл перезаписывается; читается RatingLog::replay и RatingStore.
+         * @return Число записанных оценок
+         * @throws std::runtime_error При ошибке записи
+         */
+        std::uint64_t writeBinary(const std::string& path, std::size_t threads = 0) const;
+
+    private:
+        /// Ранг товара по таблице alias из двух случайных 64-битных чисел.
+        std::uint32_t sampleItemRank(std::uint64_t slot, std::uint64_t coin) const;
+
+        Config config_;
+        std::vector<std::uint32_t> counts_;     ///< Оценок у пользователя (по индексу)
+        std::vector<int> itemIds_;              ///< Ранг товара → ID
+        std::vector<double> aliasProb_;         ///< Таблица alias: вероятность остаться в ячейке
+        std::vector<std::uint32_t> alias_;      ///< Таблица alias: альтернативная ячейка
+        std::vector<double> scoreCdf_;          ///< Накопленные веса оценок
+        std::uint64_t total_ = 0;
+    };
+
+} // namespace recsys
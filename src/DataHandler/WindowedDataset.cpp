@@ -0,0 +1,102 @@
+#include "WindowedDataset.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace recsys {
+
+    namespace {
+
+        /// Округление вниз до кратного step (корректно и для отрицательных t).
+        long alignDown(long t, long step) {
+            long r = t % step;
+            return r < 0 ? t - r - step : t - r;
+        }
+
+    } // namespace
+
+    WindowedDataset::WindowedDataset(long windowSeconds, long segmentSeconds, bool trackCoRatings)
+        : windowSeconds_(windowSeconds),
+          segmentSeconds_(segmentSeconds),
+          trackCoRatings_(trackCoRatings),
+          horizon_(std::numeric_limits<long>::min()) {
+        if (windowSeconds <= 0 || segmentSeconds <= 0 || segmentSeconds > windowSeconds) {
+            throw std::invalid_argument("Window and segment lengths must satisfy 0 < segment <= window");
+        }
+    }
+
+    WindowedDataset::Segment& WindowedDataset::segmentFor(long timestamp) {
+        long start = alignDown(timestamp, segmentSeconds_);
+
+        // Обычный случай — оценки приходят почти по порядку
+        if (segments_.empty() || segments_.back().start < start) {
+            segments_.push_back({start, {}});
+            return segments_.back();
+        }
+        if (segments_.back().start == start) return segments_.back();
+
+        auto it = std::lower_bound(segments_.begin(), segments_.end(), start,
+                                   [](const Segment& s, long t) { return s.start < t; });
+        if (it != segments_.end() && it->start == start) return *it;
+        return *segments_.insert(it, Segment{start, {}});
+    }
+
+    bool WindowedDataset::append(const Rating& rating) {
+        long ts = static_cast<long>(rating.timestamp);
+        if (ts < horizon_) return false;
+
+        if (const Rating* current = dataset_.findRating(rating.userId, rating.itemId)) {
+            if (current->timestamp > rating.timestamp) return false;
+        }
+
+        auto previous = dataset_.upsert(rating);
+        if (trackCoRatings_) {
+            const Item& item = *dataset_.findItem(rating.itemId);
+            if (previous) coRatings_.removeRating(*previous, item);
+            coRatings_.addRating(rating, item);
+        }
+
+        segmentFor(ts).ratings.push_back(rating);
+        return true;
+    }
+
+    std::size_t WindowedDataset::advanceTo(long now) {
+        horizon_ = std::max(horizon_, now - windowSeconds_);
+
+        std::size_t removed = 0;
+        while (!segments_.empty() && segments_.front().start + segmentSeconds_ <= horizon_) {
+            removed += expire(segments_.front());
+            segments_.pop_front();
+        }
+        return removed;
+    }
+
+    std::size_t WindowedDataset::expire(const Segment& segment) {
+        std::size_t removed = 0;
+        for (const auto& r : segment.ratings) {
+            // Пара могла быть переоценена позже — такую оценку не трогаем
+            const Rating* current = dataset_.findRating(r.userId, r.itemId);
+            if (!current || current->timestamp != r.timestamp || current->score != r.score) continue;
+
+            if (trackCoRatings_) coRatings_.removeRating(r, *dataset_.findItem(r.itemId));
+            dataset_.remove(r.userId, r.itemId);
+            ++removed;
+        }
+        return removed;
+    }
+
+    void WindowedDataset::reportMemory(MemoryReport& report) const {
+        dataset_.reportMemory(report);
+        std::size_t ratings = 0;
+        std::size_t bytes = 0;
+        for (const auto& segment : segments_) {
+            ratings += segment.ratings.size();
+            bytes += MemoryReport::bytesOf(segment.ratings);
+        }
+        // Блоки deque libstdc++ по 512 байт; карта блоков не учитывается
+        bytes += MemoryReport::heapBlock(512) * (segments_.size() * sizeof(Segment) / 512 + 1);
+        report.add("window segments", ratings, bytes);
+        if (trackCoRatings_) report.add("co-rating index", coRatings_.pairCount(), coRatings_.memoryBytes());
+    }
+
+} // namespace recsys
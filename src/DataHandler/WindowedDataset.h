@@ -0,0 +1,101 @@
+/**
+ * @file WindowedDataset.h
+ * @brief Набор данных со скользящим временным окном.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "../Models/Dataset.h"
+#include "../Algorithms/CoRatingIndex.h"
+
+namespace recsys {
+
+    /**
+     * @class WindowedDataset
+     * @brief Хранит только оценки за последние windowSeconds секунд.
+     *
+     * Оценки раскладываются по сегментам фиксированной длительности,
+     * упорядоченным по времени. advanceTo() отбрасывает целые сегменты,
+     * вышедшие за окно, и декрементально обновляет статистики пользователей
+     * и товаров (через Dataset) и суммы CoRatingIndex — без перестроения модели.
+     *
+     * Граница окна выравнивается по сегментам: оценка живёт не меньше
+     * windowSeconds и не больше windowSeconds + segmentSeconds.
+     *
+     * Если пользователь переоценил товар, действует оценка с наибольшей
+     * меткой времени; устаревшая запись в старом сегменте при истечении
+     * не затрагивает более новую.
+     */
+    class WindowedDataset {
+    public:
+        /**
+         * @brief Создаёт пустое окно.
+         *
+         * @param windowSeconds Длина окна (в секундах), > 0
+         * @param segmentSeconds Длительность сегмента (в секундах), 0 < segment ≤ window
+         * @param trackCoRatings Поддерживать ли CoRatingIndex
+         * @throws std::invalid_argument Если параметры некорректны
+         */
+        WindowedDataset(long windowSeconds, long segmentSeconds, bool trackCoRatings = true);
+
+        /**
+         * @brief Добавляет оценку в окно.
+         *
+         * @param rating Оценка с меткой времени
+         * @return false, если оценка уже за пределами окна или старее текущей оценки пары
+         * @throws std::invalid_argument Если оценка некорректна
+         */
+        bool append(const Rating& rating);
+
+        /**
+         * @brief Сдвигает окно: отбрасывает сегменты, целиком старше now − windowSeconds.
+         *
+         * @param now Текущее время (секунды UNIX); окно не сдвигается назад
+         * @return Число оценок, удалённых из набора данных
+         */
+        std::size_t advanceTo(long now);
+
+        /// Текущий набор данных внутри окна.
+        const Dataset& dataset() const { return dataset_; }
+
+        /// Суммы по общим оценкам или nullptr, если они не отслеживаются.
+        const CoRatingIndex* coRatings() const { return trackCoRatings_ ? &coRatings_ : nullptr; }
+
+        /// Число живых сегментов.
+        std::size_t segmentCount() const { return segments_.size(); }
+
+        /// Добавляет в отчёт набор данных окна, сегменты и (если есть) индекс общих оценок.
+        void reportMemory(MemoryReport& report) const;
+
+        /// Нижняя граница окна после последнего advanceTo().
+        long horizon() const { return horizon_; }
+
+    private:
+        /**
+         * @struct Segment
+         * @brief Оценки с метками времени в [start, start + segmentSeconds).
+         */
+        struct Segment {
+            long start;                  ///< Начало сегмента (выровнено)
+            std::vector<Rating> ratings; ///< Оценки в порядке поступления
+        };
+
+        /// Сегмент для метки времени; создаётся при необходимости.
+        Segment& segmentFor(long timestamp);
+
+        /// Удаляет оценки сегмента из набора данных; возвращает число удалённых.
+        std::size_t expire(const Segment& segment);
+
+        long windowSeconds_;           ///< Длина окна
+        long segmentSeconds_;          ///< Длительность сегмента
+        bool trackCoRatings_;          ///< Поддерживается ли coRatings_
+        long horizon_;                 ///< Оценки старше этой метки не принимаются
+        std::deque<Segment> segments_; ///< Сегменты по возрастанию start
+        Dataset dataset_;              ///< Текущие данные окна
+        CoRatingIndex coRatings_;      ///< Суммы по общим оценкам
+    };
+
+} // namespace recsys
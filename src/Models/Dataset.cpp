@@ -0,0 +1,113 @@
+#include "Dataset.h"
+#include <stdexcept>
+
+namespace recsys {
+
+    Dataset::Dataset(std::vector<User> users, std::vector<Item> items)
+        : users_(std::move(users)), items_(std::move(items)) {
+        for (std::size_t i = 0; i < users_.size(); ++i) {
+            if (!userIndex_.emplace(users_[i].getId(), i).second) {
+                throw std::invalid_argument("Duplicate user ID in dataset");
+            }
+            ratingCount_ += users_[i].getRatings().size();
+        }
+        for (std::size_t i = 0; i < items_.size(); ++i) {
+            if (!itemIndex_.emplace(items_[i].getId(), i).second) {
+                throw std::invalid_argument("Duplicate item ID in dataset");
+            }
+        }
+    }
+
+    std::optional<Rating> Dataset::upsert(const Rating& rating) {
+        // Те же проверки, что в User/Item::addRating, но до создания записей,
+        // чтобы некорректная оценка не оставляла пустых пользователей и товаров.
+        if (rating.itemId <= 0) {
+            throw std::invalid_argument("Invalid item ID in rating");
+        }
+        if (rating.score < 0.0 || rating.score > 5.0) {
+            throw std::invalid_argument("Rating score must be in [0, 5]");
+        }
+
+        auto uit = userIndex_.find(rating.userId);
+        if (uit == userIndex_.end()) {
+            users_.emplace_back(rating.userId);
+            uit = userIndex_.emplace(rating.userId, users_.size() - 1).first;
+        }
+        auto iit = itemIndex_.find(rating.itemId);
+        if (iit == itemIndex_.end()) {
+            items_.emplace_back(rating.itemId);
+            iit = itemIndex_.emplace(rating.itemId, items_.size() - 1).first;
+        }
+
+        User& user = users_[uit->second];
+        Item& item = items_[iit->second];
+
+        std::optional<Rating> previous;
+        auto prev = user.getRatings().find(rating.itemId);
+        if (prev != user.getRatings().end()) previous = prev->second;
+
+        if (previous) item.removeRating(rating.userId);
+        item.addRating(rating);
+        user.addRating(rating);
+
+        if (!previous) ++ratingCount_;
+        return previous;
+    }
+
+    std::optional<Rating> Dataset::remove(int userId, int itemId) {
+        auto uit = userIndex_.find(userId);
+        auto iit = itemIndex_.find(itemId);
+        if (uit == userIndex_.end() || iit == itemIndex_.end()) return std::nullopt;
+
+        User& user = users_[uit->second];
+        auto prev = user.getRatings().find(itemId);
+        if (prev == user.getRatings().end()) return std::nullopt;
+
+        Rating removed = prev->second;
+        user.removeRating(itemId);
+        items_[iit->second].removeRating(userId);
+        --ratingCount_;
+        return removed;
+    }
+
+    const Rating* Dataset::findRating(int userId, int itemId) const {
+        const User* user = findUser(userId);
+        if (!user) return nullptr;
+        auto it = user->getRatings().find(itemId);
+        return it != user->getRatings().end() ? &it->second : nullptr;
+    }
+
+    const User* Dataset::findUser(int userId) const {
+        auto it = userIndex_.find(userId);
+        return it != userIndex_.end() ? &users_[it->second] : nullptr;
+    }
+
+    const Item* Dataset::findItem(int itemId) const {
+        auto it = itemIndex_.find(itemId);
+        return it != itemIndex_.end() ? &items_[it->second] : nullptr;
+    }
+
+    void Dataset::reportMemory(MemoryReport& report) const {
+        reportMemory(report, users_, items_);
+        report.add("user id map", userIndex_.size(), MemoryReport::bytesOf(userIndex_));
+        report.add("item id map", itemIndex_.size(), MemoryReport::bytesOf(itemIndex_));
+    }
+
+    void Dataset::reportMemory(MemoryReport& report, const std::vector<User>& users, const std::vector<Item>& items) {
+        std::size_t userRatings = 0, userRatingBytes = 0;
+        for (const auto& user : users) {
+            userRatings += user.getRatings().size();
+            userRatingBytes += MemoryReport::bytesOf(user.getRatings());
+        }
+        std::size_t itemRatings = 0, itemRatingBytes = 0;
+        for (const auto& item : items) {
+            itemRatings += item.getRatings().size();
+            itemRatingBytes += MemoryReport::bytesOf(item.getRatings());
+        }
+        report.add("users", users.size(), MemoryReport::bytesOf(users));
+        report.add("user ratings", userRatings, userRatingBytes);
+        report.add("items", items.size(), MemoryReport::bytesOf(items));
+        report.add("item ratings", itemRatings, itemRatingBytes);
+    }
+
+} // namespace recsys
@@ -0,0 +1,87 @@
+/**
+ * @file Dataset.h
+ * @brief Изменяемый набор данных: пользователи, товары и индексы по ID.
+ */
+
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "User.h"
+#include "Item.h"
+#include "../Utils/MemoryReport.h"
+
+namespace recsys {
+
+    /**
+     * @class Dataset
+     * @brief Владеет векторами User и Item и поддерживает их согласованность.
+     *
+     * Векторы в том же формате, что принимают Predictor и Recommender,
+     * доступны через users() и items(). Пользователи и товары, оставшиеся
+     * без оценок, не удаляются: их позиции в векторах стабильны.
+     */
+    class Dataset {
+    public:
+        Dataset() = default;
+
+        /**
+         * @brief Создаёт набор из уже загруженных векторов (например, из CSVLoader).
+         * @throws std::invalid_argument Если ID пользователей или товаров повторяются.
+         */
+        Dataset(std::vector<User> users, std::vector<Item> items);
+
+        /**
+         * @brief Добавляет оценку или заменяет существующую для той же пары (user, item).
+         *
+         * Недостающие пользователь и товар создаются.
+         * @param rating Новая оценка
+         * @return Предыдущая оценка пары, если она была
+         * @throws std::invalid_argument Если оценка некорректна (см. User/Item::addRating)
+         */
+        std::optional<Rating> upsert(const Rating& rating);
+
+        /**
+         * @brief Удаляет оценку пары (user, item).
+         * @return Удалённая оценка или std::nullopt, если её не было
+         */
+        std::optional<Rating> remove(int userId, int itemId);
+
+        /// Текущая оценка пары (user, item), если она есть.
+        const Rating* findRating(int userId, int itemId) const;
+
+        /// Пользователь по ID или nullptr.
+        const User* findUser(int userId) const;
+
+        /// Товар по ID или nullptr.
+        const Item* findItem(int itemId) const;
+
+        /// Все пользователи (включая оставшихся без оценок).
+        const std::vector<User>& users() const { return users_; }
+
+        /// Все товары (включая оставшиеся без оценок).
+        const std::vector<Item>& items() const { return items_; }
+
+        /// Общее число оценок.
+        std::size_t ratingCount() const { return ratingCount_; }
+
+        /// Добавляет в отчёт пользователей, товары, их оценки и индексы по ID.
+        void reportMemory(MemoryReport& report) const;
+
+        /**
+         * @brief Добавляет в отчёт векторы пользователей и товаров вне Dataset.
+         *
+         * Строки: "users", "user ratings", "items", "item ratings".
+         */
+        static void reportMemory(MemoryReport& report, const std::vector<User>& users, const std::vector<Item>& items);
+
+    private:
+        std::vector<User> users_;                        ///< Пользователи
+        std::vector<Item> items_;                        ///< Товары
+        std::unordered_map<int, std::size_t> userIndex_; ///< userId → позиция в users_
+        std::unordered_map<int, std::size_t> itemIndex_; ///< itemId → позиция в items_
+        std::size_t ratingCount_ = 0;                    ///< Число оценок
+    };
+
+} // namespace recsys
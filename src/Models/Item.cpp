@@ -15,16 +15,25 @@ namespace recsys {
         }
 
         ratings_.push_back(rating);
+        sum_ += rating.score;
     }
 
-    double Item::getAverageRating() const {
-        if (ratings_.empty()) return 0.0;
+    bool Item::removeRating(int userId) {
+        for (std::size_t i = 0; i < ratings_.size(); ++i) {
+            if (ratings_[i].userId != userId) continue;
 
-        double sum = 0.0;
-        for (const auto& r : ratings_) {
-            sum += r.score;
+            sum_ -= ratings_[i].score;
+            ratings_[i] = ratings_.back();
+            ratings_.pop_back();
+            if (ratings_.empty()) sum_ = 0.0;
+            return true;
         }
-        return sum / ratings_.size();
+        return false;
+    }
+
+    double Item::getAverageRating() const {
+        if (ratings_.empty()) return 0.0;
+        return sum_ / ratings_.size();
     }
 
     int Item::getId() const {
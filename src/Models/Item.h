@@ -25,9 +25,21 @@ namespace recsys {  // ✅ Добавить пространство имён
         int getId() const;
         int getRatingCount() const;
 
+        /**
+         * @brief Удаляет оценку заданного пользователя.
+         * @param userId ID пользователя.
+         * @return true, если оценка была найдена и удалена.
+         * @note Порядок оставшихся оценок не сохраняется (удаление обменом с последней).
+         */
+        bool removeRating(int userId);
+
+        /// Все оценки товара.
+        const std::vector<Rating>& getRatings() const { return ratings_; }
+
     private:
         int id_;  ///< Уникальный идентификатор товара.
         std::vector<Rating> ratings_; ///< Список всех оценок, оставленных пользователями.
+        double sum_ = 0.0;            ///< Сумма оценок (для среднего за O(1)).
     };
 
 } // namespace recsys
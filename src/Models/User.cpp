@@ -23,7 +23,34 @@ void User::addRating(const Rating& rating) {
         throw std::invalid_argument("Invalid item ID in rating");
     }
 
-    ratings_[rating.itemId] = rating;
+    auto [it, inserted] = ratings_.try_emplace(rating.itemId, rating);
+    if (!inserted) {
+        sum_ -= it->second.score;
+        sumSq_ -= it->second.score * it->second.score;
+        it->second = rating;
+    }
+    sum_ += rating.score;
+    sumSq_ += rating.score * rating.score;
+}
+
+/**
+ * @brief Удаляет оценку пользователя для товара и корректирует суммы.
+ * @param itemId ID товара.
+ * @return true, если оценка существовала.
+ */
+bool User::removeRating(int itemId) {
+    auto it = ratings_.find(itemId);
+    if (it == ratings_.end()) return false;
+
+    sum_ -= it->second.score;
+    sumSq_ -= it->second.score * it->second.score;
+    ratings_.erase(it);
+    if (ratings_.empty()) {
+        // Сбрасываем накопленную погрешность вычитаний
+        sum_ = 0.0;
+        sumSq_ = 0.0;
+    }
+    return true;
 }
 
 /**
@@ -50,10 +77,5 @@ const std::unordered_map<int, Rating>& User::getRatings() const {
  */
 double User::getAverageRating() const {
     if (ratings_.empty()) return 0.0;
-
-    double sum = 0.0;
-    for (const auto& [itemId, r] : ratings_) {
-        sum += r.score;
-    }
-    return sum / ratings_.size();
+    return sum_ / ratings_.size();
 }
@@ -38,9 +38,23 @@ public:
     /**
      * @brief Вычисляет среднюю оценку пользователя.
      * @return Среднее значение всех оценок. Если нет оценок, вернёт 0.0.
+     * @note Сумма оценок поддерживается инкрементально, поэтому вызов O(1).
      */
     double getAverageRating() const;
 
+    /**
+     * @brief Удаляет оценку пользователя для товара.
+     * @param itemId ID товара.
+     * @return true, если оценка была и удалена.
+     */
+    bool removeRating(int itemId);
+
+    /**
+     * @brief Сумма квадратов всех оценок (квадрат нормы вектора оценок).
+     * @return Поддерживается инкрементально, O(1).
+     */
+    double getSquaredNorm() const { return sumSq_; }
+
     /**
      * @brief Получает ID пользователя.
      * @return Целочисленный ID.
@@ -50,4 +64,6 @@ public:
 private:
     int id_;  ///< Уникальный ID пользователя
     std::unordered_map<int, Rating> ratings_; ///< Оценки: itemId → Rating
+    double sum_ = 0.0;    ///< Сумма оценок
+    double sumSq_ = 0.0;  ///< Сумма квадратов оценок
 };
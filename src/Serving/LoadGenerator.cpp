@@ -0,0 +1,178 @@
+#include "LoadGenerator.h"
+#include "TcpServer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace recsys {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Источник запросов одного клиента (свой генератор, копии распределений).
+         */
+        class RequestSampler {
+        public:
+            RequestSampler(const std::vector<int>& userIds, std::discrete_distribution<std::size_t> userDist,
+                           const std::vector<int>& itemIds, std::discrete_distribution<std::size_t> itemDist,
+                           std::discrete_distribution<int> typeDist, int n, std::uint64_t seed)
+                : userIds_(userIds), itemIds_(itemIds), userDist_(std::move(userDist)),
+                  itemDist_(std::move(itemDist)), typeDist_(std::move(typeDist)), n_(n), rng_(seed) {}
+
+            LoadGenerator::Request next() {
+                LoadGenerator::Request request;
+                request.type = static_cast<LoadGenerator::RequestType>(typeDist_(rng_));
+                request.n = n_;
+                if (request.type != LoadGenerator::RequestType::Popular) request.userId = userIds_[userDist_(rng_)];
+                if (request.type == LoadGenerator::RequestType::Predict) request.itemId = itemIds_[itemDist_(rng_)];
+                return request;
+            }
+
+        private:
+            const std::vector<int>& userIds_;
+            const std::vector<int>& itemIds_;
+            std::discrete_distribution<std::size_t> userDist_;
+            std::discrete_distribution<std::size_t> itemDist_;
+            std::discrete_distribution<int> typeDist_;
+            int n_;
+            std::mt19937_64 rng_;
+        };
+
+    } // namespace
+
+    LoadGenerator::Report LoadGenerator::run(const std::vector<User>& users,
+                                             const std::vector<Item>& items,
+                                             const Config& config,
+                                             const ClientFactory& factory) {
+        if (config.clients == 0) throw std::invalid_argument("Number of clients must be positive");
+        if (!(config.durationSeconds > 0.0) && config.maxRequests == 0) {
+            throw std::invalid_argument("Duration or request limit must be set");
+        }
+        if (config.mode == Mode::Open && !(config.targetQps > 0.0)) throw std::invalid_argument("Target QPS must be positive");
+        if (users.empty() || items.empty()) throw std::invalid_argument("Users and items must not be empty");
+        const Mix& mix = config.mix;
+        if (mix.predict < 0 || mix.topN < 0 || mix.hybrid < 0 || mix.popular < 0 ||
+            !(mix.predict + mix.topN + mix.hybrid + mix.popular > 0.0)) {
+            throw std::invalid_argument("Request mix must have a positive share");
+        }
+
+        // Пользователи по убыванию активности; вес ранга r — 1 / (r + 1)^skew
+        std::vector<std::size_t> byActivity(users.size());
+        std::iota(byActivity.begin(), byActivity.end(), 0);
+        std::stable_sort(byActivity.begin(), byActivity.end(), [&](std::size_t a, std::size_t b) {
+            return users[a].getRatings().size() > users[b].getRatings().size();
+        });
+        std::vector<int> userIds;
+        std::vector<double> userWeights;
+        for (std::size_t r = 0; r < byActivity.size(); ++r) {
+            userIds.push_back(users[byActivity[r]].getId());
+            userWeights.push_back(std::pow(static_cast<double>(r + 1), -config.userSkew));
+        }
+        std::vector<int> itemIds;
+        std::vector<double> itemWeights;
+        for (const auto& item : items) {
+            itemIds.push_back(item.getId());
+            itemWeights.push_back(static_cast<double>(std::max(item.getRatingCount(), 1)));
+        }
+        std::discrete_distribution<std::size_t> userDist(userWeights.begin(), userWeights.end());
+        std::discrete_distribution<std::size_t> itemDist(itemWeights.begin(), itemWeights.end());
+        std::discrete_distribution<int> typeDist({mix.predict, mix.topN, mix.hybrid, mix.popular});
+
+        std::vector<Client> clients;
+        for (std::size_t c = 0; c < config.clients; ++c) clients.push_back(factory(c));
+
+        std::vector<Report> partial(config.clients);
+        std::atomic<std::uint64_t> issued{0};
+        const auto start = Clock::now();
+        const auto deadline = config.durationSeconds > 0.0
+            ? start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.durationSeconds))
+            : Clock::time_point::max();
+        // В открытом режиме каждый клиент ведёт своё расписание с частотой targetQps / clients
+        const auto interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.mode == Mode::Open ? config.clients / config.targetQps : 0.0));
+
+        auto clientLoop = [&](std::size_t c) {
+            RequestSampler sampler(userIds, userDist, itemIds, itemDist, typeDist, config.n,
+                                   config.seed * 0x9E3779B97F4A7C15ull + c);
+            Report& report = partial[c];
+            // Клиенты открытого режима сдвинуты на долю интервала, чтобы не стрелять одновременно
+            auto scheduled = start + interval * c / config.clients;
+
+            while (true) {
+                if (config.maxRequests > 0 && issued.fetch_add(1) >= config.maxRequests) break;
+                Request request = sampler.next();
+
+                Clock::time_point begin;
+                if (config.mode == Mode::Open) {
+                    // Запросы, не отправленные к концу теста, отбрасываются, а не досылаются
+                    if (scheduled >= deadline || Clock::now() >= deadline) break;
+                    std::this_thread::sleep_until(scheduled);
+                    begin = scheduled;
+                    scheduled += interval;
+                } else {
+                    begin = Clock::now();
+                    if (begin >= deadline) break;
+                }
+
+                bool ok = false;
+                try {
+                    ok = clients[c](request);
+                } catch (const std::exception&) {
+                    ok = false;
+                }
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+
+                Stats& byType = report.byType[static_cast<std::size_t>(request.type)];
+                for (Stats* stats : {&report.total, &byType}) {
+                    ++stats->requests;
+                    if (!ok) ++stats->errors;
+                    stats->latency.record(static_cast<std::uint64_t>(std::max<long long>(ns, 0)));
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t c = 0; c < config.clients; ++c) threads.emplace_back(clientLoop, c);
+        for (auto& t : threads) t.join();
+
+        Report report;
+        report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (const auto& part : partial) {
+            auto merge = [](Stats& into, const Stats& from) {
+                into.requests += from.requests;
+                into.errors += from.errors;
+                into.latency.merge(from.latency);
+            };
+            merge(report.total, part.total);
+            for (std::size_t t = 0; t < report.byType.size(); ++t) merge(report.byType[t], part.byType[t]);
+        }
+        return report;
+    }
+
+    LoadGenerator::ClientFactory LoadGenerator::inProcess(const RecommendationService& service) {
+        return [&service](std::size_t) -> Client {
+            return [&service](const Request& request) {
+                service.handle(request);
+                return true;
+            };
+        };
+    }
+
+    LoadGenerator::ClientFactory LoadGenerator::remote(const std::string& host, std::uint16_t port) {
+        return [host, port](std::size_t) -> Client {
+            auto connection = std::make_shared<TcpClient>(host, port);
+            return [connection](const Request& request) {
+                return connection->request(RecommendationService::format(request)).rfind("OK", 0) == 0;
+            };
+        };
+    }
+
+} // namespace recsys
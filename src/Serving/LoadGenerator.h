@@ -0,0 +1,118 @@
+/**
+ * @file LoadGenerator.h
+ * @brief Нагрузочный тест API рекомендаций: пропускная способность и хвосты задержек.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "RecommendationService.h"
+#include "../Utils/LatencyHistogram.h"
+
+namespace recsys {
+
+    /**
+     * @class LoadGenerator
+     * @brief Подаёт смесь запросов из нескольких клиентских потоков и собирает гистограммы задержек.
+     *
+     * Пользователи запросов выбираются по Ципфу по рангу активности
+     * (самые активные пользователи запрашивают чаще всего), товары для
+     * Predict — пропорционально их популярности.
+     *
+     * Режимы:
+     * - Closed: каждый клиент отправляет следующий запрос сразу после ответа;
+     * - Open: запросы отправляются по расписанию с суммарной частотой targetQps,
+     *   задержка отсчитывается от запланированного момента, поэтому очередь
+     *   перед перегруженной системой попадает в хвосты (без «coordinated omission»).
+     */
+    class LoadGenerator {
+    public:
+        using Request = RecommendationService::Request;
+        using RequestType = RecommendationService::RequestType;
+
+        /// Режим подачи нагрузки
+        enum class Mode { Closed, Open };
+
+        /**
+         * @struct Mix
+         * @brief Доли типов запросов (нормируются)
+         */
+        struct Mix {
+            double predict = 0.6;
+            double topN = 0.2;
+            double hybrid = 0.1;
+            double popular = 0.1;
+        };
+
+        /**
+         * @struct Config
+         * @brief Параметры теста
+         */
+        struct Config {
+            Mode mode = Mode::Closed;
+            std::size_t clients = 4;            ///< Клиентских потоков
+            double durationSeconds = 10.0;      ///< Длительность теста
+            std::uint64_t maxRequests = 0;      ///< Предел запросов; 0 — только по времени
+            double targetQps = 100.0;           ///< Суммарная частота в режиме Open
+            Mix mix;
+            double userSkew = 1.0;              ///< Показатель Ципфа выбора пользователя
+            int n = 10;                         ///< Длина списков top-N
+            std::uint64_t seed = 42;
+        };
+
+        /**
+         * @struct Stats
+         * @brief Счётчики и задержки (нс) одного типа запросов или всех вместе
+         */
+        struct Stats {
+            std::uint64_t requests = 0;
+            std::uint64_t errors = 0;
+            LatencyHistogram latency;
+        };
+
+        /**
+         * @struct Report
+         * @brief Итог теста
+         */
+        struct Report {
+            double seconds = 0.0;                 ///< Фактическая длительность
+            Stats total;
+            std::array<Stats, 4> byType;          ///< В порядке RequestType
+
+            /// Запросов в секунду.
+            double qps() const { return seconds > 0.0 ? static_cast<double>(total.requests) / seconds : 0.0; }
+        };
+
+        /// Исполнитель запросов одного клиента; false — ошибка запроса.
+        using Client = std::function<bool(const Request&)>;
+
+        /// Создаёт исполнителя для клиента с данным номером (например, со своим TCP-соединением).
+        using ClientFactory = std::function<Client(std::size_t client)>;
+
+        /**
+         * @brief Проводит тест.
+         *
+         * @param users Пользователи, из которых выбираются запросы
+         * @param items Товары, из которых выбираются запросы Predict
+         * @param config Параметры
+         * @param factory Исполнители запросов
+         * @throws std::invalid_argument При некорректных параметрах
+         */
+        static Report run(const std::vector<User>& users,
+                          const std::vector<Item>& items,
+                          const Config& config,
+                          const ClientFactory& factory);
+
+        /// Исполнитель, вызывающий service.handle() в том же процессе.
+        static ClientFactory inProcess(const RecommendationService& service);
+
+        /// Исполнитель, отправляющий запросы на TcpServer (соединение на клиента).
+        static ClientFactory remote(const std::string& host, std::uint16_t port);
+    };
+
+} // namespace recsys
@@ -0,0 +1,120 @@
+#include "ModelStore.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace recsys {
+
+    ModelStore::ModelStore(Model initial) {
+        initial.version = nextVersion_++;
+        current_.store(new Node{std::make_shared<const Model>(std::move(initial))});
+    }
+
+    ModelStore::~ModelStore() {
+        delete current_.load();
+        for (Node* node : retired_) delete node;
+        for (Slot* slot = slots_.load(); slot;) {
+            Slot* next = slot->next;
+            delete slot;
+            slot = next;
+        }
+    }
+
+    ModelStore::Slot* ModelStore::acquireSlot() const {
+        for (Slot* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+            bool expected = false;
+            if (!slot->used.load(std::memory_order_relaxed) &&
+                slot->used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return slot;
+            }
+        }
+        // Все слоты заняты: их не больше, чем одновременно читающих потоков
+        Slot* slot = new Slot;
+        slot->used.store(true, std::memory_order_relaxed);
+        Slot* head = slots_.load(std::memory_order_relaxed);
+        do {
+            slot->next = head;
+        } while (!slots_.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
+        return slot;
+    }
+
+    ModelStore::Snapshot ModelStore::snapshot() const {
+        Slot* slot = acquireSlot();
+        Node* node = current_.load();
+        while (true) {
+            slot->hazard.store(node);
+            // Повторная проверка: если узел уже заменён, писатель мог не увидеть объявление
+            Node* again = current_.load();
+            if (again == node) break;
+            node = again;
+        }
+        Snapshot result = node->model;
+        slot->hazard.store(nullptr, std::memory_order_release);
+        slot->used.store(false, std::memory_order_release);
+        return result;
+    }
+
+    std::uint64_t ModelStore::publish(Model model) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        model.version = nextVersion_++;
+        const std::uint64_t version = model.version;
+        Node* fresh = new Node{std::make_shared<const Model>(std::move(model))};
+        Node* old = current_.exchange(fresh);
+        draining_.push_back(old->model);
+        retired_.push_back(old);
+        reclaim();
+        pruneDraining();
+        return version;
+    }
+
+    void ModelStore::reclaim() {
+        std::vector<Node*> hazards;
+        for (Slot* slot = slots_.load(std::memory_order_acquire); slot; slot = slot->next) {
+            if (Node* node = slot->hazard.load()) hazards.push_back(node);
+        }
+        auto pinned = [&](Node* node) {
+            return std::find(hazards.begin(), hazards.end(), node) != hazards.end();
+        };
+        std::vector<Node*> kept;
+        for (Node* node : retired_) {
+            if (pinned(node)) kept.push_back(node);
+            else delete node;
+        }
+        retired_ = std::move(kept);
+    }
+
+    void ModelStore::synchronize() {
+        std::vector<std::weak_ptr<const Model>> draining;
+        {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            // Объявление в слоте держится несколько инструкций — до копирования shared_ptr
+            while (!retired_.empty()) {
+                reclaim();
+                if (!retired_.empty()) std::this_thread::yield();
+            }
+            draining = draining_;
+        }
+        for (const auto& model : draining) {
+            while (!model.expired()) std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        pruneDraining();
+    }
+
+    void ModelStore::pruneDraining() {
+        draining_.erase(std::remove_if(draining_.begin(), draining_.end(),
+                                       [](const std::weak_ptr<const Model>& m) { return m.expired(); }),
+                        draining_.end());
+    }
+
+    std::uint64_t ModelStore::version() const {
+        return snapshot()->version;
+    }
+
+    std::size_t ModelStore::drainingCount() const {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        return static_cast<std::size_t>(std::count_if(draining_.begin(), draining_.end(),
+                                                      [](const std::weak_ptr<const Model>& m) { return !m.expired(); }));
+    }
+
+} // namespace recsys
@@ -0,0 +1,125 @@
+/**
+ * @file ModelStore.h
+ * @brief Неизменяемые снимки модели: чтение без блокировок и атомарная замена.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../Models/User.h"
+#include "../Models/Item.h"
+
+namespace recsys {
+
+    /**
+     * @struct Model
+     * @brief Данные, по которым отвечает сервис; после публикации не меняются
+     */
+    struct Model {
+        std::vector<User> users;
+        std::vector<Item> items;
+        std::uint64_t version = 0;   ///< Номер публикации (присваивает ModelStore)
+    };
+
+    /**
+     * @class ModelStore
+     * @brief Текущая модель в стиле RCU: читатели берут снимок, писатель публикует новый.
+     *
+     * Снимок — std::shared_ptr<const Model>: пока читатель его держит, модель
+     * жива, даже если уже опубликована следующая. Текущий снимок лежит в узле,
+     * указатель на который меняется атомарно. Чтобы скопировать shared_ptr из
+     * узла, который писатель мог только что заменить, читатель объявляет узел
+     * в своём слоте (hazard pointer): писатель не удаляет узлы, объявленные
+     * в слотах. Слоты — односвязный список, который только растёт и занимается
+     * по CAS, поэтому snapshot() не берёт мьютексов и не ждёт писателя.
+     *
+     * Писатели сериализуются между собой мьютексом; на чтение он не влияет.
+     */
+    class ModelStore {
+    public:
+        using Snapshot = std::shared_ptr<const Model>;
+
+        /// Публикует начальную модель (версия 1).
+        explicit ModelStore(Model initial);
+
+        ~ModelStore();
+
+        ModelStore(const ModelStore&) = delete;
+        ModelStore& operator=(const ModelStore&) = delete;
+
+        /**
+         * @brief Текущий снимок; без блокировок.
+         *
+         * Снимок не меняется, сколько бы публикаций ни прошло, пока его держат.
+         */
+        Snapshot snapshot() const;
+
+        /**
+         * @brief Атомарно заменяет текущую модель.
+         *
+         * Запросы, начавшиеся раньше, дочитывают старый снимок; новые видят
+         * новый. Не ждёт читателей: освобождение старой модели — на последнем
+         * владельце снимка, узлы подбираются при следующих публикациях.
+         *
+         * @return Версия опубликованной модели
+         */
+        std::uint64_t publish(Model model);
+
+        /**
+         * @brief Ждёт, пока читатели отпустят все заменённые модели.
+         *
+         * Аналог synchronize_rcu: после возврата ни один читатель не работает
+         * со старыми моделями (например, можно сбросить кэши, посчитанные по ним).
+         * Нельзя вызывать, держа снимок в том же потоке.
+         */
+        void synchronize();
+
+        /// Версия текущей модели.
+        std::uint64_t version() const;
+
+        /// Заменённые модели, которые ещё держат читатели.
+        std::size_t drainingCount() const;
+
+    private:
+        /**
+         * @struct Node
+         * @brief Владение опубликованной моделью
+         */
+        struct Node {
+            Snapshot model;
+        };
+
+        /**
+         * @struct Slot
+         * @brief Узел, который читатель сейчас копирует
+         */
+        struct Slot {
+            std::atomic<bool> used{false};
+            std::atomic<Node*> hazard{nullptr};
+            Slot* next = nullptr;
+        };
+
+        /// Занимает свободный слот или добавляет новый в голову списка.
+        Slot* acquireSlot() const;
+
+        /// Удаляет заменённые узлы, не объявленные ни в одном слоте (под writerMutex_).
+        void reclaim();
+
+        /// Забывает заменённые модели, которые уже освобождены (под writerMutex_).
+        void pruneDraining();
+
+        std::atomic<Node*> current_;
+        mutable std::atomic<Slot*> slots_{nullptr};
+
+        mutable std::mutex writerMutex_;   ///< Сериализует publish, synchronize и reclaim
+        std::vector<Node*> retired_;                         ///< Заменённые узлы
+        std::vector<std::weak_ptr<const Model>> draining_;   ///< Заменённые модели
+        std::uint64_t nextVersion_ = 1;
+    };
+
+} // namespace recsys
@@ -0,0 +1,181 @@
+#include "RecommendationService.h"
+#include "../Algorithms/Recommender.h"
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace recsys {
+
+    namespace {
+
+        /// Целое, занимающее весь токен: std::stol сам останавливается на "1.5" и "5abc".
+        bool parseWhole(const std::string& token, long& value) {
+            std::size_t used = 0;
+            try {
+                value = std::stol(token, &used);
+            } catch (const std::exception&) {
+                return false;
+            }
+            return used == token.size();
+        }
+
+        /// То же для полей типа int.
+        bool parseWhole(const std::string& token, int& value) {
+            long wide = 0;
+            if (!parseWhole(token, wide) || wide < std::numeric_limits<int>::min() ||
+                wide > std::numeric_limits<int>::max()) {
+                return false;
+            }
+            value = static_cast<int>(wide);
+            return true;
+        }
+
+        /// Список "i,j,..." без пустых и нечисловых элементов.
+        bool parseIdList(const std::string& token, std::vector<int>& ids) {
+            std::istringstream list(token);
+            for (std::string id; std::getline(list, id, ',');) {
+                int value = 0;
+                if (!parseWhole(id, value)) return false;
+                ids.push_back(value);
+            }
+            return !ids.empty() && token.back() != ',';
+        }
+
+        /// Пользователь снимка по ID.
+        const User& findUser(const std::vector<User>& users, int userId) {
+            for (const auto& u : users) {
+                if (u.getId() == userId) return u;
+            }
+            throw std::runtime_error("User not found");
+        }
+
+    } // namespace
+
+    RecommendationService::RecommendationService(std::vector<User> users, std::vector<Item> items, Config config)
+        : store_(Model{std::move(users), std::move(items)}), config_(config) {}
+
+    std::uint64_t RecommendationService::update(std::vector<User> users, std::vector<Item> items) {
+        return store_.publish(Model{std::move(users), std::move(items)});
+    }
+
+    RecommendationService::Response RecommendationService::handle(const Request& request) const {
+        const ModelStore::Snapshot model = store_.snapshot();
+        const auto& users = model->users;
+        const auto& items = model->items;
+        // Глобальные кэши Predictor не привязаны к снимку и защищены мьютексами:
+        // запросы считают по своему снимку и в них не заглядывают
+        Predictor::Options options;
+        options.useCache = false;
+        Response response;
+        const long budget = request.budgetMicros > 0 ? request.budgetMicros : config_.budgetMicros;
+        if (budget > 0 && (request.type == RequestType::TopN || request.type == RequestType::Hybrid)) {
+            const double alpha = request.type == RequestType::TopN ? 1.0 : config_.alpha;
+            auto budgeted = Recommender::recommendWithDeadline(
+                request.userId, users, items, request.n, config_.k, config_.metric, alpha,
+                Recommender::Deadline::after(std::chrono::microseconds(budget)), request.exclude);
+            response.items = std::move(budgeted.items);
+            response.degraded = budgeted.degraded();
+            return response;
+        }
+        switch (request.type) {
+            case RequestType::Predict:
+                response.value = Predictor::predict(request.userId, request.itemId, users, config_.k,
+                                                    config_.metric, options);
+                break;
+            case RequestType::TopN: {
+                const User& user = findUser(users, request.userId);
+                response.items = Recommender::recommendFromNeighbors(
+                    user, Predictor::neighbors(user, users, config_.metric), items, request.n, config_.k,
+                    options, request.exclude);
+                break;
+            }
+            case RequestType::Hybrid:
+                response.items = Recommender::recommendHybrid(request.userId, users, items, request.n,
+                                                              config_.k, config_.metric, config_.alpha,
+                                                              options, request.exclude);
+                break;
+            case RequestType::Popular:
+                for (const auto& [itemId, count] : Recommender::topPopularItems(items, request.n)) {
+                    response.items.emplace_back(itemId, static_cast<double>(count));
+                }
+                break;
+        }
+        return response;
+    }
+
+    std::optional<RecommendationService::Request> RecommendationService::parse(const std::string& line) {
+        std::istringstream in(line);
+        std::string command;
+        Request request;
+        if (!(in >> command)) return std::nullopt;
+        // Каждое поле — целый токен, лишние токены — ошибка, а не молчаливый пропуск
+        std::vector<std::string> args;
+        for (std::string token; in >> token;) args.push_back(token);
+
+        bool ok = false;
+        if (command == "PREDICT") {
+            request.type = RequestType::Predict;
+            ok = args.size() == 2 && parseWhole(args[0], request.userId) && parseWhole(args[1], request.itemId);
+        } else if (command == "TOPN" || command == "HYBRID") {
+            request.type = command == "TOPN" ? RequestType::TopN : RequestType::Hybrid;
+            ok = args.size() >= 2 && parseWhole(args[0], request.userId) && parseWhole(args[1], request.n);
+            // Хвост строго "[бюджет] [EXCLUDE i,j,...]"
+            std::size_t pos = 2;
+            if (ok && pos < args.size() && args[pos] != "EXCLUDE") {
+                ok = parseWhole(args[pos++], request.budgetMicros) && request.budgetMicros >= 0;
+            }
+            if (ok && pos < args.size()) {
+                ok = args[pos] == "EXCLUDE" && pos + 2 == args.size() && parseIdList(args[pos + 1], request.exclude);
+            }
+        } else if (command == "POPULAR") {
+            request.type = RequestType::Popular;
+            ok = args.size() == 1 && parseWhole(args[0], request.n);
+        }
+        if (!ok || request.n < 0) return std::nullopt;
+        return request;
+    }
+
+    std::string RecommendationService::format(const Request& request) {
+        switch (request.type) {
+            case RequestType::Predict:
+                return "PREDICT " + std::to_string(request.userId) + " " + std::to_string(request.itemId);
+            case RequestType::TopN:
+            case RequestType::Hybrid: {
+                std::string line = (request.type == RequestType::TopN ? "TOPN " : "HYBRID ") +
+                                   std::to_string(request.userId) + " " + std::to_string(request.n);
+                if (request.budgetMicros > 0) line += " " + std::to_string(request.budgetMicros);
+                for (std::size_t i = 0; i < request.exclude.size(); ++i) {
+                    line += (i == 0 ? " EXCLUDE " : ",") + std::to_string(request.exclude[i]);
+                }
+                return line;
+            }
+            case RequestType::Popular:
+                break;
+        }
+        return "POPULAR " + std::to_string(request.n);
+    }
+
+    std::string RecommendationService::format(const Request& request, const Response& response) {
+        std::ostringstream out;
+        out << "OK";
+        if (response.degraded) out << " DEGRADED";
+        if (request.type == RequestType::Predict) {
+            out << ' ' << response.value;
+        } else {
+            for (const auto& [itemId, value] : response.items) out << ' ' << itemId << ':' << value;
+        }
+        return out.str();
+    }
+
+    std::string RecommendationService::handleLine(const std::string& line) const {
+        auto request = parse(line);
+        if (!request) return "ERR bad request";
+        try {
+            return format(*request, handle(*request));
+        } catch (const std::exception& e) {
+            return std::string("ERR ") + e.what();
+        }
+    }
+
+} // namespace recsys
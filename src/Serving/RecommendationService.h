@@ -0,0 +1,130 @@
+/**
+ * @file RecommendationService.h
+ * @brief Обработка запросов рекомендаций и текстовый протокол для сетевого режима.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../Algorithms/Predictor.h"
+#include "../Models/User.h"
+#include "../Models/Item.h"
+#include "ModelStore.h"
+
+namespace recsys {
+
+    /**
+     * @class RecommendationService
+     * @brief Владеет данными и отвечает на запросы predict, top-N, hybrid и popular.
+     *
+     * Один и тот же объект обслуживает запросы в процессе (нагрузочный тест,
+     * встраивание) и через TcpServer. handle() можно вызывать из нескольких
+     * потоков одновременно: каждый запрос берёт неизменяемый снимок модели
+     * из ModelStore без блокировок и считает только по нему: глобальные кэши
+     * Predictor (с мьютексами по шардам и без версии модели) не используются,
+     * соседи ищутся один раз на запрос. update() подменяет модель на лету,
+     * не останавливая обработку запросов.
+     *
+     * Протокол — по строке на запрос и ответ:
+     * ```
+     * PREDICT <userId> <itemId>   →  OK <оценка>
+     * TOPN <userId> <N> [бюджет] [EXCLUDE i,j,...]    →  OK <itemId>:<оценка> ...
+     * HYBRID <userId> <N> [бюджет] [EXCLUDE i,j,...]  →  OK <itemId>:<оценка> ...
+     * POPULAR <N>                                     →  OK <itemId>:<число оценок> ...
+     * ```
+     * Бюджет — микросекунды на запрос (по умолчанию Config::budgetMicros),
+     * EXCLUDE — товары, которые нельзя рекомендовать (например, уже показанные).
+     * Если ради него расчёт урезан (Recommender::recommendWithDeadline),
+     * ответ начинается с `OK DEGRADED`. При ошибке ответ — `ERR <сообщение>`.
+     */
+    class RecommendationService {
+    public:
+        /// Тип запроса
+        enum class RequestType {
+            Predict,   ///< Predictor::predict
+            TopN,      ///< Recommender::recommendTopN
+            Hybrid,    ///< Recommender::recommendHybrid
+            Popular    ///< Recommender::topPopularItems
+        };
+
+        /**
+         * @struct Request
+         * @brief Один запрос
+         */
+        struct Request {
+            RequestType type = RequestType::Predict;
+            int userId = 0;
+            int itemId = 0;   ///< Только для Predict
+            int n = 10;       ///< Длина списка для TopN, Hybrid и Popular
+            long budgetMicros = 0;   ///< Бюджет TopN и Hybrid, мкс; 0 — Config::budgetMicros
+            std::vector<int> exclude;   ///< Дополнительные исключения TopN и Hybrid
+        };
+
+        /**
+         * @struct Response
+         * @brief Ответ: оценка (Predict) или список (itemId, значение)
+         */
+        struct Response {
+            double value = 0.0;
+            std::vector<std::pair<int, double>> items;
+            bool degraded = false;   ///< Расчёт урезан, чтобы уложиться в бюджет
+        };
+
+        /**
+         * @struct Config
+         * @brief Параметры алгоритмов
+         */
+        struct Config {
+            int k = 5;                                            ///< Число соседей
+            Predictor::Metric metric = Predictor::Metric::Cosine;
+            double alpha = 0.5;                                   ///< Вес user-based части гибрида
+            long budgetMicros = 0;                                ///< Бюджет TopN и Hybrid, мкс; 0 — без срока
+        };
+
+        RecommendationService(std::vector<User> users, std::vector<Item> items, Config config);
+
+        /// Создаёт сервис с параметрами по умолчанию.
+        RecommendationService(std::vector<User> users, std::vector<Item> items)
+            : RecommendationService(std::move(users), std::move(items), Config{}) {}
+
+        /**
+         * @brief Выполняет запрос.
+         * @throws std::runtime_error Если пользователь не найден
+         */
+        Response handle(const Request& request) const;
+
+        /// Разбирает строку протокола; std::nullopt — строка некорректна.
+        static std::optional<Request> parse(const std::string& line);
+
+        /// Строка протокола для запроса (без перевода строки).
+        static std::string format(const Request& request);
+
+        /// Строка ответа (без перевода строки).
+        static std::string format(const Request& request, const Response& response);
+
+        /// Разбирает строку протокола, выполняет и форматирует ответ (в том числе ERR).
+        std::string handleLine(const std::string& line) const;
+
+        /**
+         * @brief Публикует перестроенную модель.
+         *
+         * Запросы, уже начатые по старой модели, дорабатывают по ней; каждый
+         * следующий сразу отвечает по новой. Читателей не ждёт: старая модель
+         * освобождается вместе с последним снимком.
+         *
+         * @return Версия новой модели
+         */
+        std::uint64_t update(std::vector<User> users, std::vector<Item> items);
+
+        /// Текущая модель; держите снимок, пока пользуетесь её данными.
+        ModelStore::Snapshot snapshot() const { return store_.snapshot(); }
+
+    private:
+        ModelStore store_;
+        Config config_;
+    };
+
+} // namespace recsys
@@ -0,0 +1,204 @@
+#include "TcpServer.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace recsys {
+
+#ifdef _WIN32
+
+    TcpServer::TcpServer(const RecommendationService& service, std::uint16_t, const std::string&)
+        : service_(service) {
+        throw std::runtime_error("TCP serving is not supported on this platform");
+    }
+    TcpServer::~TcpServer() = default;
+    void TcpServer::start() {}
+    void TcpServer::stop() {}
+    void TcpServer::acceptLoop() {}
+    void TcpServer::serveConnection(int) {}
+    std::size_t TcpServer::connectionThreads() { return 0; }
+    void TcpServer::reapFinished() {}
+
+    TcpClient::TcpClient(const std::string&, std::uint16_t) {
+        throw std::runtime_error("TCP serving is not supported on this platform");
+    }
+    TcpClient::~TcpClient() = default;
+    std::string TcpClient::request(const std::string&) { return {}; }
+
+#else
+
+    namespace {
+
+        sockaddr_in makeAddress(const std::string& host, std::uint16_t port) {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+                throw std::runtime_error("Invalid address: " + host);
+            }
+            return addr;
+        }
+
+        bool sendAll(int fd, const std::string& data) {
+            std::size_t sent = 0;
+            while (sent < data.size()) {
+                ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) return false;
+                sent += static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+        /// Читает строку (без '\n'); false — соединение закрыто или строка длиннее kMaxLineBytes.
+        bool readLine(int fd, std::string& buffer, std::string& line) {
+            std::size_t scanned = 0;
+            while (true) {
+                auto pos = buffer.find('\n', scanned);
+                if (pos != std::string::npos && pos > TcpServer::kMaxLineBytes) return false;
+                if (pos != std::string::npos) {
+                    line.assign(buffer, 0, pos);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    buffer.erase(0, pos + 1);
+                    return true;
+                }
+                if (buffer.size() > TcpServer::kMaxLineBytes) return false;
+                scanned = buffer.size();
+                char chunk[4096];
+                ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) return false;
+                buffer.append(chunk, static_cast<std::size_t>(n));
+            }
+        }
+
+        void setNoDelay(int fd) {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+    } // namespace
+
+    TcpServer::TcpServer(const RecommendationService& service, std::uint16_t port, const std::string& host)
+        : service_(service) {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd_ < 0) throw std::runtime_error("Cannot create socket");
+        int one = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr = makeAddress(host, port);
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listenFd_, 128) != 0) {
+            ::close(listenFd_);
+            throw std::runtime_error("Cannot listen on " + host + ":" + std::to_string(port));
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+    }
+
+    TcpServer::~TcpServer() {
+        stop();
+        if (listenFd_ >= 0) ::close(listenFd_);
+    }
+
+    void TcpServer::start() {
+        if (running_.exchange(true)) return;
+        acceptThread_ = std::thread([this] { acceptLoop(); });
+    }
+
+    void TcpServer::stop() {
+        if (!running_.exchange(false)) return;
+        // shutdown() будит accept() и recv() в рабочих потоках
+        ::shutdown(listenFd_, SHUT_RDWR);
+        if (acceptThread_.joinable()) acceptThread_.join();
+
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int fd : connections_) ::shutdown(fd, SHUT_RDWR);
+            workers.swap(workers_);
+            finished_.clear();
+        }
+        for (auto& t : workers) t.join();
+    }
+
+    std::size_t TcpServer::connectionThreads() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reapFinished();
+        return workers_.size();
+    }
+
+    void TcpServer::reapFinished() {
+        // Поток попадает в finished_ последним действием под mutex_: join ждёт лишь его выхода
+        for (std::thread::id id : finished_) {
+            auto it = std::find_if(workers_.begin(), workers_.end(),
+                                   [id](const std::thread& t) { return t.get_id() == id; });
+            if (it == workers_.end()) continue;
+            it->join();
+            workers_.erase(it);
+        }
+        finished_.clear();
+    }
+
+    void TcpServer::acceptLoop() {
+        while (running_) {
+            int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) {
+                if (!running_) break;
+                continue;
+            }
+            setNoDelay(fd);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                ::close(fd);
+                break;
+            }
+            reapFinished();
+            connections_.push_back(fd);
+            workers_.emplace_back([this, fd] { serveConnection(fd); });
+        }
+    }
+
+    void TcpServer::serveConnection(int fd) {
+        std::string buffer, line;
+        while (readLine(fd, buffer, line)) {
+            if (!sendAll(fd, service_.handleLine(line) + "\n")) break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.erase(std::remove(connections_.begin(), connections_.end(), fd), connections_.end());
+        ::close(fd);
+        finished_.push_back(std::this_thread::get_id());
+    }
+
+    TcpClient::TcpClient(const std::string& host, std::uint16_t port) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) throw std::runtime_error("Cannot create socket");
+        sockaddr_in addr = makeAddress(host, port);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("Cannot connect to " + host + ":" + std::to_string(port));
+        }
+        setNoDelay(fd_);
+    }
+
+    TcpClient::~TcpClient() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    std::string TcpClient::request(const std::string& line) {
+        std::string response;
+        if (!sendAll(fd_, line + "\n") || !readLine(fd_, buffer_, response)) {
+            throw std::runtime_error("Connection closed by server");
+        }
+        return response;
+    }
+
+#endif
+
+} // namespace recsys
@@ -0,0 +1,106 @@
+/**
+ * @file TcpServer.h
+ * @brief Локальный сетевой режим: строковый протокол RecommendationService поверх TCP.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RecommendationService.h"
+
+namespace recsys {
+
+    /**
+     * @class TcpServer
+     * @brief Принимает соединения и отвечает на строки протокола; поток на соединение.
+     *
+     * Предназначен для локальных нагрузочных тестов и отладки, а не для
+     * публичной сети: нет аутентификации, по умолчанию слушается только 127.0.0.1.
+     * Поддерживается на POSIX-системах.
+     *
+     * Потоки закрытых соединений присоединяются при следующем accept(), поэтому
+     * долгоживущий сервер держит столько потоков, сколько открыто соединений.
+     * Соединение, приславшее строку длиннее kMaxLineBytes без '\n', закрывается.
+     */
+    class TcpServer {
+    public:
+        /// Наибольшая длина строки запроса (и ответа у TcpClient), байт.
+        static constexpr std::size_t kMaxLineBytes = 1 << 20;
+
+        /**
+         * @brief Открывает слушающий сокет.
+         *
+         * @param service Обработчик запросов (должен пережить сервер)
+         * @param port Порт; 0 — выбрать свободный (см. port())
+         * @param host Адрес, на котором слушать
+         * @throws std::runtime_error Если сокет не открывается
+         */
+        TcpServer(const RecommendationService& service, std::uint16_t port, const std::string& host = "127.0.0.1");
+
+        /// Останавливает сервер.
+        ~TcpServer();
+
+        TcpServer(const TcpServer&) = delete;
+        TcpServer& operator=(const TcpServer&) = delete;
+
+        /// Запускает поток приёма соединений.
+        void start();
+
+        /// Закрывает сокеты и дожидается всех потоков.
+        void stop();
+
+        /// Фактический порт.
+        std::uint16_t port() const { return port_; }
+
+        /// Присоединяет потоки закрытых соединений и возвращает число оставшихся.
+        std::size_t connectionThreads();
+
+    private:
+        void acceptLoop();
+        void serveConnection(int fd);
+
+        /// Присоединяет потоки из finished_ (под mutex_).
+        void reapFinished();
+
+        const RecommendationService& service_;
+        int listenFd_ = -1;
+        std::uint16_t port_ = 0;
+        std::atomic<bool> running_{false};
+        std::thread acceptThread_;
+        std::mutex mutex_;                   ///< Защищает connections_, workers_ и finished_
+        std::vector<int> connections_;
+        std::vector<std::thread> workers_;
+        std::vector<std::thread::id> finished_;   ///< Потоки, обслужившие соединение
+    };
+
+    /**
+     * @class TcpClient
+     * @brief Блокирующий клиент строкового протокола (одно соединение, запросы по очереди).
+     */
+    class TcpClient {
+    public:
+        /// @throws std::runtime_error Если не удалось подключиться
+        TcpClient(const std::string& host, std::uint16_t port);
+        ~TcpClient();
+
+        TcpClient(const TcpClient&) = delete;
+        TcpClient& operator=(const TcpClient&) = delete;
+
+        /**
+         * @brief Отправляет строку запроса и ждёт строку ответа.
+         * @throws std::runtime_error Если соединение разорвано
+         */
+        std::string request(const std::string& line);
+
+    private:
+        int fd_ = -1;
+        std::string buffer_;   ///< Принятые, но ещё не выданные байты
+    };
+
+} // namespace recsys
@@ -34,3 +34,33 @@ struct pair_hash {
         return h1 ^ (h2 << 1); ///< Комбинация хешей (XOR + сдвиг)
     }
 };
+
+/**
+ * @struct PredictionKey
+ * @brief Ключ кэша предсказаний: пользователь, товар и вариант алгоритма.
+ *
+ * Поле variant кодирует параметры, влияющие на результат (метрика, k, политики),
+ * чтобы предсказания с разными настройками не подменяли друг друга.
+ */
+struct PredictionKey {
+    int userId;   ///< ID пользователя
+    int itemId;   ///< ID товара
+    int variant;  ///< Закодированные параметры алгоритма
+
+    bool operator==(const PredictionKey& other) const {
+        return userId == other.userId && itemId == other.itemId && variant == other.variant;
+    }
+};
+
+/**
+ * @struct prediction_key_hash
+ * @brief Хеш-функция для PredictionKey.
+ */
+struct prediction_key_hash {
+    std::size_t operator()(const PredictionKey& k) const {
+        std::size_t h = std::hash<int>{}(k.userId);
+        h ^= std::hash<int>{}(k.itemId) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<int>{}(k.variant) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
@@ -0,0 +1,99 @@
+/**
+ * @file EpochSet.h
+ * @brief Множество целых ключей с очисткой за O(1) для многократного использования.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class EpochSet
+     * @brief Открытая адресация с метками эпох вместо стирания.
+     *
+     * Слот занят, если его метка равна текущей эпохе, поэтому clear() лишь
+     * увеличивает эпоху, а таблица и её память переиспользуются между
+     * запросами (держите экземпляр как рабочий буфер потока). Ёмкость —
+     * степень двойки, заполнение не выше половины; при переполнении счётчика
+     * эпох метки обнуляются один раз.
+     */
+    class EpochSet {
+    public:
+        /// Пустое множество; таблица выделяется при первой вставке.
+        EpochSet() = default;
+
+        /// Удаляет все ключи за O(1).
+        void clear() {
+            size_ = 0;
+            if (++epoch_ == 0) {
+                std::fill(stamps_.begin(), stamps_.end(), 0);
+                epoch_ = 1;
+            }
+        }
+
+        /**
+         * @brief Добавляет ключ.
+         * @return true, если ключа ещё не было
+         */
+        bool insert(int key) {
+            if (2 * (size_ + 1) > stamps_.size()) grow();
+            std::size_t slot = find(key);
+            if (stamps_[slot] == epoch_) return false;
+            stamps_[slot] = epoch_;
+            keys_[slot] = key;
+            ++size_;
+            return true;
+        }
+
+        /// Есть ли ключ.
+        bool contains(int key) const {
+            return !stamps_.empty() && stamps_[find(key)] == epoch_;
+        }
+
+        /// Число ключей.
+        std::size_t size() const { return size_; }
+
+        /// Ёмкость таблицы (слотов).
+        std::size_t capacity() const { return stamps_.size(); }
+
+    private:
+        /// Слот ключа или первый свободный слот его цепочки проб.
+        std::size_t find(int key) const {
+            const std::size_t mask = stamps_.size() - 1;
+            // Умножение Фибоначчи: соседние ID расходятся по таблице
+            std::size_t slot = static_cast<std::size_t>(
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key)) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+            while (stamps_[slot] == epoch_ && keys_[slot] != key) slot = (slot + 1) & mask;
+            return slot;
+        }
+
+        /// Удваивает таблицу и переносит ключи текущей эпохи.
+        void grow() {
+            std::vector<std::uint32_t> stamps = std::move(stamps_);
+            std::vector<int> keys = std::move(keys_);
+            const std::size_t capacity = stamps.empty() ? 64 : stamps.size() * 2;
+            stamps_.assign(capacity, 0);
+            keys_.assign(capacity, 0);
+            const std::uint32_t epoch = epoch_;
+            epoch_ = 1;
+            for (std::size_t i = 0; i < stamps.size(); ++i) {
+                if (stamps[i] == epoch) {
+                    std::size_t slot = find(keys[i]);
+                    stamps_[slot] = epoch_;
+                    keys_[slot] = keys[i];
+                }
+            }
+        }
+
+        std::vector<std::uint32_t> stamps_;   ///< Эпоха, в которую слот занят
+        std::vector<int> keys_;               ///< Ключи слотов
+        std::uint32_t epoch_ = 1;
+        std::size_t size_ = 0;
+    };
+
+} // namespace recsys
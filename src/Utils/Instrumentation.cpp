@@ -0,0 +1,131 @@
+#include "Instrumentation.h"
+#include <atomic>
+#include <iterator>
+#include <iomanip>
+#include <sstream>
+
+namespace recsys {
+
+    namespace {
+
+        /**
+         * @struct GlobalCounters
+         * @brief Сброшенные из потоков значения
+         */
+        struct GlobalCounters {
+            std::array<std::atomic<std::uint64_t>, Instrumentation::kCounters> counters{};
+            std::array<std::atomic<std::uint64_t>, Instrumentation::kStages> stageCalls{};
+            std::array<std::atomic<std::uint64_t>, Instrumentation::kStages> stageNanos{};
+        };
+
+        GlobalCounters& globals() {
+            static GlobalCounters counters;
+            return counters;
+        }
+
+        template <std::size_t N>
+        void drain(std::array<std::uint64_t, N>& from, std::array<std::atomic<std::uint64_t>, N>& into) {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (from[i] != 0) into[i].fetch_add(from[i], std::memory_order_relaxed);
+                from[i] = 0;
+            }
+        }
+
+        template <std::size_t N>
+        void load(const std::array<std::atomic<std::uint64_t>, N>& from, std::array<std::uint64_t, N>& into) {
+            for (std::size_t i = 0; i < N; ++i) into[i] = from[i].load(std::memory_order_relaxed);
+        }
+
+        constexpr const char* kCounterNames[] = {
+            "similarity_evaluations", "overlap_items", "neighbors_found", "neighbors_examined",
+            "cache_hits", "cache_misses", "candidates_generated", "candidates_scored", "degraded_responses"
+        };
+        constexpr const char* kCounterHelp[] = {
+            "Similarity computations between two users or two items",
+            "Co-rated items summed over similarity computations",
+            "Neighbors with positive similarity",
+            "Neighbors inspected while aggregating ratings",
+            "Prediction cache hits",
+            "Prediction cache misses",
+            "Candidate items collected from co-rating users before scoring",
+            "Candidate items scored for top-N lists",
+            "Top-N responses cut short to meet a deadline"
+        };
+        constexpr const char* kStageNames[] = {
+            "predict_user", "predict_item", "neighbors", "aggregate", "recommend_topn",
+            "recommend_hybrid", "recommend_item_based", "recommend_from_neighbors",
+            "recommend_deadline", "select_topn"
+        };
+        static_assert(std::size(kCounterNames) == Instrumentation::kCounters, "counter names out of sync");
+        static_assert(std::size(kCounterHelp) == Instrumentation::kCounters, "counter help out of sync");
+        static_assert(std::size(kStageNames) == Instrumentation::kStages, "stage names out of sync");
+
+    } // namespace
+
+    void Instrumentation::flushBlock(LocalBlock& block) {
+        GlobalCounters& g = globals();
+        drain(block.values.counters, g.counters);
+        drain(block.values.stageCalls, g.stageCalls);
+        drain(block.values.stageNanos, g.stageNanos);
+        block.pending = 0;
+    }
+
+    void Instrumentation::flush() {
+        flushBlock(local());
+    }
+
+    Instrumentation::Snapshot Instrumentation::snapshot() {
+        flush();
+        const GlobalCounters& g = globals();
+        Snapshot result;
+        load(g.counters, result.counters);
+        load(g.stageCalls, result.stageCalls);
+        load(g.stageNanos, result.stageNanos);
+        return result;
+    }
+
+    void Instrumentation::reset() {
+        LocalBlock& block = local();
+        block.values = Snapshot{};
+        block.pending = 0;
+        GlobalCounters& g = globals();
+        for (auto& c : g.counters) c.store(0, std::memory_order_relaxed);
+        for (auto& c : g.stageCalls) c.store(0, std::memory_order_relaxed);
+        for (auto& c : g.stageNanos) c.store(0, std::memory_order_relaxed);
+    }
+
+    const char* Instrumentation::name(Counter counter) {
+        return kCounterNames[static_cast<std::size_t>(counter)];
+    }
+
+    const char* Instrumentation::name(Stage stage) {
+        return kStageNames[static_cast<std::size_t>(stage)];
+    }
+
+    void Instrumentation::writeText(std::ostream& out, const Snapshot& snapshot) {
+        for (std::size_t i = 0; i < kCounters; ++i) {
+            out << "# HELP recsys_" << kCounterNames[i] << "_total " << kCounterHelp[i] << "\n"
+                << "# TYPE recsys_" << kCounterNames[i] << "_total counter\n"
+                << "recsys_" << kCounterNames[i] << "_total " << snapshot.counters[i] << "\n";
+        }
+        out << "# HELP recsys_stage_calls_total Calls per instrumented stage\n"
+            << "# TYPE recsys_stage_calls_total counter\n";
+        for (std::size_t i = 0; i < kStages; ++i) {
+            out << "recsys_stage_calls_total{stage=\"" << kStageNames[i] << "\"} " << snapshot.stageCalls[i] << "\n";
+        }
+        out << "# HELP recsys_stage_seconds_total Wall time per instrumented stage (nested stages overlap)\n"
+            << "# TYPE recsys_stage_seconds_total counter\n";
+        for (std::size_t i = 0; i < kStages; ++i) {
+            std::ostringstream seconds;
+            seconds << std::setprecision(9) << static_cast<double>(snapshot.stageNanos[i]) / 1e9;
+            out << "recsys_stage_seconds_total{stage=\"" << kStageNames[i] << "\"} " << seconds.str() << "\n";
+        }
+    }
+
+    std::string Instrumentation::text(const Snapshot& snapshot) {
+        std::ostringstream out;
+        writeText(out, snapshot);
+        return out.str();
+    }
+
+} // namespace recsys
@@ -0,0 +1,189 @@
+/**
+ * @file Instrumentation.h
+ * @brief Счётчики и таймеры горячего пути, отключаемые на этапе компиляции.
+ *
+ * Включается определением RECSYS_INSTRUMENTATION=1 (опция CMake
+ * RECSYS_INSTRUMENTATION). При выключенной опции макросы RECSYS_COUNT и
+ * RECSYS_TIME_STAGE раскрываются в пустые выражения и не стоят ничего.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#ifndef RECSYS_INSTRUMENTATION
+#define RECSYS_INSTRUMENTATION 0
+#endif
+
+namespace recsys {
+
+    /**
+     * @class Instrumentation
+     * @brief Потоколокальные счётчики, периодически сбрасываемые в общие атомарные.
+     *
+     * Горячий путь пишет только в блок своего потока (без атомарных операций);
+     * блок сливается в глобальные счётчики каждые kFlushEvery событий, при
+     * завершении потока, после каждой задачи ThreadPool и при вызове
+     * snapshot() из этого же потока.
+     * Поэтому снимок, сделанный во время работы других потоков, может
+     * отставать не более чем на kFlushEvery событий на поток.
+     */
+    class Instrumentation {
+    public:
+        /// Включены ли счётчики в этой сборке.
+        static constexpr bool enabled = RECSYS_INSTRUMENTATION != 0;
+
+        /// Событий в потоке между сбросами в глобальные счётчики.
+        static constexpr std::uint32_t kFlushEvery = 1024;
+
+        /// Счётчики событий
+        enum class Counter {
+            SimilarityEvaluations,   ///< Вычислений схожести пользователей или товаров
+            OverlapItems,            ///< Сумма размеров пересечений (общих оценок) по этим вычислениям
+            NeighborsFound,          ///< Соседей с положительной схожестью
+            NeighborsExamined,       ///< Соседей, просмотренных при агрегации
+            CacheHits,               ///< Попаданий в кэш предсказаний
+            CacheMisses,             ///< Промахов кэша предсказаний
+            CandidatesGenerated,     ///< Кандидатов, отобранных по соседям до оценки
+            CandidatesScored,        ///< Кандидатов, оценённых при построении top-N
+            DegradedResponses,       ///< Выдач, урезанных ради срока (Recommender::recommendWithDeadline)
+            Count
+        };
+
+        /// Этапы, для которых считаются вызовы и суммарное время
+        enum class Stage {
+            PredictUser,             ///< Predictor::predict
+            PredictItem,             ///< Predictor::predictItemBased
+            Neighbors,               ///< Поиск соседей (NeighborhoodPredictor::neighbors)
+            Aggregate,               ///< Агрегация оценок соседей
+            RecommendTopN,           ///< Recommender::recommendTopN
+            RecommendHybrid,         ///< Recommender::recommendHybrid
+            RecommendItemBased,      ///< Recommender::recommendItemBasedTopN
+            RecommendFromNeighbors,  ///< Recommender::recommendFromNeighbors
+            RecommendWithDeadline,   ///< Recommender::recommendWithDeadline
+            SelectTopN,              ///< Recommender::selectTopN
+            Count
+        };
+
+        static constexpr std::size_t kCounters = static_cast<std::size_t>(Counter::Count);
+        static constexpr std::size_t kStages = static_cast<std::size_t>(Stage::Count);
+
+        /**
+         * @struct Snapshot
+         * @brief Значения всех счётчиков на момент снятия
+         */
+        struct Snapshot {
+            std::array<std::uint64_t, kCounters> counters{};
+            std::array<std::uint64_t, kStages> stageCalls{};
+            std::array<std::uint64_t, kStages> stageNanos{};
+
+            std::uint64_t operator[](Counter c) const { return counters[static_cast<std::size_t>(c)]; }
+            std::uint64_t calls(Stage s) const { return stageCalls[static_cast<std::size_t>(s)]; }
+            std::uint64_t nanos(Stage s) const { return stageNanos[static_cast<std::size_t>(s)]; }
+        };
+
+        /// Прибавляет n к счётчику в блоке текущего потока.
+        static void add(Counter counter, std::uint64_t n = 1) {
+            LocalBlock& block = local();
+            block.values.counters[static_cast<std::size_t>(counter)] += n;
+            block.tick();
+        }
+
+        /// Учитывает один вызов этапа длительностью nanos.
+        static void addStage(Stage stage, std::uint64_t nanos) {
+            LocalBlock& block = local();
+            block.values.stageCalls[static_cast<std::size_t>(stage)] += 1;
+            block.values.stageNanos[static_cast<std::size_t>(stage)] += nanos;
+            block.tick();
+        }
+
+        /// Сбрасывает блок текущего потока в глобальные счётчики.
+        static void flush();
+
+        /// Сбрасывает блок текущего потока и возвращает глобальные значения.
+        static Snapshot snapshot();
+
+        /// Обнуляет глобальные счётчики и блок текущего потока.
+        static void reset();
+
+        /// Имя счётчика в формате экспозиции (без префикса и суффикса).
+        static const char* name(Counter counter);
+
+        /// Имя этапа (значение метки stage).
+        static const char* name(Stage stage);
+
+        /**
+         * @brief Пишет снимок в текстовом формате экспозиции Prometheus.
+         *
+         * Счётчики — recsys_<имя>_total, этапы — recsys_stage_calls_total и
+         * recsys_stage_seconds_total с меткой stage.
+         */
+        static void writeText(std::ostream& out, const Snapshot& snapshot);
+
+        /// writeText() в строку.
+        static std::string text(const Snapshot& snapshot);
+
+        /**
+         * @class StageTimer
+         * @brief Учитывает время от создания до разрушения как один вызов этапа.
+         */
+        class StageTimer {
+        public:
+            explicit StageTimer(Stage stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+            ~StageTimer() {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_).count();
+                addStage(stage_, static_cast<std::uint64_t>(ns));
+            }
+            StageTimer(const StageTimer&) = delete;
+            StageTimer& operator=(const StageTimer&) = delete;
+
+        private:
+            Stage stage_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+    private:
+        /**
+         * @struct LocalBlock
+         * @brief Несброшенные значения одного потока
+         */
+        struct LocalBlock {
+            Snapshot values;
+            std::uint32_t pending = 0;
+
+            void tick() {
+                if (++pending >= kFlushEvery) flushBlock(*this);
+            }
+            ~LocalBlock() { flushBlock(*this); }
+        };
+
+        static LocalBlock& local() {
+            thread_local LocalBlock block;
+            return block;
+        }
+
+        static void flushBlock(LocalBlock& block);
+    };
+
+} // namespace recsys
+
+#define RECSYS_INSTR_CONCAT_(a, b) a##b
+#define RECSYS_INSTR_CONCAT(a, b) RECSYS_INSTR_CONCAT_(a, b)
+
+#if RECSYS_INSTRUMENTATION
+/// Прибавляет n к счётчику Instrumentation::Counter::name.
+#define RECSYS_COUNT(name, n) ::recsys::Instrumentation::add(::recsys::Instrumentation::Counter::name, (n))
+/// Замеряет время до конца текущей области как этап Instrumentation::Stage::name.
+#define RECSYS_TIME_STAGE(name) \
+    ::recsys::Instrumentation::StageTimer RECSYS_INSTR_CONCAT(recsysStageTimer_, __LINE__)( \
+        ::recsys::Instrumentation::Stage::name)
+#else
+#define RECSYS_COUNT(name, n) static_cast<void>(n)
+#define RECSYS_TIME_STAGE(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,78 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace recsys {
+
+    namespace {
+
+        constexpr int kExactBits = 7;                               ///< Значения < 128 — точно
+        constexpr std::uint64_t kExact = 1ull << kExactBits;
+        constexpr int kSubBits = kExactBits - 1;                    ///< 64 корзины на степень двойки
+        constexpr std::uint64_t kSub = 1ull << kSubBits;
+        constexpr std::size_t kBuckets = kExact + (64 - kExactBits) * kSub;
+
+        int log2Floor(std::uint64_t v) {
+            int e = 0;
+            while (v >>= 1) ++e;
+            return e;
+        }
+
+    } // namespace
+
+    LatencyHistogram::LatencyHistogram() : counts_(kBuckets, 0) {}
+
+    std::size_t LatencyHistogram::bucketOf(std::uint64_t value) {
+        if (value < kExact) return static_cast<std::size_t>(value);
+        const int e = log2Floor(value);              // ≥ kExactBits
+        const int shift = e - kSubBits;
+        const std::uint64_t sub = (value >> shift) - kSub; // [0, 64)
+        return static_cast<std::size_t>(kExact + (e - kExactBits) * kSub + sub);
+    }
+
+    std::uint64_t LatencyHistogram::upperBound(std::size_t bucket) {
+        if (bucket < kExact) return bucket;
+        const std::size_t rest = bucket - kExact;
+        const int e = static_cast<int>(rest / kSub) + kExactBits;
+        const int shift = e - kSubBits;
+        const std::uint64_t sub = rest % kSub + kSub;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(std::uint64_t value) {
+        ++counts_[bucketOf(value)];
+        ++count_;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (std::size_t b = 0; b < kBuckets; ++b) counts_[b] += other.counts_[b];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void LatencyHistogram::reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        count_ = sum_ = max_ = 0;
+        min_ = UINT64_MAX;
+    }
+
+    std::uint64_t LatencyHistogram::percentile(double q) const {
+        if (count_ == 0) return 0;
+        q = std::min(1.0, std::max(0.0, q));
+        auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count_)));
+        rank = std::max<std::uint64_t>(rank, 1);
+
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            seen += counts_[b];
+            if (seen >= rank) return std::min(upperBound(b), max_);
+        }
+        return max_;
+    }
+
+} // namespace recsys
@@ -0,0 +1,64 @@
+/**
+ * @file LatencyHistogram.h
+ * @brief Гистограмма задержек с логарифмически-линейными корзинами (в духе HdrHistogram).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class LatencyHistogram
+     * @brief Считает распределение значений (наносекунд) с относительной погрешностью < 1/64.
+     *
+     * Значения меньше 128 хранятся точно; каждая следующая степень двойки
+     * делится на 64 равные корзины. Запись — O(1) без выделений памяти,
+     * гистограммы разных потоков сливаются merge(). Процентили возвращают
+     * верхнюю границу корзины, то есть не занижают задержку.
+     *
+     * Класс не потокобезопасен: каждый поток пишет в свою гистограмму.
+     */
+    class LatencyHistogram {
+    public:
+        LatencyHistogram();
+
+        /// Учитывает одно значение.
+        void record(std::uint64_t value);
+
+        /// Прибавляет значения другой гистограммы.
+        void merge(const LatencyHistogram& other);
+
+        /// Сбрасывает все значения.
+        void reset();
+
+        /**
+         * @brief Значение, не меньше которого доля q значений.
+         * @param q Квантиль в [0, 1] (0.99 — p99)
+         * @return 0, если гистограмма пуста
+         */
+        std::uint64_t percentile(double q) const;
+
+        std::uint64_t count() const { return count_; }
+        std::uint64_t min() const { return count_ ? min_ : 0; }
+        std::uint64_t max() const { return max_; }
+        double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+    private:
+        /// Номер корзины значения.
+        static std::size_t bucketOf(std::uint64_t value);
+
+        /// Наибольшее значение, попадающее в корзину.
+        static std::uint64_t upperBound(std::size_t bucket);
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t count_ = 0;
+        std::uint64_t sum_ = 0;
+        std::uint64_t min_ = UINT64_MAX;
+        std::uint64_t max_ = 0;
+    };
+
+} // namespace recsys
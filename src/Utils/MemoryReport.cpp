@@ -0,0 +1,72 @@
+#include "MemoryReport.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace recsys {
+
+    void MemoryReport::add(std::string name, std::size_t entries, std::size_t bytes) {
+        entries_.push_back({std::move(name), entries, bytes});
+    }
+
+    const MemoryReport::Entry* MemoryReport::find(const std::string& name) const {
+        auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry& e) { return e.name == name; });
+        return it == entries_.end() ? nullptr : &*it;
+    }
+
+    std::size_t MemoryReport::total() const {
+        std::size_t sum = 0;
+        for (const auto& e : entries_) sum += e.bytes;
+        return sum;
+    }
+
+    std::size_t MemoryReport::heapBlock(std::size_t requested) {
+        if (requested == 0) return 0;
+        // glibc: 8 байт заголовка чанка, выравнивание 16, минимальный чанк 32
+        return std::max<std::size_t>(32, (requested + 8 + 15) & ~static_cast<std::size_t>(15));
+    }
+
+    std::size_t MemoryReport::residentBytes() {
+#ifdef _WIN32
+        return 0;
+#else
+        std::ifstream statm("/proc/self/statm");
+        std::size_t sizePages = 0, residentPages = 0;
+        if (!(statm >> sizePages >> residentPages)) return 0;
+        return residentPages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    void MemoryReport::print(std::ostream& out, std::size_t rssBytes) const {
+        constexpr double kMiB = 1024.0 * 1024.0;
+        const std::size_t sum = total();
+        std::size_t width = 9;
+        for (const auto& e : entries_) width = std::max(width, e.name.size() + 2);
+
+        out << std::left << std::setw(static_cast<int>(width)) << "structure" << std::right
+            << std::setw(13) << "entries" << std::setw(12) << "MiB" << std::setw(12) << "B/entry"
+            << std::setw(8) << "share" << "\n";
+        out << std::fixed;
+        for (const auto& e : entries_) {
+            out << std::left << std::setw(static_cast<int>(width)) << e.name << std::right
+                << std::setw(13) << e.entries
+                << std::setprecision(2) << std::setw(12) << static_cast<double>(e.bytes) / kMiB
+                << std::setprecision(1) << std::setw(12)
+                << (e.entries ? static_cast<double>(e.bytes) / static_cast<double>(e.entries) : 0.0)
+                << std::setw(7) << (sum ? 100.0 * static_cast<double>(e.bytes) / static_cast<double>(sum) : 0.0)
+                << "%\n";
+        }
+        out << std::left << std::setw(static_cast<int>(width)) << "total" << std::right << std::setw(13) << ""
+            << std::setprecision(2) << std::setw(12) << static_cast<double>(sum) / kMiB << "\n";
+        if (rssBytes > 0) {
+            out << std::left << std::setw(static_cast<int>(width)) << "process RSS" << std::right << std::setw(13) << ""
+                << std::setw(12) << static_cast<double>(rssBytes) / kMiB << "\n";
+        }
+        out.unsetf(std::ios::fixed);
+    }
+
+} // namespace recsys
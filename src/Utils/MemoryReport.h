@@ -0,0 +1,97 @@
+/**
+ * @file MemoryReport.h
+ * @brief Учёт памяти по структурам данных: пользователи, товары, индексы, кэши.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace recsys {
+
+    /**
+     * @class MemoryReport
+     * @brief Разбивка занятой кучи по именованным структурам.
+     *
+     * Байты оцениваются по модели размещения, а не измеряются аллокатором:
+     * каждый блок кучи округляется как в glibc malloc (заголовок 8 байт,
+     * выравнивание 16, минимум 32), узлы хеш-таблиц считаются как в
+     * libstdc++ (указатель next, значение и, если хеш не noexcept, сохранённый
+     * хеш) плюс массив корзин. Для другой стандартной библиотеки оценка
+     * остаётся верной по порядку величины; сверять её с RSS — residentBytes().
+     */
+    class MemoryReport {
+    public:
+        /**
+         * @struct Entry
+         * @brief Одна структура
+         */
+        struct Entry {
+            std::string name;        ///< Имя структуры
+            std::size_t entries = 0; ///< Число элементов (оценок, записей, пар, ...)
+            std::size_t bytes = 0;   ///< Оценка занятой памяти
+        };
+
+        /// Добавляет строку отчёта.
+        void add(std::string name, std::size_t entries, std::size_t bytes);
+
+        /// Строки в порядке добавления.
+        const std::vector<Entry>& entries() const { return entries_; }
+
+        /// Строка по имени или nullptr.
+        const Entry* find(const std::string& name) const;
+
+        /// Сумма байт по всем строкам.
+        std::size_t total() const;
+
+        /**
+         * @brief Печатает таблицу: имя, элементы, байты, байт на элемент, доля.
+         * @param rssBytes Резидентная память процесса для сравнения; 0 — не печатать
+         */
+        void print(std::ostream& out, std::size_t rssBytes = 0) const;
+
+        /// Резидентная память процесса (Linux, /proc/self/statm); 0, если недоступно.
+        static std::size_t residentBytes();
+
+        /// Размер блока кучи под запрос в requested байт (0 — блока нет).
+        static std::size_t heapBlock(std::size_t requested);
+
+        /// Буфер вектора (по capacity, не по size).
+        template <class T, class A>
+        static std::size_t bytesOf(const std::vector<T, A>& v) {
+            return heapBlock(v.capacity() * sizeof(T));
+        }
+
+        /// Узлы и корзины unordered_map (без памяти, на которую ссылаются значения).
+        template <class K, class V, class H, class E, class A>
+        static std::size_t bytesOf(const std::unordered_map<K, V, H, E, A>& m) {
+            return hashTableBytes<K, H, typename std::unordered_map<K, V, H, E, A>::value_type>(
+                m.size(), m.bucket_count());
+        }
+
+        /// Узлы и корзины unordered_set.
+        template <class K, class H, class E, class A>
+        static std::size_t bytesOf(const std::unordered_set<K, H, E, A>& s) {
+            return hashTableBytes<K, H, K>(s.size(), s.bucket_count());
+        }
+
+    private:
+        template <class K, class H, class Value>
+        static std::size_t hashTableBytes(std::size_t size, std::size_t buckets) {
+            constexpr bool cachesHash = !std::is_nothrow_invocable_v<const H&, const K&>;
+            constexpr std::size_t node = sizeof(void*) + sizeof(Value) + (cachesHash ? sizeof(std::size_t) : 0);
+            // Таблица из одной корзины хранится внутри самого контейнера
+            const std::size_t bucketArray = buckets > 1 ? heapBlock(buckets * sizeof(void*)) : 0;
+            return size * heapBlock(node) + bucketArray;
+        }
+
+        std::vector<Entry> entries_;
+    };
+
+} // namespace recsys
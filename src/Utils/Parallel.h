@@ -0,0 +1,162 @@
+/**
+ * @file Parallel.h
+ * @brief Параллельные циклы и редукции поверх общего пула ThreadPool::global().
+ */
+
+#pragma once
+
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace recsys {
+
+    namespace detail {
+
+        /**
+         * @struct ParallelLoop
+         * @brief Общее состояние цикла: счётчик блоков, активные помощники, первое исключение.
+         *
+         * Хранится в shared_ptr: помощник, запущенный пулом уже после конца
+         * цикла, видит исчерпанный счётчик и выходит, не трогая тело цикла.
+         */
+        struct ParallelLoop {
+            std::atomic<std::size_t> next{0};
+            std::size_t chunks = 0;
+            std::size_t active = 0;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        /// Выполняет блоки, пока они есть; исключение останавливает раздачу.
+        template <class Body>
+        void runChunks(ParallelLoop& loop, Body& body) {
+            try {
+                for (std::size_t c = loop.next++; c < loop.chunks; c = loop.next++) body(c);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(loop.mutex);
+                if (!loop.error) loop.error = std::current_exception();
+                loop.next = loop.chunks;
+            }
+        }
+
+        /**
+         * @brief Выполняет body(c) для блоков c из [0, chunks) на вызывающем потоке и помощниках из пула.
+         *
+         * Вызывающий поток сам берёт блоки, поэтому вложенный вызов из задачи
+         * пула не ждёт свободного рабочего и не может зависнуть.
+         */
+        template <class Body>
+        void runParallel(std::size_t chunks, Body& body, std::size_t threads) {
+            if (chunks == 0) return;
+            ThreadPool& pool = ThreadPool::global();
+            if (threads == 0) threads = pool.size();
+            const std::size_t helpers = std::min(threads, chunks) - 1;
+
+            if (helpers == 0) {
+                for (std::size_t c = 0; c < chunks; ++c) body(c);
+                return;
+            }
+
+            auto loop = std::make_shared<ParallelLoop>();
+            loop->chunks = chunks;
+            for (std::size_t h = 0; h < helpers; ++h) {
+                pool.post([loop, &body] {
+                    {
+                        std::lock_guard<std::mutex> lock(loop->mutex);
+                        if (loop->next.load() >= loop->chunks) return;
+                        ++loop->active;
+                    }
+                    runChunks(*loop, body);
+                    // До окончания цикла: вызывающий может сразу взять snapshot()
+                    if constexpr (Instrumentation::enabled) Instrumentation::flush();
+                    std::lock_guard<std::mutex> lock(loop->mutex);
+                    if (--loop->active == 0) loop->done.notify_all();
+                });
+            }
+
+            runChunks(*loop, body);
+            std::unique_lock<std::mutex> lock(loop->mutex);
+            loop->done.wait(lock, [&] { return loop->active == 0; });
+            if (loop->error) std::rethrow_exception(loop->error);
+        }
+
+    } // namespace detail
+
+    /// Число потоков общего пула (столько же по умолчанию берут parallelFor и parallelReduce).
+    inline std::size_t poolThreads() {
+        return ThreadPool::globalThreads();
+    }
+
+    /**
+     * @brief Выполняет fn(i) для всех i из [0, count) на нескольких потоках.
+     *
+     * Индексы раздаются динамически, поэтому задачи разной длительности
+     * распределяются равномерно. Первое исключение, брошенное fn,
+     * пробрасывается вызывающему после завершения всех потоков.
+     *
+     * @param count Число итераций
+     * @param fn Тело цикла; должно быть безопасно для вызова из разных потоков
+     * @param threads Предел параллельности; 0 — размер общего пула
+     */
+    template <class Fn>
+    void parallelFor(std::size_t count, Fn&& fn, std::size_t threads = 0) {
+        auto body = [&fn](std::size_t i) { fn(i); };
+        detail::runParallel(count, body, threads);
+    }
+
+    /**
+     * @brief Выполняет fn(begin, end) для блоков по grain индексов из [0, count).
+     *
+     * Крупный grain уменьшает накладные расходы на раздачу для дешёвых
+     * итераций; мелкий — выравнивает нагрузку для дорогих.
+     *
+     * @param grain Индексов в блоке; 0 — примерно четыре блока на поток
+     * @param threads Предел параллельности; 0 — размер общего пула
+     */
+    template <class Fn>
+    void parallelForRange(std::size_t count, std::size_t grain, Fn&& fn, std::size_t threads = 0) {
+        if (count == 0) return;
+        if (grain == 0) {
+            const std::size_t parts = 4 * (threads == 0 ? poolThreads() : threads);
+            grain = std::max<std::size_t>(1, (count + parts - 1) / parts);
+        }
+        const std::size_t chunks = (count + grain - 1) / grain;
+        auto body = [&](std::size_t c) { fn(c * grain, std::min(count, (c + 1) * grain)); };
+        detail::runParallel(chunks, body, threads);
+    }
+
+    /**
+     * @brief Параллельная редукция по блокам фиксированного размера.
+     *
+     * map(begin, end) сворачивает блок в значение типа T, combine(a, b)
+     * сливает значения слева направо по порядку блоков. Границы блоков и
+     * порядок слияния не зависят от числа потоков, поэтому результат
+     * воспроизводим бит в бит.
+     *
+     * @param grain Индексов в блоке (больше 0)
+     * @param identity Результат для пустого диапазона
+     */
+    template <class T, class Map, class Combine>
+    T parallelReduce(std::size_t count, std::size_t grain, T identity, Map&& map, Combine&& combine,
+                     std::size_t threads = 0) {
+        if (grain == 0) grain = 1;
+        const std::size_t chunks = (count + grain - 1) / grain;
+        std::vector<T> partial(chunks, identity);
+        auto body = [&](std::size_t c) { partial[c] = map(c * grain, std::min(count, (c + 1) * grain)); };
+        detail::runParallel(chunks, body, threads);
+
+        T total = std::move(identity);
+        for (auto& p : partial) total = combine(std::move(total), std::move(p));
+        return total;
+    }
+
+} // namespace recsys
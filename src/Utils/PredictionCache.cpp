@@ -0,0 +1,127 @@
+#include "PredictionCache.h"
+#include "MemoryReport.h"
+#include <functional>
+
+namespace recsys {
+
+    PredictionCache::PredictionCache(std::size_t shardCount)
+        : shardCount_(shardCount == 0 ? 1 : shardCount),
+          shards_(new Shard[shardCount_]) {}
+
+    PredictionCache::Shard& PredictionCache::shardFor(int userId) const {
+        return shards_[std::hash<int>{}(userId) % shardCount_];
+    }
+
+    std::optional<double> PredictionCache::find(const PredictionKey& key) const {
+        Shard& shard = shardFor(key.userId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto uit = shard.byUser.find(key.userId);
+        if (uit == shard.byUser.end()) return std::nullopt;
+        auto iit = uit->second.find(key.itemId);
+        if (iit == uit->second.end()) return std::nullopt;
+
+        for (const auto& [variant, value] : iit->second) {
+            if (variant == key.variant) return value;
+        }
+        return std::nullopt;
+    }
+
+    void PredictionCache::insert(const PredictionKey& key, double value) {
+        Shard& shard = shardFor(key.userId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto& variants = shard.byUser[key.userId][key.itemId];
+        if (variants.empty()) shard.usersByItem[key.itemId].insert(key.userId);
+
+        for (auto& [variant, stored] : variants) {
+            if (variant == key.variant) {
+                stored = value;
+                return;
+            }
+        }
+        variants.emplace_back(key.variant, value);
+        ++shard.size;
+    }
+
+    std::size_t PredictionCache::invalidateUser(int userId) {
+        Shard& shard = shardFor(userId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto uit = shard.byUser.find(userId);
+        if (uit == shard.byUser.end()) return 0;
+
+        std::size_t removed = 0;
+        for (const auto& [itemId, variants] : uit->second) {
+            removed += variants.size();
+            auto bit = shard.usersByItem.find(itemId);
+            if (bit != shard.usersByItem.end()) {
+                bit->second.erase(userId);
+                if (bit->second.empty()) shard.usersByItem.erase(bit);
+            }
+        }
+        shard.byUser.erase(uit);
+        shard.size -= removed;
+        return removed;
+    }
+
+    std::size_t PredictionCache::invalidateItem(int itemId) {
+        std::size_t removed = 0;
+        for (std::size_t s = 0; s < shardCount_; ++s) {
+            Shard& shard = shards_[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            auto bit = shard.usersByItem.find(itemId);
+            if (bit == shard.usersByItem.end()) continue;
+
+            for (int userId : bit->second) {
+                auto uit = shard.byUser.find(userId);
+                if (uit == shard.byUser.end()) continue;
+                auto iit = uit->second.find(itemId);
+                if (iit == uit->second.end()) continue;
+
+                removed += iit->second.size();
+                shard.size -= iit->second.size();
+                uit->second.erase(iit);
+                if (uit->second.empty()) shard.byUser.erase(uit);
+            }
+            shard.usersByItem.erase(bit);
+        }
+        return removed;
+    }
+
+    void PredictionCache::clear() {
+        for (std::size_t s = 0; s < shardCount_; ++s) {
+            Shard& shard = shards_[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.byUser.clear();
+            shard.usersByItem.clear();
+            shard.size = 0;
+        }
+    }
+
+    std::size_t PredictionCache::size() const {
+        std::size_t total = 0;
+        for (std::size_t s = 0; s < shardCount_; ++s) {
+            std::lock_guard<std::mutex> lock(shards_[s].mutex);
+            total += shards_[s].size;
+        }
+        return total;
+    }
+
+    std::size_t PredictionCache::memoryBytes() const {
+        std::size_t bytes = MemoryReport::heapBlock(shardCount_ * sizeof(Shard));
+        for (std::size_t s = 0; s < shardCount_; ++s) {
+            const Shard& shard = shards_[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            bytes += MemoryReport::bytesOf(shard.byUser) + MemoryReport::bytesOf(shard.usersByItem);
+            for (const auto& [userId, entries] : shard.byUser) {
+                bytes += MemoryReport::bytesOf(entries);
+                for (const auto& [itemId, variants] : entries) bytes += MemoryReport::bytesOf(variants);
+            }
+            for (const auto& [itemId, users] : shard.usersByItem) bytes += MemoryReport::bytesOf(users);
+        }
+        return bytes;
+    }
+
+} // namespace recsys
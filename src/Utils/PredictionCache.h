@@ -0,0 +1,85 @@
+/**
+ * @file PredictionCache.h
+ * @brief Потокобезопасный кэш предсказаний с точечной инвалидацией.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "Cache.h"
+
+namespace recsys {
+
+    /**
+     * @class PredictionCache
+     * @brief Кэш (user, item, variant) → предсказание, разбитый на шарды по пользователю.
+     *
+     * Помимо основного отображения поддерживается обратный индекс item → users,
+     * поэтому можно сбросить все записи одного пользователя или одного товара,
+     * не очищая кэш целиком. Каждый шард защищён своим мьютексом, так что
+     * чтения разных пользователей почти не конкурируют.
+     */
+    class PredictionCache {
+    public:
+        /**
+         * @brief Создаёт пустой кэш.
+         * @param shardCount Число шардов (≥ 1)
+         */
+        explicit PredictionCache(std::size_t shardCount = 16);
+
+        /// Значение по ключу, если оно есть.
+        std::optional<double> find(const PredictionKey& key) const;
+
+        /// Сохраняет или перезаписывает значение.
+        void insert(const PredictionKey& key, double value);
+
+        /**
+         * @brief Удаляет все записи пользователя.
+         * @return Число удалённых записей
+         */
+        std::size_t invalidateUser(int userId);
+
+        /**
+         * @brief Удаляет все записи товара (для всех пользователей).
+         * @return Число удалённых записей
+         */
+        std::size_t invalidateItem(int itemId);
+
+        /// Удаляет все записи.
+        void clear();
+
+        /// Текущее число записей.
+        std::size_t size() const;
+
+        /// Оценка занятой памяти (шарды, записи и обратный индекс), см. MemoryReport.
+        std::size_t memoryBytes() const;
+
+    private:
+        /// Значения одного пользователя: item → [(variant, value)].
+        using UserEntries = std::unordered_map<int, std::vector<std::pair<int, double>>>;
+
+        /**
+         * @struct Shard
+         * @brief Часть кэша с собственным мьютексом.
+         */
+        struct Shard {
+            mutable std::mutex mutex;
+            std::unordered_map<int, UserEntries> byUser;                 ///< user → записи
+            std::unordered_map<int, std::unordered_set<int>> usersByItem; ///< item → users этого шарда
+            std::size_t size = 0;                                         ///< Число записей
+        };
+
+        Shard& shardFor(int userId) const;
+
+        std::size_t shardCount_;
+        std::unique_ptr<Shard[]> shards_;
+    };
+
+} // namespace recsys
@@ -0,0 +1,145 @@
+#include "ThreadPool.h"
+#include "Instrumentation.h"
+#include <stdexcept>
+
+namespace recsys {
+
+    namespace {
+
+        /**
+         * @struct WorkerSlot
+         * @brief Пул и номер рабочего, которым является текущий поток
+         */
+        struct WorkerSlot {
+            const ThreadPool* pool = nullptr;
+            std::size_t index = 0;
+        };
+
+        thread_local WorkerSlot currentSlot;
+
+        /*
+         * Общий пул читается на каждом top-N и parallelFor, поэтому чтение идёт
+         * по атомарным переменным без мьютекса; globalMutex сериализует только
+         * создание пула и setGlobalThreads.
+         */
+        std::mutex globalMutex;
+        std::atomic<std::size_t> globalSize{0};          ///< 0 — ещё не задан и не вычислен
+        std::atomic<ThreadPool*> globalPool{nullptr};
+
+    } // namespace
+
+    ThreadPool::ThreadPool(std::size_t threads) {
+        if (threads == 0) threads = hardwareThreads();
+        queues_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+        workers_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    int ThreadPool::currentWorker() const {
+        return currentSlot.pool == this ? static_cast<int>(currentSlot.index) : -1;
+    }
+
+    void ThreadPool::post(std::function<void()> task) {
+        const int self = currentWorker();
+        const std::size_t index = self >= 0
+            ? static_cast<std::size_t>(self)
+            : nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        {
+            // Под sleepMutex_, чтобы рабочий между проверкой и ожиданием не пропустил задачу
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            queued_.fetch_add(1, std::memory_order_release);
+        }
+        wake_.notify_one();
+    }
+
+    bool ThreadPool::tryTake(std::size_t index, std::function<void()>& task) {
+        {
+            Queue& own = *queues_[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (std::size_t offset = 1; offset < queues_.size(); ++offset) {
+            Queue& victim = *queues_[(index + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::workerLoop(std::size_t index) {
+        currentSlot = {this, index};
+        std::function<void()> task;
+        for (;;) {
+            if (tryTake(index, task)) {
+                task();
+                task = nullptr;
+                // Рабочие живут всё время работы программы: счётчики сбрасываются
+                // после каждой задачи, иначе snapshot() не увидит их до выхода
+                if constexpr (Instrumentation::enabled) Instrumentation::flush();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+            if (stopping_ && queued_.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+    ThreadPool& ThreadPool::global() {
+        if (ThreadPool* pool = globalPool.load(std::memory_order_acquire)) return *pool;
+        std::lock_guard<std::mutex> lock(globalMutex);
+        ThreadPool* pool = globalPool.load(std::memory_order_relaxed);
+        if (!pool) {
+            // Намеренно не разрушается: рабочие не должны останавливаться раньше
+            // статических объектов, которые ещё могут ставить задачи
+            pool = new ThreadPool(globalThreads());
+            globalPool.store(pool, std::memory_order_release);
+        }
+        return *pool;
+    }
+
+    void ThreadPool::setGlobalThreads(std::size_t threads) {
+        std::lock_guard<std::mutex> lock(globalMutex);
+        if (threads == 0) threads = hardwareThreads();
+        if (ThreadPool* pool = globalPool.load(std::memory_order_relaxed)) {
+            if (pool->size() == threads) return;
+            throw std::logic_error("Global thread pool is already running");
+        }
+        globalSize.store(threads, std::memory_order_relaxed);
+    }
+
+    std::size_t ThreadPool::globalThreads() {
+        std::size_t size = globalSize.load(std::memory_order_relaxed);
+        if (size != 0) return size;
+        // Первое обращение до setGlobalThreads: размер по числу аппаратных потоков;
+        // CAS не перетирает значение, которое setGlobalThreads успел записать
+        size = hardwareThreads();
+        std::size_t expected = 0;
+        if (!globalSize.compare_exchange_strong(expected, size, std::memory_order_relaxed)) return expected;
+        return size;
+    }
+
+} // namespace recsys
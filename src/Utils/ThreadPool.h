@@ -0,0 +1,108 @@
+/**
+ * @file ThreadPool.h
+ * @brief Общий пул рабочих потоков с очередями, из которых простаивающие потоки крадут задачи.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace recsys {
+
+    /// Число аппаратных потоков (не меньше 1).
+    inline std::size_t hardwareThreads() {
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @class ThreadPool
+     * @brief Фиксированный набор рабочих потоков.
+     *
+     * У каждого рабочего своя очередь: задачи, поставленные из рабочего
+     * потока, попадают в его очередь и берутся с конца (последняя поставленная
+     * — первой, пока её данные горячие в кэше), а простаивающие рабочие
+     * крадут из чужих очередей с начала. Задачи из внешних потоков
+     * раскладываются по очередям по кругу.
+     *
+     * Весь код библиотеки использует global(); его размер задаётся один раз
+     * до первого обращения (recsys --threads N) через setGlobalThreads().
+     */
+    class ThreadPool {
+    public:
+        /// Пул из threads рабочих (0 — по числу аппаратных потоков).
+        explicit ThreadPool(std::size_t threads = 0);
+
+        /// Дожидается выполнения всех поставленных задач и останавливает рабочих.
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// Число рабочих потоков.
+        std::size_t size() const { return workers_.size(); }
+
+        /**
+         * @brief Ставит fn() в очередь.
+         * @return future с результатом fn или брошенным ею исключением
+         */
+        template <class Fn>
+        auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>> {
+            using R = std::invoke_result_t<std::decay_t<Fn>>;
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<Fn>(fn));
+            std::future<R> result = task->get_future();
+            post([task] { (*task)(); });
+            return result;
+        }
+
+        /// Ставит задачу без результата; исключения из неё должна ловить сама задача.
+        void post(std::function<void()> task);
+
+        /// Общий пул библиотеки; создаётся при первом обращении, дальше читается без блокировок.
+        static ThreadPool& global();
+
+        /**
+         * @brief Задаёт размер общего пула.
+         * @throws std::logic_error Если global() уже создан с другим размером
+         */
+        static void setGlobalThreads(std::size_t threads);
+
+        /// Размер, с которым будет (или был) создан общий пул; без блокировок.
+        static std::size_t globalThreads();
+
+        /// Номер текущего рабочего потока этого пула или -1 для чужого потока.
+        int currentWorker() const;
+
+    private:
+        /**
+         * @struct Queue
+         * @brief Очередь одного рабочего
+         */
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void workerLoop(std::size_t index);
+        bool tryTake(std::size_t index, std::function<void()>& task);
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> workers_;
+        std::atomic<std::size_t> queued_{0};      ///< Задач во всех очередях
+        std::atomic<std::size_t> nextQueue_{0};   ///< Очередь для следующей внешней задачи
+        std::mutex sleepMutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+    };
+
+} // namespace recsys
@@ -0,0 +1,173 @@
+#include "Tracing.h"
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace recsys {
+
+    std::atomic<bool> Tracer::active_{false};
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @struct Event
+         * @brief Завершённый интервал (время — нс от эпохи steady_clock)
+         */
+        struct Event {
+            const char* name;
+            const char* category;
+            std::int64_t beginNs;
+            std::int64_t durationNs;
+        };
+
+        /**
+         * @struct ThreadBuffer
+         * @brief События одного потока; мьютекс почти всегда свободен (его берёт и writeJson)
+         */
+        struct ThreadBuffer {
+            std::mutex mutex;
+            std::vector<Event> events;
+            std::size_t dropped = 0;
+            int tid = 0;
+        };
+
+        /**
+         * @struct Registry
+         * @brief Буферы всех потоков, когда-либо писавших в трассу
+         */
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            std::atomic<std::int64_t> epochNs{0};
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        std::int64_t toNs(Clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+        }
+
+        ThreadBuffer& localBuffer() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+            if (!buffer) {
+                buffer = std::make_shared<ThreadBuffer>();
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                buffer->tid = static_cast<int>(r.buffers.size()) + 1;
+                r.buffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+
+        /// Пишет строку JSON; имена — литералы из кода, но экранирование дешевле сюрпризов.
+        void writeString(std::ostream& out, const char* s) {
+            out << '"';
+            for (; *s; ++s) {
+                if (*s == '"' || *s == '\\') out << '\\';
+                out << *s;
+            }
+            out << '"';
+        }
+
+        /// Наносекунды в микросекунды с дробной частью (единица формата trace-event).
+        void writeMicros(std::ostream& out, std::int64_t ns) {
+            out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << (ns % 1000 + 1000) % 1000
+                << std::setfill(' ');
+        }
+
+    } // namespace
+
+    void Tracer::start() {
+        Registry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (auto& buffer : r.buffers) {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                buffer->events.clear();
+                buffer->dropped = 0;
+            }
+        }
+        r.epochNs.store(toNs(Clock::now()), std::memory_order_relaxed);
+        active_.store(true, std::memory_order_release);
+    }
+
+    void Tracer::stop() {
+        active_.store(false, std::memory_order_release);
+    }
+
+    void Tracer::record(const char* name, const char* category, Clock::time_point begin, Clock::time_point end) {
+        ThreadBuffer& buffer = localBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        if (buffer.events.size() >= kMaxEventsPerThread) {
+            ++buffer.dropped;
+            return;
+        }
+        buffer.events.push_back({name, category, toNs(begin), toNs(end) - toNs(begin)});
+    }
+
+    void Tracer::writeJson(std::ostream& out) {
+        Registry& r = registry();
+        const std::int64_t epoch = r.epochNs.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"recsys\"}}";
+        for (const auto& buffer : r.buffers) {
+            std::vector<Event> events;
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                events = buffer->events;
+            }
+            if (events.empty()) continue;
+            // Интервал пишется при закрытии, поэтому вложенные идут раньше внешних; упорядочиваем по началу
+            std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+                return a.beginNs != b.beginNs ? a.beginNs < b.beginNs : a.durationNs > b.durationNs;
+            });
+
+            out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+                << ", \"args\": {\"name\": \"thread " << buffer->tid << "\"}}";
+            for (const auto& e : events) {
+                out << ",\n{\"name\": ";
+                writeString(out, e.name);
+                out << ", \"cat\": ";
+                writeString(out, e.category);
+                out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid << ", \"ts\": ";
+                writeMicros(out, e.beginNs - epoch);
+                out << ", \"dur\": ";
+                writeMicros(out, e.durationNs);
+                out << "}";
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    std::size_t Tracer::eventCount() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::size_t total = 0;
+        for (const auto& buffer : r.buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            total += buffer->events.size();
+        }
+        return total;
+    }
+
+    std::size_t Tracer::droppedCount() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::size_t total = 0;
+        for (const auto& buffer : r.buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            total += buffer->dropped;
+        }
+        return total;
+    }
+
+} // namespace recsys
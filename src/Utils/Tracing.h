@@ -0,0 +1,110 @@
+/**
+ * @file Tracing.h
+ * @brief Трассировка этапов в формате Chrome trace-event (открывается в Perfetto и chrome://tracing).
+ *
+ * Включается в сборку опцией CMake RECSYS_TRACING (RECSYS_TRACING=1); без неё
+ * RECSYS_TRACE_SCOPE раскрывается в пустое выражение. Во включённой сборке
+ * запись идёт только между Tracer::start() и Tracer::stop(); в остальное
+ * время каждый интервал стоит одной проверки атомарного флага.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#ifndef RECSYS_TRACING
+#define RECSYS_TRACING 0
+#endif
+
+namespace recsys {
+
+    /**
+     * @class Tracer
+     * @brief Сбор завершённых интервалов («complete events») по потокам.
+     *
+     * Каждый поток пишет в собственный буфер, зарегистрированный в общем
+     * списке; буферы переживают свои потоки, а writeJson читает их под
+     * мьютексом, поэтому в трассу попадают и интервалы рабочих ThreadPool,
+     * и интервалы уже завершившихся потоков. Вложенные интервалы
+     * одного потока отображаются в Perfetto как стек этапов.
+     */
+    class Tracer {
+    public:
+        /// Включена ли трассировка в этой сборке.
+        static constexpr bool compiled = RECSYS_TRACING != 0;
+
+        /// Предел событий в буфере одного потока; лишние отбрасываются и считаются.
+        static constexpr std::size_t kMaxEventsPerThread = 1u << 20;
+
+        /// Очищает буферы и начинает запись; время трассы отсчитывается от этого момента.
+        static void start();
+
+        /// Прекращает запись (уже записанное сохраняется до следующего start()).
+        static void stop();
+
+        /// Идёт ли запись.
+        static bool active() { return active_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Пишет все записанные события как JSON-объект {"traceEvents": [...]}.
+         *
+         * Для каждого потока добавляется метасобытие thread_name, потоки
+         * нумеруются в порядке первой записи (главный поток обычно 1).
+         */
+        static void writeJson(std::ostream& out);
+
+        /// Записанных событий во всех буферах.
+        static std::size_t eventCount();
+
+        /// Событий, отброшенных из-за переполнения буферов.
+        static std::size_t droppedCount();
+
+        /**
+         * @class Span
+         * @brief Интервал от создания до разрушения; name и category — строковые литералы.
+         */
+        class Span {
+        public:
+            Span(const char* name, const char* category) {
+                if (active()) {
+                    name_ = name;
+                    category_ = category;
+                    start_ = std::chrono::steady_clock::now();
+                }
+            }
+            ~Span() {
+                if (name_) record(name_, category_, start_, std::chrono::steady_clock::now());
+            }
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+
+        private:
+            const char* name_ = nullptr;
+            const char* category_ = nullptr;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+    private:
+        static void record(const char* name, const char* category,
+                           std::chrono::steady_clock::time_point begin,
+                           std::chrono::steady_clock::time_point end);
+
+        static std::atomic<bool> active_;
+    };
+
+} // namespace recsys
+
+#define RECSYS_TRACE_CONCAT_(a, b) a##b
+#define RECSYS_TRACE_CONCAT(a, b) RECSYS_TRACE_CONCAT_(a, b)
+
+#if RECSYS_TRACING
+/// Трассирует текущую область как интервал name категории category.
+#define RECSYS_TRACE_SCOPE(name, category) \
+    ::recsys::Tracer::Span RECSYS_TRACE_CONCAT(recsysTraceSpan_, __LINE__)((name), (category))
+#else
+#define RECSYS_TRACE_SCOPE(name, category) static_cast<void>(0)
+#endif
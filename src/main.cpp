@@ -3,17 +3,34 @@
  * @brief Точка входа в программу: запуск системы коллаборативной фильтрации.
  *
  * Загружает пользователей и оценки из CSV-файла, вычисляет рекомендации
- * на основе user-based, item-based и гибридных алгоритмов. Также оценивает
- * точность предсказаний (MAE и RMSE).
+ * на основе user-based, item-based и гибридных алгоритмов. Точность
+ * предсказаний (MAE и RMSE) оценивается k-fold кросс-валидацией.
  */
 
 #include "Algorithms/Recommender.h"
-#include "Algorithms/Evaluation.h"
+#include "Algorithms/CrossValidation.h"
+#include "Algorithms/HyperparameterSweep.h"
+#include "Algorithms/LeaveOneOut.h"
+#include "Algorithms/ReplayEvaluation.h"
+#include "Algorithms/CoRatingIndex.h"
 #include "DataHandler/CSVLoader.h"
+#include "DataHandler/WindowedDataset.h"
+#include "Models/Dataset.h"
+#include "Serving/TcpServer.h"
+#include "Utils/Instrumentation.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/Tracing.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <iomanip>
+#include <limits>
+#include <chrono>
+#include <thread>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -40,6 +57,504 @@ void printRecommendations(const std::string& title, const std::vector<std::pair<
     }
 }
 
+/**
+ * @brief Выводит итог кросс-валидации с временем фаз.
+ *
+ * @param title Название алгоритма.
+ * @param report Результат CrossValidation::run.
+ */
+
+void printReport(const std::string& title, const CrossValidation::Report& report) {
+    std::cout << "\n[" << title << "]\n" << std::fixed << std::setprecision(4);
+    for (const auto& f : report.folds) {
+        std::cout << "  Фолд " << f.fold << ": обучение " << f.trainSize << ", тест " << f.testSize
+                  << ", MAE = " << f.mae << ", RMSE = " << f.rmse << "\n";
+    }
+    std::cout << "  MAE  = " << report.mae << "\n"
+              << "  RMSE = " << report.rmse << "\n"
+              << "  Покрытие = " << report.coverage() << "\n"
+              << std::setprecision(1)
+              << "  Время, мс: разбиение " << report.timings.splitMs
+              << ", модели " << report.timings.buildMs
+              << ", предсказание " << report.timings.predictMs
+              << ", метрики " << report.timings.scoreMs
+              << ", всего " << report.timings.totalMs << "\n";
+}
+
+/**
+ * @brief Разбирает название разбиения (random, user, temporal).
+ *
+ * @throws std::invalid_argument Если название неизвестно.
+ */
+
+CrossValidation::Split parseSplit(const std::string& name) {
+    if (name == "random") return CrossValidation::Split::Random;
+    if (name == "user") return CrossValidation::Split::PerUser;
+    if (name == "temporal") return CrossValidation::Split::Temporal;
+    throw std::invalid_argument("Неизвестное разбиение: " + name);
+}
+
+/**
+ * @brief Разбирает название метрики схожести.
+ *
+ * @throws std::invalid_argument Если название неизвестно.
+ */
+
+Predictor::Metric parseMetric(const std::string& name) {
+    if (name == "cosine") return Predictor::Metric::Cosine;
+    if (name == "pearson") return Predictor::Metric::Pearson;
+    if (name == "jaccard") return Predictor::Metric::Jaccard;
+    if (name == "manhattan") return Predictor::Metric::Manhattan;
+    throw std::invalid_argument("Неизвестная метрика: " + name);
+}
+
+/// Название метрики для вывода.
+const char* metricName(Predictor::Metric metric) {
+    switch (metric) {
+        case Predictor::Metric::Cosine: return "cosine";
+        case Predictor::Metric::Pearson: return "pearson";
+        case Predictor::Metric::Jaccard: return "jaccard";
+        case Predictor::Metric::Manhattan: return "manhattan";
+    }
+    return "?";
+}
+
+/**
+ * @brief Разбирает список значений через запятую.
+ *
+ * @param text Строка вида "1,2,5".
+ * @param parse Преобразование одного элемента.
+ */
+
+template <class T, class Parse>
+std::vector<T> parseList(const std::string& text, Parse parse) {
+    std::vector<T> values;
+    std::stringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        if (!token.empty()) values.push_back(parse(token));
+    }
+    return values;
+}
+
+/**
+ * @brief Подкоманда sweep: перебор k, метрик и alpha с выводом таблицы.
+ *
+ * Использование: recsys sweep <файл.csv> [--folds K] [--split S]
+ * [--k 1,2,5] [--alpha 1,0.5] [--metrics cosine,pearson]
+ *
+ * @return Код завершения.
+ */
+
+int runSweep(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "[ОШИБКА] Использование: recsys sweep <файл_данных.csv> [--folds K]"
+                     " [--split random|user|temporal] [--k 1,2,5] [--alpha 1,0.5]"
+                     " [--metrics cosine,pearson,jaccard,manhattan]\n";
+        return 1;
+    }
+
+    CrossValidation::Config config;
+    HyperparameterSweep::Grid grid;
+    grid.metrics = {Predictor::Metric::Cosine, Predictor::Metric::Pearson};
+    grid.ks = {1, 2, 3, 5, 10, 20};
+    grid.alphas = {1.0, 0.75, 0.5};
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string flag = argv[i], value = argv[i + 1];
+        if (flag == "--folds") config.folds = std::stoi(value);
+        else if (flag == "--split") config.split = parseSplit(value);
+        else if (flag == "--k") grid.ks = parseList<int>(value, [](const std::string& t) { return std::stoi(t); });
+        else if (flag == "--alpha") grid.alphas = parseList<double>(value, [](const std::string& t) { return std::stod(t); });
+        else if (flag == "--metrics") grid.metrics = parseList<Predictor::Metric>(value, parseMetric);
+        else {
+            std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<User> users;
+    std::vector<Item> items;
+    CSVLoader::load(argv[2], users, items, true);
+    std::cout << "[УСПЕХ] Загружено " << users.size() << " пользователей, " << items.size() << " товаров\n";
+
+    auto report = HyperparameterSweep::run(users, config, grid);
+    const std::size_t best = report.best();
+
+    std::cout << "\n" << std::left << std::setw(11) << "metric" << std::right
+              << std::setw(5) << "k" << std::setw(8) << "alpha"
+              << std::setw(9) << "MAE" << std::setw(9) << "RMSE" << std::setw(10) << "coverage" << "\n";
+    for (std::size_t i = 0; i < report.points.size(); ++i) {
+        const auto& p = report.points[i];
+        double coverage = report.testSize > 0 ? static_cast<double>(p.errors.count) / report.testSize : 0.0;
+        std::cout << std::left << std::setw(11) << metricName(p.metric) << std::right
+                  << std::setw(5) << p.k
+                  << std::setw(8) << std::fixed << std::setprecision(2) << p.alpha
+                  << std::setw(9) << std::setprecision(4) << p.errors.mae
+                  << std::setw(9) << p.errors.rmse
+                  << std::setw(10) << coverage
+                  << (i == best ? "  *" : "") << "\n";
+    }
+    std::cout << std::setprecision(1)
+              << "\n" << report.points.size() << " точек, " << config.folds << " фолдов. Время, мс: разбиение "
+              << report.timings.splitMs << ", модели " << report.timings.buildMs
+              << ", перебор " << report.timings.predictMs << ", всего " << report.timings.totalMs << "\n";
+    return 0;
+}
+
+/**
+ * @brief Подкоманда loo: leave-last-out с выборкой негативов, HR@K и NDCG@K.
+ *
+ * Использование: recsys loo <файл.csv> [--negatives N] [--k K] [--metric M] [--cutoffs 5,10,20]
+ *
+ * @return Код завершения.
+ */
+
+int runLeaveOneOut(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "[ОШИБКА] Использование: recsys loo <файл_данных.csv> [--negatives N] [--k K]"
+                     " [--metric cosine|pearson|jaccard|manhattan] [--cutoffs 5,10,20]\n";
+        return 1;
+    }
+
+    LeaveOneOut::Config config;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string flag = argv[i], value = argv[i + 1];
+        if (flag == "--negatives") config.negatives = std::stoi(value);
+        else if (flag == "--k") config.k = std::stoi(value);
+        else if (flag == "--metric") config.metric = parseMetric(value);
+        else if (flag == "--cutoffs") config.cutoffs = parseList<int>(value, [](const std::string& t) { return std::stoi(t); });
+        else {
+            std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<User> users;
+    std::vector<Item> items;
+    CSVLoader::load(argv[2], users, items, true);
+    std::cout << "[УСПЕХ] Загружено " << users.size() << " пользователей, " << items.size() << " товаров\n";
+
+    auto report = LeaveOneOut::run(users, config);
+    std::cout << "\n=== Leave-last-out, " << config.negatives << " негативов ===\n"
+              << "  Пользователей = " << report.users << " (пропущено " << report.skipped << ")\n"
+              << std::fixed << std::setprecision(4);
+    for (const auto& r : report.results) {
+        std::cout << "  HR@" << r.cutoff << " = " << r.hitRate << ", NDCG@" << r.cutoff << " = " << r.ndcg << "\n";
+    }
+    std::cout << std::setprecision(1)
+              << "  Время, мс: отбор " << report.timings.splitMs << ", модель " << report.timings.buildMs
+              << ", ранжирование " << report.timings.predictMs << ", всего " << report.timings.totalMs << "\n";
+    return 0;
+}
+
+/**
+ * @brief Подкоманда replay: проигрывание оценок по времени с предсказанием каждого окна.
+ *
+ * Использование: recsys replay <файл.csv> [--window-days D] [--model-days D]
+ * [--max-window N] [--k K] [--metric M] [--run-records N]
+ *
+ * @return Код завершения.
+ */
+
+int runReplay(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "[ОШИБКА] Использование: recsys replay <файл_данных.csv> [--window-days D]"
+                     " [--model-days D] [--max-window N] [--k K]"
+                     " [--metric cosine|pearson|jaccard|manhattan] [--run-records N]\n";
+        return 1;
+    }
+
+    ReplayEvaluation::Config config;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string flag = argv[i], value = argv[i + 1];
+        if (flag == "--window-days") config.windowSeconds = static_cast<long>(std::stod(value) * 86400.0);
+        else if (flag == "--model-days") config.modelWindowSeconds = static_cast<long>(std::stod(value) * 86400.0);
+        else if (flag == "--max-window") config.maxWindowRatings = std::stoul(value);
+        else if (flag == "--k") config.k = std::stoi(value);
+        else if (flag == "--metric") config.metric = parseMetric(value);
+        else if (flag == "--run-records") config.sort.runRecords = std::stoul(value);
+        else {
+            std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << "=== Проигрывание по времени ===\n"
+              << "  окно  оценок  предсказано     MAE    RMSE  в модели  оценок/с\n";
+    auto report = ReplayEvaluation::run(argv[2], config, [](const ReplayEvaluation::Window& w) {
+        std::cout << std::setw(6) << w.index << std::setw(8) << w.ratings << std::setw(13) << w.errors.count
+                  << std::fixed << std::setprecision(4)
+                  << std::setw(8) << w.errors.mae << std::setw(8) << w.errors.rmse
+                  << std::setw(10) << w.modelRatings
+                  << std::setprecision(0) << std::setw(10) << w.throughput() << "\n";
+    });
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "\n  Оценок = " << report.ratings << ", окон = " << report.windows.size()
+              << ", покрытие = " << report.coverage() << "\n"
+              << "  MAE = " << report.errors.mae << ", RMSE = " << report.errors.rmse << "\n"
+              << std::setprecision(1)
+              << "  Время, мс: чтение и сортировка " << report.loadMs << ", всего " << report.totalMs << "\n";
+    return 0;
+}
+
+/**
+ * @brief Подкоманда stats: разбивка памяти по структурам данных.
+ *
+ * Использование: recsys stats <файл.csv> [--corating] [--warm N] [--k K] [--metric M]
+ *
+ * --corating строит индекс общих оценок, --warm N заполняет кэши предсказаний
+ * гибридными рекомендациями для первых N пользователей.
+ *
+ * @return Код завершения.
+ */
+
+int runStats(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "[ОШИБКА] Использование: recsys stats <файл_данных.csv> [--corating] [--warm N] [--k K]"
+                     " [--metric cosine|pearson|jaccard|manhattan]\n";
+        return 1;
+    }
+
+    bool corating = false;
+    std::size_t warm = 0;
+    int k = 5;
+    Predictor::Metric metric = Predictor::Metric::Cosine;
+    for (int i = 3; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--corating") {
+            corating = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "[ОШИБКА] Нет значения для " << flag << "\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--warm") warm = std::stoul(value);
+        else if (flag == "--k") k = std::stoi(value);
+        else if (flag == "--metric") metric = parseMetric(value);
+        else {
+            std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<User> users;
+    std::vector<Item> items;
+    CSVLoader::load(argv[2], users, items, false);
+    Dataset dataset(std::move(users), std::move(items));
+    std::cout << "[УСПЕХ] Загружено " << dataset.users().size() << " пользователей, "
+              << dataset.items().size() << " товаров, " << dataset.ratingCount() << " оценок\n";
+
+    CoRatingIndex coRatings;
+    if (corating) coRatings.build(dataset.items());
+
+    Predictor::clearCache();
+    const std::size_t warmUsers = std::min(warm, dataset.users().size());
+    for (std::size_t u = 0; u < warmUsers; ++u) {
+        Recommender::recommendHybrid(dataset.users()[u].getId(), dataset.users(), dataset.items(), 10, k, metric, 0.5);
+    }
+
+    MemoryReport report;
+    dataset.reportMemory(report);
+    if (corating) report.add("co-rating index", coRatings.pairCount(), coRatings.memoryBytes());
+    Predictor::reportMemory(report);
+
+    std::cout << "\n=== Память по структурам (оценка) ===\n";
+    report.print(std::cout, MemoryReport::residentBytes());
+    return 0;
+}
+
+/**
+ * @brief Подкоманда serve: обслуживание строкового протокола запросов по TCP.
+ *
+ * Использование: recsys serve <файл.csv> [--port P] [--host H] [--k K] [--metric M] [--alpha A]
+ * [--metrics файл.prom] [--parallel-min N] [--reload S] [--budget-us B]
+ *
+ * С --metrics каждые 10 секунд снимок Instrumentation записывается в файл
+ * (через временный файл и rename), откуда его забирает сборщик метрик.
+ * С --reload S каждые S секунд проверяется время изменения CSV; изменённый
+ * файл загружается заново и публикуется как новая модель без остановки
+ * обслуживания (RecommendationService::update).
+ * --parallel-min N — с какого числа кандидатов TOPN и HYBRID оценивают
+ * их на нескольких потоках (Recommender::Parallelism).
+ * --budget-us B — срок TOPN и HYBRID по умолчанию: урезанные ради него
+ * ответы помечаются `OK DEGRADED` (Recommender::recommendWithDeadline).
+ *
+ * @return Код завершения.
+ */
+
+int runServe(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "[ОШИБКА] Использование: recsys serve <файл_данных.csv> [--port P] [--host H]"
+                     " [--k K] [--metric cosine|pearson|jaccard|manhattan] [--alpha A] [--metrics файл.prom]"
+                     " [--parallel-min N] [--reload S] [--budget-us B]\n";
+        return 1;
+    }
+
+    RecommendationService::Config config;
+    int port = 7070;
+    std::string host = "127.0.0.1";
+    std::string metricsPath;
+    int reloadSeconds = 0;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string flag = argv[i], value = argv[i + 1];
+        if (flag == "--port") port = std::stoi(value);
+        else if (flag == "--host") host = value;
+        else if (flag == "--k") config.k = std::stoi(value);
+        else if (flag == "--metric") config.metric = parseMetric(value);
+        else if (flag == "--alpha") config.alpha = std::stod(value);
+        else if (flag == "--metrics") metricsPath = value;
+        else if (flag == "--parallel-min") {
+            auto parallelism = Recommender::parallelism();
+            parallelism.minCandidates = std::stoull(value);
+            Recommender::setParallelism(parallelism);
+        }
+        else if (flag == "--reload") reloadSeconds = std::stoi(value);
+        else if (flag == "--budget-us") config.budgetMicros = std::stol(value);
+        else {
+            std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n";
+            return 1;
+        }
+    }
+    if (port < 0 || port > 65535) {
+        std::cerr << "[ОШИБКА] Некорректный порт: " << port << "\n";
+        return 1;
+    }
+
+    const std::string path = argv[2];
+    std::error_code error;
+    auto loadedAt = std::filesystem::last_write_time(path, error);
+    std::vector<User> users;
+    std::vector<Item> items;
+    CSVLoader::load(path, users, items, true);
+    std::cout << "[УСПЕХ] Загружено " << users.size() << " пользователей, " << items.size() << " товаров\n";
+
+    RecommendationService service(std::move(users), std::move(items), config);
+    TcpServer server(service, static_cast<std::uint16_t>(port), host);
+    server.start();
+    std::cout << "Слушаю " << host << ":" << server.port()
+              << " (PREDICT u i | TOPN u n | HYBRID u n | POPULAR n)\n" << std::flush;
+    for (long tick = 1;; ++tick) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        if (reloadSeconds > 0 && tick % reloadSeconds == 0) {
+            auto modified = std::filesystem::last_write_time(path, error);
+            if (!error && modified != loadedAt) {
+                try {
+                    std::vector<User> fresh;
+                    std::vector<Item> freshItems;
+                    CSVLoader::load(path, fresh, freshItems, false);
+                    const std::size_t userCount = fresh.size(), itemCount = freshItems.size();
+                    const auto version = service.update(std::move(fresh), std::move(freshItems));
+                    loadedAt = modified;
+                    std::cout << "[ОБНОВЛЕНИЕ] Модель v" << version << ": " << userCount << " пользователей, "
+                              << itemCount << " товаров\n" << std::flush;
+                } catch (const std::exception& e) {
+                    // Файл недоступен (например, подменяется): остаёмся на текущей модели
+                    std::cerr << "[ОШИБКА] Перезагрузка модели: " << e.what() << "\n";
+                }
+            }
+        }
+
+        if (metricsPath.empty() || tick % 10 != 0) continue;
+        const std::string tmp = metricsPath + ".tmp";
+        {
+            std::ofstream out(tmp);
+            Instrumentation::writeText(out, Instrumentation::snapshot());
+        }
+        std::rename(tmp.c_str(), metricsPath.c_str());
+    }
+}
+
+/**
+ * @brief Разбирает целое число > 0, занимающее всю строку.
+ * @return false, если строка не число, содержит лишние символы или число ≤ 0
+ */
+bool parsePositive(const std::string& text, long& value) {
+    std::size_t used = 0;
+    try {
+        value = std::stol(text, &used);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return used == text.size() && value > 0;
+}
+
+/**
+ * @brief Извлекает "--threads N" из argv (допустим с любой подкомандой) и задаёт размер общего пула.
+ *
+ * N — целое от 1 до 16 × число аппаратных потоков: больше не ускоряет,
+ * а огромное значение не дойдёт до выделения очередей пула.
+ *
+ * @return false, если N не число или вне диапазона
+ */
+bool applyThreadsFlag(int& argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) != "--threads") continue;
+        long threads = 0;
+        const long maxThreads = static_cast<long>(16 * hardwareThreads());
+        if (!parsePositive(argv[i + 1], threads) || threads > maxThreads) {
+            std::cerr << "[ОШИБКА] Число потоков должно быть от 1 до " << maxThreads << ": " << argv[i + 1] << "\n";
+            return false;
+        }
+        try {
+            ThreadPool::setGlobalThreads(static_cast<std::size_t>(threads));
+        } catch (const std::exception& e) {
+            std::cerr << "[ОШИБКА] " << e.what() << "\n";
+            return false;
+        }
+        for (int j = i; j + 2 <= argc; ++j) argv[j] = argv[j + 2];
+        argc -= 2;
+        break;
+    }
+    return true;
+}
+
+/**
+ * @class TraceSession
+ * @brief Записывает трассу этапов в файл на время жизни объекта (флаг --trace).
+ */
+class TraceSession {
+public:
+    /// Извлекает "--trace файл.json" из argv (допустим с любой подкомандой) и начинает запись.
+    TraceSession(int& argc, char* argv[]) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string(argv[i]) != "--trace") continue;
+            path_ = argv[i + 1];
+            for (int j = i; j + 2 <= argc; ++j) argv[j] = argv[j + 2];
+            argc -= 2;
+            break;
+        }
+        if (path_.empty()) return;
+        if (!Tracer::compiled) {
+            std::cerr << "[ПРЕДУПРЕЖДЕНИЕ] Сборка без RECSYS_TRACING, трасса будет пустой\n";
+        }
+        Tracer::start();
+    }
+
+    ~TraceSession() {
+        if (path_.empty()) return;
+        Tracer::stop();
+        std::ofstream out(path_);
+        if (!out) {
+            std::cerr << "[ОШИБКА] Не удалось открыть " << path_ << "\n";
+            return;
+        }
+        Tracer::writeJson(out);
+        std::cout << "\nТрасса (" << Tracer::eventCount() << " событий) записана в " << path_
+                  << "; открыть в https://ui.perfetto.dev\n";
+    }
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    std::string path_;
+};
+
 /**
  * @brief Основная точка входа в программу.
  *
@@ -47,7 +562,11 @@ void printRecommendations(const std::string& title, const std::vector<std::pair<
  * для него рекомендации разными методами.
  *
  * @param argc Количество аргументов командной строки.
- * @param argv Аргументы командной строки. argv[1] — путь к CSV-файлу.
+ * @param argv Аргументы командной строки. argv[1] — путь к CSV-файлу, далее
+ *             необязательные --window-days N, --folds K, --split random|user|temporal.
+ *             Если argv[1] == "sweep", "loo", "replay", "serve" или "stats", выполняется соответствующая подкоманда.
+ *             С любой подкомандой допускается --trace файл.json (Chrome trace-event)
+ *             и --threads N (размер общего пула потоков; по умолчанию — все аппаратные).
  * @return Код завершения: 0 — успех, 1 — ошибка.
  */
 
@@ -61,18 +580,98 @@ int main(int argc, char* argv[]) {
     std::cout << "     Система коллаборативных рекомендаций\n";
     std::cout << "==========================================\n\n";
 
+    if (!applyThreadsFlag(argc, argv)) return 1;
+    TraceSession trace(argc, argv);
+
     if (argc < 2) {
-        std::cerr << "[ОШИБКА] Использование: recsys <файл_данных.csv>\n";
+        std::cerr << "[ОШИБКА] Использование: recsys <файл_данных.csv> [--window-days N]"
+                     " [--folds K] [--split random|user|temporal] [--trace файл.json] [--threads N]\n"
+                     "              recsys sweep <файл_данных.csv> ...\n"
+                     "              recsys loo <файл_данных.csv> ...\n"
+                     "              recsys replay <файл_данных.csv> ...\n"
+                     "              recsys serve <файл_данных.csv> ...\n"
+                     "              recsys stats <файл_данных.csv> ...\n";
         return 1;
     }
 
+    const std::string command = argv[1];
+    if (command == "sweep" || command == "loo" || command == "replay" || command == "serve" ||
+        command == "stats") {
+        try {
+            if (command == "replay") return runReplay(argc, argv);
+            if (command == "serve") return runServe(argc, argv);
+            if (command == "stats") return runStats(argc, argv);
+            return command == "sweep" ? runSweep(argc, argv) : runLeaveOneOut(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << "[ОШИБКА] " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     std::string filename = argv[1];
+    long windowDays = 0;   // 0 — без окна
+    int folds = 5;
+    std::string splitName = "random";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--window-days") {
+            // Окно в секундах должно поместиться в long
+            if (!parsePositive(argv[i + 1], windowDays) || windowDays > std::numeric_limits<long>::max() / 86400) {
+                std::cerr << "[ОШИБКА] Некорректное число дней окна: " << argv[i + 1] << "\n";
+                return 1;
+            }
+        }
+        else if (flag == "--folds") {
+            // Диапазон CrossValidation::assignFolds
+            long value = 0;
+            if (!parsePositive(argv[i + 1], value) || value < 2 || value > 255) {
+                std::cerr << "[ОШИБКА] Число фолдов должно быть от 2 до 255: " << argv[i + 1] << "\n";
+                return 1;
+            }
+            folds = static_cast<int>(value);
+        }
+        else if (flag == "--split") splitName = argv[i + 1];
+        else {
+            std::cerr << "[ОШИБКА] Неизвестный параметр: " << flag << "\n";
+            return 1;
+        }
+    }
+
+    CrossValidation::Split split;
+    try {
+        split = parseSplit(splitName);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "[ОШИБКА] " << e.what() << "\n";
+        return 1;
+    }
     std::cout << "[ЗАГРУЗКА] Чтение данных из: " << filename << "\n";
 
     std::vector<User> users;
     std::vector<Item> items;
     CSVLoader::load(filename, users, items, true);
 
+    // Режим скользящего окна: учитываются только оценки за последние N дней
+    if (windowDays > 0) {
+        const long day = 86400;
+        long windowSeconds = windowDays * day;
+
+        std::vector<Rating> ratings;
+        for (const auto& u : users) {
+            for (const auto& [itemId, r] : u.getRatings()) ratings.push_back(r);
+        }
+        std::sort(ratings.begin(), ratings.end(),
+                  [](const Rating& a, const Rating& b) { return a.timestamp < b.timestamp; });
+
+        WindowedDataset window(windowSeconds, std::min(windowSeconds, day), false);
+        for (const auto& r : ratings) window.append(r);
+        if (!ratings.empty()) window.advanceTo(static_cast<long>(ratings.back().timestamp));
+
+        users = window.dataset().users();
+        items = window.dataset().items();
+        std::cout << "[ОКНО] Оставлено " << window.dataset().ratingCount() << " из "
+                  << ratings.size() << " оценок за последние " << windowDays << " дн.\n";
+    }
+
     std::cout << "[УСПЕХ] Загружено " << users.size() << " пользователей, " << items.size() << " товаров\n";
 
     if (users.empty()) {
@@ -108,48 +707,51 @@ int main(int argc, char* argv[]) {
         std::cout << "\n[USER-BASED] Рекомендации на основе схожих пользователей:\n";
         printRecommendations("Top-N (user-based):", userRecs);
 
-        std::unordered_map<int, std::unordered_map<int, double>> predictedUser;
-        for (const auto& [itemId, rating] : user->getRatings()) {
-            double pred = Predictor::predict(targetUserId, itemId, users, 2);
-            predictedUser[targetUserId][itemId] = pred;
-        }
-
-        std::cout << "\n=== Оценка user-based ===\n";
-        std::cout << "MAE  = " << Evaluation::computeMAE(users, predictedUser) << "\n";
-        std::cout << "RMSE = " << Evaluation::computeRMSE(users, predictedUser) << "\n";
-
         // --- ITEM-BASED ---
         auto itemRecs = Recommender::recommendItemBasedTopN(targetUserId, users, items, 3);
         std::cout << "\n[ITEM-BASED] Рекомендации на основе похожих товаров:\n";
         printRecommendations("Top-N (item-based):", itemRecs);
 
-        std::unordered_map<int, std::unordered_map<int, double>> predictedItem;
-        for (const auto& [itemId, rating] : user->getRatings()) {
-            double pred = Predictor::predictItemBased(targetUserId, itemId, users, items, 2);
-            predictedItem[targetUserId][itemId] = pred;
-        }
-
-        std::cout << "\n=== Оценка item-based ===\n";
-        std::cout << "MAE  = " << Evaluation::computeMAE(users, predictedItem) << "\n";
-        std::cout << "RMSE = " << Evaluation::computeRMSE(users, predictedItem) << "\n";
-
         // --- HYBRID ---
         auto hybridRecs = Recommender::recommendHybrid(targetUserId, users, items, 3, 2, Predictor::Metric::Cosine, 0.5);
         std::cout << "\n[HYBRID] Гибридная рекомендация (50% user + 50% item):\n";
         printRecommendations("Top-N (hybrid):", hybridRecs);
+    }
 
-        std::unordered_map<int, std::unordered_map<int, double>> predictedHybrid;
-        for (const auto& [itemId, rating] : user->getRatings()) {
-            double userPred = Predictor::predict(targetUserId, itemId, users, 2);
-            double itemPred = Predictor::predictItemBased(targetUserId, itemId, users, items, 2);
-            predictedHybrid[targetUserId][itemId] = 0.5 * userPred + 0.5 * itemPred;
-        }
-
-        std::cout << "\n=== Оценка hybrid ===\n";
-        std::cout << "MAE  = " << Evaluation::computeMAE(users, predictedHybrid) << "\n";
-        std::cout << "RMSE = " << Evaluation::computeRMSE(users, predictedHybrid) << "\n";
+    // Точность оценивается на отложенных оценках, а не на обучающих
+    std::cout << "\n=== Кросс-валидация (" << folds << " фолдов, разбиение " << splitName << ") ===\n";
+    const std::pair<const char*, CrossValidation::Algorithm> algorithms[] = {
+        {"user-based", CrossValidation::Algorithm::UserBased},
+        {"item-based", CrossValidation::Algorithm::ItemBased},
+        {"hybrid", CrossValidation::Algorithm::Hybrid},
+    };
+    for (const auto& [name, algorithm] : algorithms) {
+        CrossValidation::Config config;
+        config.split = split;
+        config.folds = folds;
+        config.algorithm = algorithm;
+        config.k = 2;
+        printReport(name, CrossValidation::run(users, config));
     }
 
+    // Качество top-N списков: релевантны отложенные оценки не ниже 4
+    const int topN = 10;
+    std::cout << "\n=== Ранжирование (top-" << topN << ", user-based) ===\n";
+    CrossValidation::Config rankingConfig;
+    rankingConfig.split = split;
+    rankingConfig.folds = folds;
+    rankingConfig.k = 2;
+    auto ranking = CrossValidation::runRanking(users, rankingConfig, topN);
+    std::cout << std::setprecision(4)
+              << "  Пользователей = " << ranking.metrics.users << "\n"
+              << "  Precision@" << topN << " = " << ranking.metrics.precision << "\n"
+              << "  Recall@" << topN << "    = " << ranking.metrics.recall << "\n"
+              << "  NDCG@" << topN << "      = " << ranking.metrics.ndcg << "\n"
+              << "  MAP@" << topN << "       = " << ranking.metrics.map << "\n"
+              << "  MRR          = " << ranking.metrics.mrr << "\n"
+              << std::setprecision(1)
+              << "  Время, мс: " << ranking.timings.totalMs << "\n";
+
     std::cout << "\n[ГОТОВО] Программа завершена успешно.\n";
     return 0;
 }
@@ -16,6 +16,19 @@ using namespace Catch;
 #include <DataHandler/CSVLoader.h>
 #include <Models/User.h>
 #include <Models/Item.h>
+#include <Models/Dataset.h>
+#include <DataHandler/WindowedDataset.h>
+#include <DataHandler/RatingIngestor.h>
+#include <DataHandler/RatingStore.h>
+#include <DataHandler/RatingSorter.h>
+#include <DataHandler/SyntheticGenerator.h>
+#include <cstdio>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <Algorithms/Predictor.h>
+#include <Algorithms/Similarity.h>
+#include <Utils/MemoryReport.h>
 
 using namespace recsys;
 
@@ -86,3 +99,346 @@ TEST_CASE("CSVLoader loads data correctly") {
         REQUIRE(i3.size() == 1);
     }
 }
+
+/**
+ * @brief Группа тестов: изменяемый набор данных Dataset
+ */
+TEST_CASE("Dataset upsert keeps users and items consistent") {
+    Dataset ds;
+
+    REQUIRE_FALSE(ds.upsert(Rating(1, 101, 4.0, 10)).has_value());
+    REQUIRE_FALSE(ds.upsert(Rating(2, 101, 2.0, 20)).has_value());
+
+    // Повторная оценка заменяет предыдущую, а не дублирует её в товаре
+    auto previous = ds.upsert(Rating(1, 101, 5.0, 30));
+    REQUIRE(previous.has_value());
+    REQUIRE(previous->score == Approx(4.0));
+    REQUIRE(ds.ratingCount() == 2);
+    REQUIRE(ds.findItem(101)->getRatingCount() == 2);
+    REQUIRE(ds.findItem(101)->getAverageRating() == Approx(3.5));
+    REQUIRE(ds.findUser(1)->getAverageRating() == Approx(5.0));
+
+    REQUIRE(ds.remove(2, 101).has_value());
+    REQUIRE_FALSE(ds.remove(2, 101).has_value());
+    REQUIRE(ds.findItem(101)->getAverageRating() == Approx(5.0));
+
+    REQUIRE_THROWS_AS(ds.upsert(Rating(3, 102, 7.0, 0)), std::invalid_argument);
+    REQUIRE(ds.findUser(3) == nullptr);
+}
+
+/**
+ * @brief Группа тестов: скользящее окно по времени
+ *
+ * Состояние окна после сдвига должно совпадать с набором,
+ * построенным с нуля только из оставшихся оценок.
+ */
+TEST_CASE("WindowedDataset expires old segments incrementally") {
+    const long day = 86400;
+    WindowedDataset window(2 * day, day);
+
+    std::vector<Rating> ratings = {
+        {1, 101, 5.0, 0 * day + 10}, {2, 101, 4.0, 0 * day + 20}, {1, 102, 3.0, 0 * day + 30},
+        {2, 102, 2.0, 1 * day + 10}, {3, 101, 1.0, 1 * day + 20}, {3, 102, 4.0, 2 * day + 10},
+        {1, 101, 2.0, 2 * day + 20}  // переоценка: должна пережить истечение дня 0
+    };
+    for (const auto& r : ratings) REQUIRE(window.append(r));
+    REQUIRE(window.segmentCount() == 3);
+
+    // Граница окна — начало дня 1: истекает сегмент дня 0
+    std::size_t removed = window.advanceTo(3 * day);
+    REQUIRE(removed == 2);
+    REQUIRE(window.segmentCount() == 2);
+    REQUIRE_FALSE(window.append(Rating(4, 101, 3.0, 10)));
+
+    const Dataset& ds = window.dataset();
+    REQUIRE(ds.ratingCount() == 4);
+    REQUIRE(ds.findRating(1, 101)->score == Approx(2.0));
+    REQUIRE(ds.findRating(2, 101) == nullptr);
+    REQUIRE(ds.findItem(101)->getAverageRating() == Approx((2.0 + 1.0) / 2));
+
+    CoRatingIndex rebuilt;
+    rebuilt.build(ds.items());
+    const CoRatingIndex* live = window.coRatings();
+    REQUIRE(live->pairCount() == rebuilt.pairCount());
+
+    for (const auto& a : ds.users()) {
+        for (const auto& b : ds.users()) {
+            if (a.getId() == b.getId()) continue;
+            REQUIRE(live->pearson(a, b) == Approx(rebuilt.pearson(a, b)).margin(1e-9));
+            REQUIRE(live->cosine(a, b) == Approx(Similarity::cosine(a, b)).margin(1e-9));
+            REQUIRE(live->jaccard(a, b) == Approx(Similarity::jaccard(a, b)).margin(1e-9));
+            REQUIRE(live->manhattan(a, b) == Approx(Similarity::manhattan(a, b)).margin(1e-9));
+        }
+    }
+}
+
+/**
+ * @brief Группа тестов: онлайн-приём оценок
+ *
+ * Проверяется, что новая оценка попадает в набор данных и суммы CoRatingIndex,
+ * а из кэша предсказаний сбрасываются только затронутые записи.
+ */
+TEST_CASE("RatingIngestor applies ratings and invalidates affected predictions") {
+    Predictor::clearCache();
+
+    Dataset ds;
+    for (const auto& r : std::vector<Rating>{
+             {1, 101, 5.0, 0}, {1, 102, 3.0, 0},
+             {2, 101, 4.0, 0}, {2, 103, 5.0, 0},
+             {7, 201, 4.0, 0}, {8, 201, 5.0, 0}, {8, 202, 3.0, 0}}) {
+        ds.upsert(r);
+    }
+    CoRatingIndex coRatings;
+    coRatings.build(ds.items());
+
+    PredictionCache userCache;
+    PredictionCache itemCache;
+    RatingIngestor ingestor(ds, &coRatings, &userCache, &itemCache);
+
+    // Кэшируем предсказания двух независимых групп пользователей
+    userCache.insert({1, 103, 0}, 5.0);
+    userCache.insert({7, 202, 0}, 3.0);
+    itemCache.insert({7, 202, 5}, 3.0);
+
+    // Пользователь 2 меняет оценку item 101: группа (1, 2) затронута, (7, 8) — нет
+    REQUIRE(ingestor.apply(Rating(2, 101, 1.0, 10)));
+    REQUIRE_FALSE(ingestor.apply(Rating(2, 101, 1.0, 20)));
+
+    REQUIRE_FALSE(userCache.find({1, 103, 0}).has_value());
+    REQUIRE(userCache.find({7, 202, 0}).has_value());
+    REQUIRE(itemCache.find({7, 202, 5}).has_value());
+
+    {
+        auto lock = ingestor.readLock();
+        const Dataset& live = ingestor.dataset();
+        REQUIRE(live.findRating(2, 101)->score == Approx(1.0));
+        REQUIRE(live.findItem(101)->getAverageRating() == Approx(3.0));
+
+        CoRatingIndex rebuilt;
+        rebuilt.build(live.items());
+        auto s = coRatings.find(1, 2);
+        REQUIRE(s.has_value());
+        REQUIRE(s->sumAB == Approx(rebuilt.find(1, 2)->sumAB));
+    }
+
+    // Пачка с некорректной оценкой: корректные применяются, некорректная пропускается
+    std::vector<Rating> batch = {{9, 201, 2.0, 30}, {9, 202, 9.0, 30}, {7, 202, 1.0, 30}};
+    REQUIRE(ingestor.applyBatch(batch) == 2);
+    REQUIRE_FALSE(userCache.find({7, 202, 0}).has_value());
+    REQUIRE_FALSE(itemCache.find({7, 202, 5}).has_value());
+
+    REQUIRE(ingestor.remove(9, 201));
+    REQUIRE(coRatings.find(8, 9) == std::nullopt);
+    REQUIRE(ingestor.stats().applied == 3);
+    REQUIRE(ingestor.stats().removed == 1);
+}
+
+/**
+ * @brief Группа тестов: журнал оценок и компактация
+ *
+ * Проверяется восстановление «база + журнал», отбрасывание оборванного хвоста
+ * и слияние журнала в новый базовый файл.
+ */
+TEST_CASE("RatingStore replays log over base and compacts it") {
+    const std::string base = "store_test.csv";
+    std::remove(base.c_str());
+    std::remove(RatingStore::logPath(base).c_str());
+    std::remove(RatingStore::sealedPath(base).c_str());
+
+    {
+        std::ofstream f(base);
+        f << "userId,itemId,rating,timestamp\n";
+        f << "1,101,5.0,100\n";
+        f << "2,101,3.0,100\n";
+    }
+
+    RatingStore::Options options;
+    options.background = false;
+
+    {
+        RatingStore store(base, options);
+        store.recordUpsert(Rating(1, 102, 4.5, 200));
+        store.recordUpsert(Rating(2, 101, 1.0, 200));
+        store.recordRemove(1, 101);
+        store.sync();
+    }
+
+    // Имитация сбоя посреди записи: неполная запись в конце журнала
+    {
+        std::ofstream wal(RatingStore::logPath(base), std::ios::binary | std::ios::app);
+        wal << "torn";
+    }
+
+    Dataset restored = RatingStore::load(base);
+    REQUIRE(restored.ratingCount() == 2);
+    REQUIRE(restored.findRating(1, 101) == nullptr);
+    REQUIRE(restored.findRating(1, 102)->score == Approx(4.5));
+    REQUIRE(restored.findRating(2, 101)->score == Approx(1.0));
+
+    {
+        // Повторное открытие отрезает хвост, новые записи читаются
+        RatingStore store(base, options);
+        store.recordUpsert(Rating(3, 103, 2.0, 300));
+        store.sync();
+        REQUIRE(RatingStore::load(base).ratingCount() == 3);
+
+        REQUIRE(store.compact());
+        REQUIRE_FALSE(store.compact());
+        REQUIRE(store.compactions() == 1);
+    }
+
+    std::size_t remaining = RatingLog::replay(RatingStore::logPath(base), [](const RatingEvent&) {});
+    REQUIRE(remaining == 0);
+
+    std::vector<User> users;
+    std::vector<Item> items;
+    CSVLoader::load(base, users, items, false);
+    Dataset fromBase(users, items);
+    REQUIRE(fromBase.ratingCount() == 3);
+    REQUIRE(fromBase.findRating(2, 101)->score == Approx(1.0));
+    REQUIRE(fromBase.findRating(3, 103)->timestamp == 300);
+
+    std::remove(base.c_str());
+    std::remove(RatingStore::logPath(base).c_str());
+    std::remove(RatingStore::sealedPath(base).c_str());
+}
+
+/**
+ * @test Внешняя сортировка: прогоны сбрасываются на диск и сливаются по времени,
+ * равные метки остаются в порядке добавления; после слияния сортировщик пуст.
+ */
+TEST_CASE("RatingSorter merges spilled runs in timestamp order") {
+    RatingSorter::Options options;
+    options.runRecords = 7;
+    options.tempDir = ".";
+    RatingSorter sorter(options);
+
+    // Метки убывают по кругу, у каждой по несколько оценок: проверяется и устойчивость
+    const int count = 50;
+    for (int i = 0; i < count; ++i) {
+        sorter.add(Rating(i, 100 + i, 1.0 + i % 5, 1000 - (i % 10) * 10));
+    }
+    REQUIRE(sorter.size() == count);
+    REQUIRE(sorter.runs() == count / 7);
+
+    std::vector<Rating> out;
+    REQUIRE(sorter.merge([&](const Rating& r) { out.push_back(r); }) == count);
+    REQUIRE(out.size() == count);
+    for (std::size_t i = 1; i < out.size(); ++i) {
+        REQUIRE(out[i - 1].timestamp <= out[i].timestamp);
+        if (out[i - 1].timestamp == out[i].timestamp) REQUIRE(out[i - 1].userId < out[i].userId);
+    }
+    REQUIRE(sorter.size() == 0);
+    REQUIRE(sorter.runs() == 0);
+}
+
+/**
+ * @test Синтетические оценки: объёмы и диапазоны как в конфигурации, популярность
+ * по Ципфу, одинаковый файл при любом числе потоков, CSV и бинарный журнал читаются.
+ */
+TEST_CASE("SyntheticGenerator is deterministic and skewed") {
+    SyntheticGenerator::Config config;
+    config.users = 300;
+    config.items = 200;
+    config.ratings = 6000;
+    config.seed = 7;
+    SyntheticGenerator generator(config);
+    REQUIRE(generator.totalRatings() == Approx(6000).epsilon(0.02));
+
+    std::vector<User> users;
+    std::vector<Item> items;
+    generator.build(users, items);
+    REQUIRE(users.size() == 300);
+
+    std::size_t total = 0;
+    for (std::size_t u = 0; u < users.size(); ++u) {
+        // Товары пользователя без повторов, число — как обещано
+        REQUIRE(users[u].getRatings().size() == generator.ratingsOf(u));
+        total += users[u].getRatings().size();
+        for (const auto& [itemId, r] : users[u].getRatings()) {
+            REQUIRE(r.score >= 1.0);
+            REQUIRE(r.score <= 5.0);
+            REQUIRE(r.timestamp >= config.startTime);
+            REQUIRE(r.timestamp < config.startTime + config.spanSeconds);
+        }
+    }
+    REQUIRE(total == generator.totalRatings());
+
+    // Популярность по Ципфу: самый популярный товар намного популярнее медианного
+    std::vector<int> popularity;
+    for (const auto& item : items) popularity.push_back(item.getRatingCount());
+    std::sort(popularity.rbegin(), popularity.rend());
+    REQUIRE(popularity.front() > 4 * popularity[popularity.size() / 2]);
+
+    // Тот же seed и любое число потоков дают тот же файл
+    generator.writeCsv("synthetic_a.csv", 1);
+    SyntheticGenerator(config).writeCsv("synthetic_b.csv", 4);
+    std::ifstream a("synthetic_a.csv"), b("synthetic_b.csv");
+    std::string textA((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+    std::string textB((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+    REQUIRE(textA == textB);
+
+    std::vector<User> loaded;
+    std::vector<Item> loadedItems;
+    CSVLoader::load("synthetic_a.csv", loaded, loadedItems, false);
+    REQUIRE(loaded.size() == users.size());
+    REQUIRE(loaded.front().getRatings().size() == users.front().getRatings().size());
+
+    REQUIRE(generator.writeBinary("synthetic.bin") == total);
+    REQUIRE(RatingLog::replay("synthetic.bin", [](const RatingEvent&) {}) == total);
+
+    std::remove("synthetic_a.csv");
+    std::remove("synthetic_b.csv");
+    std::remove("synthetic.bin");
+}
+
+/**
+ * @test Учёт памяти: модель блоков кучи, разбивка Dataset, рост и сброс кэша предсказаний.
+ */
+TEST_CASE("MemoryReport breaks down bytes per structure") {
+    REQUIRE(MemoryReport::heapBlock(0) == 0);
+    REQUIRE(MemoryReport::heapBlock(1) == 32);
+    REQUIRE(MemoryReport::heapBlock(24) == 32);
+    REQUIRE(MemoryReport::heapBlock(25) == 48);
+
+    SyntheticGenerator::Config config;
+    config.users = 50;
+    config.items = 30;
+    config.density = 0.2;
+    std::vector<User> users;
+    std::vector<Item> items;
+    SyntheticGenerator(config).build(users, items);
+    Dataset dataset(users, items);
+
+    MemoryReport report;
+    dataset.reportMemory(report);
+    REQUIRE(report.entries().size() == 6);
+    REQUIRE(report.find("user ratings")->entries == dataset.ratingCount());
+    REQUIRE(report.find("item ratings")->entries == dataset.ratingCount());
+    REQUIRE(report.find("user id map")->entries == 50);
+    // Узел хеш-таблицы с оценкой не меньше самой оценки
+    REQUIRE(report.find("user ratings")->bytes >= dataset.ratingCount() * sizeof(Rating));
+    REQUIRE(report.find("items")->bytes >= 30 * sizeof(Item));
+    REQUIRE(report.total() > report.find("user ratings")->bytes);
+    REQUIRE(report.find("missing") == nullptr);
+
+    dataset.upsert(Rating(1000, 1000, 4.0, 0));
+    MemoryReport grown;
+    dataset.reportMemory(grown);
+    REQUIRE(grown.find("user ratings")->bytes > report.find("user ratings")->bytes);
+
+    PredictionCache cache(4);
+    const std::size_t empty = cache.memoryBytes();
+    for (int u = 0; u < 20; ++u) {
+        for (int i = 0; i < 10; ++i) cache.insert({u, i, 0}, 1.0);
+    }
+    const std::size_t filled = cache.memoryBytes();
+    REQUIRE(filled > empty + 200 * sizeof(double));
+    cache.clear();
+    REQUIRE(cache.memoryBytes() < filled);
+
+    MemoryReport caches;
+    Predictor::reportMemory(caches);
+    REQUIRE(caches.find("user-based prediction cache") != nullptr);
+    REQUIRE(caches.find("decay tables") != nullptr);
+}
@@ -8,6 +8,18 @@
 #include <Models/User.h>
 #include <Models/Item.h>
 #include <DataHandler/CSVLoader.h>
+#include <Algorithms/CrossValidation.h>
+#include <Algorithms/RankingMetrics.h>
+#include <Algorithms/HyperparameterSweep.h>
+#include <Algorithms/LeaveOneOut.h>
+#include <Algorithms/ReplayEvaluation.h>
+#include <Algorithms/Predictor.h>
+#include <Utils/LatencyHistogram.h>
+#include <Utils/Parallel.h>
+#include <Utils/ThreadPool.h>
+#include <atomic>
+#include <cmath>
+#include <limits>
 
 using namespace Catch;
 using namespace recsys;
@@ -55,3 +67,422 @@ TEST_CASE("Evaluation metrics compute correctly") {
         REQUIRE(rmse == Approx(std::sqrt(0.25)));
     }
 }
+
+/**
+ * @brief Набор пользователей со схожими профилями для кросс-валидации.
+ *
+ * Пользователь u оценивает товары 1..10 оценкой 1 + (u + i) % 5 с меткой времени u·10 + i.
+ */
+static std::vector<User> makeCrossValidationUsers(int count) {
+    std::vector<User> users;
+    for (int u = 1; u <= count; ++u) {
+        User user(u);
+        for (int i = 1; i <= 10; ++i) {
+            user.addRating(Rating(u, i, 1.0 + (u + i) % 5, u * 10 + i));
+        }
+        users.push_back(user);
+    }
+    return users;
+}
+
+/**
+ * @test Разбиения: фолды равного размера, оценки пользователя распределены
+ * по фолдам, временные отрезки упорядочены по времени.
+ */
+TEST_CASE("Cross-validation assigns folds") {
+    auto users = makeCrossValidationUsers(12);
+    RatingView view = RatingView::of(users);
+    REQUIRE(view.size() == 120);
+    REQUIRE(view.userOffsets.size() == users.size() + 1);
+
+    SECTION("Random split is balanced") {
+        auto ids = CrossValidation::assignFolds(view, CrossValidation::Split::Random, 4, 7);
+        std::vector<int> sizes(4, 0);
+        for (auto id : ids) sizes[id]++;
+        for (int s : sizes) REQUIRE(s == 30);
+    }
+
+    SECTION("Per-user split spreads every profile") {
+        auto ids = CrossValidation::assignFolds(view, CrossValidation::Split::PerUser, 5, 7);
+        for (std::size_t j = 0; j < users.size(); ++j) {
+            std::vector<int> sizes(5, 0);
+            for (std::size_t r = view.userOffsets[j]; r < view.userOffsets[j + 1]; ++r) sizes[ids[r]]++;
+            for (int s : sizes) REQUIRE(s == 2);
+        }
+    }
+
+    SECTION("Temporal split tests on later ratings") {
+        auto ids = CrossValidation::assignFolds(view, CrossValidation::Split::Temporal, 3, 0);
+        for (std::size_t a = 0; a < view.size(); ++a) {
+            for (std::size_t b = 0; b < view.size(); ++b) {
+                if (ids[a] < ids[b]) REQUIRE(view.ratings[a]->timestamp <= view.ratings[b]->timestamp);
+            }
+        }
+        REQUIRE(CrossValidation::isTrain(0, 0, CrossValidation::Split::Temporal));
+        REQUIRE(CrossValidation::isTest(1, 0, CrossValidation::Split::Temporal));
+        REQUIRE_FALSE(CrossValidation::isTrain(2, 1, CrossValidation::Split::Temporal));
+    }
+
+    SECTION("Invalid fold count is rejected") {
+        REQUIRE_THROWS_AS(CrossValidation::assignFolds(view, CrossValidation::Split::Random, 1, 0),
+                          std::invalid_argument);
+    }
+}
+
+/**
+ * @test Кросс-валидация: метрики совпадают с прямым расчётом через Predictor
+ * на обучающей части и не зависят от числа потоков.
+ */
+TEST_CASE("Cross-validation matches direct prediction") {
+    auto users = makeCrossValidationUsers(8);
+
+    CrossValidation::Config config;
+    config.split = CrossValidation::Split::PerUser;
+    config.folds = 5;
+    config.k = 3;
+    config.threads = 1;
+    auto serial = CrossValidation::run(users, config);
+
+    REQUIRE(serial.folds.size() == 5);
+    REQUIRE(serial.testSize == 80);
+    for (const auto& f : serial.folds) REQUIRE(f.trainSize + f.testSize == 80);
+
+    // Прямой расчёт для фолда 0
+    RatingView view = RatingView::of(users);
+    auto ids = CrossValidation::assignFolds(view, config.split, config.folds, config.seed);
+    std::vector<User> train;
+    for (std::size_t j = 0; j < users.size(); ++j) {
+        User u(users[j].getId());
+        for (std::size_t r = view.userOffsets[j]; r < view.userOffsets[j + 1]; ++r) {
+            if (ids[r] != 0) u.addRating(*view.ratings[r]);
+        }
+        train.push_back(u);
+    }
+    Predictor::Options noCache;
+    noCache.useCache = false;
+    double sumAbs = 0.0;
+    std::size_t predicted = 0;
+    for (std::size_t r = 0; r < view.size(); ++r) {
+        if (ids[r] != 0) continue;
+        double p = Predictor::predict(view.ratings[r]->userId, view.ratings[r]->itemId, train, 3,
+                                      Predictor::Metric::Cosine, noCache);
+        if (p <= 0.0) continue;
+        sumAbs += std::abs(view.ratings[r]->score - p);
+        ++predicted;
+    }
+    REQUIRE(serial.folds[0].predicted == predicted);
+    REQUIRE(serial.folds[0].mae == Approx(sumAbs / predicted));
+
+    config.threads = 4;
+    auto parallel = CrossValidation::run(users, config);
+    REQUIRE(parallel.mae == serial.mae);
+    REQUIRE(parallel.rmse == serial.rmse);
+    REQUIRE(parallel.predicted == serial.predicted);
+}
+
+/**
+ * @test Метрики ранжирования на вручную посчитанном примере.
+ *
+ * Пользователь 1: список (10, 20, 30), релевантны {20, 40} — попадание на позиции 2.
+ * Пользователь 2: список (50, 60), релевантен {50} — попадание на позиции 1.
+ * Пользователь 3: релевантных нет — в усреднение не входит.
+ */
+TEST_CASE("Ranking metrics are computed at cutoff K") {
+    std::vector<std::vector<std::pair<int, double>>> topN = {
+        {{10, 5.0}, {20, 4.0}, {30, 3.0}},
+        {{50, 4.5}, {60, 4.0}},
+        {{70, 5.0}},
+    };
+    std::vector<std::vector<int>> relevant = {{20, 40}, {50}, {}};
+
+    auto r = RankingMetrics::evaluate(topN, relevant, 3, 2);
+    const double discount2 = 1.0 / std::log2(3.0);
+
+    REQUIRE(r.users == 2);
+    REQUIRE(r.precision == Approx((1.0 / 3 + 1.0 / 3) / 2));
+    REQUIRE(r.recall == Approx((0.5 + 1.0) / 2));
+    REQUIRE(r.ndcg == Approx((discount2 / (1.0 + discount2) + 1.0) / 2));
+    REQUIRE(r.map == Approx((0.5 / 2 + 1.0) / 2));
+    REQUIRE(r.mrr == Approx((0.5 + 1.0) / 2));
+
+    REQUIRE_THROWS_AS(RankingMetrics::evaluate(topN, relevant, 0), std::invalid_argument);
+}
+
+/**
+ * @test Ранжирующая кросс-валидация детерминирована и не зависит от числа потоков.
+ */
+TEST_CASE("Ranking cross-validation is thread-count independent") {
+    auto users = makeCrossValidationUsers(10);
+
+    CrossValidation::Config config;
+    config.split = CrossValidation::Split::PerUser;
+    config.k = 3;
+    config.threads = 1;
+    auto serial = CrossValidation::runRanking(users, config, 3, 4.0);
+
+    REQUIRE(serial.folds.size() == 5);
+    REQUIRE(serial.metrics.users > 0);
+    REQUIRE(serial.metrics.precision >= 0.0);
+    REQUIRE(serial.metrics.ndcg <= 1.0);
+
+    config.threads = 3;
+    auto parallel = CrossValidation::runRanking(users, config, 3, 4.0);
+    REQUIRE(parallel.metrics.users == serial.metrics.users);
+    REQUIRE(parallel.metrics.ndcg == serial.metrics.ndcg);
+    REQUIRE(parallel.metrics.map == serial.metrics.map);
+}
+
+/**
+ * @test Плоские буферы: записи и столбцы дают те же MAE/RMSE, что и словарь,
+ * NaN пропускается, результат не зависит от числа потоков.
+ */
+TEST_CASE("Evaluation computes errors from flat buffers") {
+    std::vector<User> users;
+    std::unordered_map<int, std::unordered_map<int, double>> nested;
+    std::vector<PredictionRecord> records;
+    std::vector<double> predicted, actual;
+
+    for (int u = 0; u < 50; ++u) {
+        User user(u + 1);
+        for (int i = 0; i < 40; ++i) {
+            double score = 1.0 + (u * 7 + i) % 5;
+            double pred = 1.0 + ((u + i * 3) % 9) * 0.5;
+            user.addRating(Rating(u + 1, i + 1, score, 0));
+            nested[u + 1][i + 1] = pred;
+            records.push_back({static_cast<std::uint32_t>(u), static_cast<std::uint32_t>(i), pred, score});
+            predicted.push_back(pred);
+            actual.push_back(score);
+        }
+        users.push_back(user);
+    }
+
+    auto fromRecords = Evaluation::computeErrors(records, 1);
+    REQUIRE(fromRecords.count == 2000);
+    REQUIRE(fromRecords.mae == Approx(Evaluation::computeMAE(users, nested)));
+    REQUIRE(fromRecords.rmse == Approx(Evaluation::computeRMSE(users, nested)));
+
+    auto fromColumns = Evaluation::computeErrors(predicted, actual, 4);
+    REQUIRE(fromColumns.mae == fromRecords.mae);
+    REQUIRE(fromColumns.rmse == fromRecords.rmse);
+    REQUIRE(fromColumns.bias == fromRecords.bias);
+
+    predicted[0] = std::numeric_limits<double>::quiet_NaN();
+    auto withGap = Evaluation::computeErrors(predicted, actual);
+    REQUIRE(withGap.count == 1999);
+
+    actual.pop_back();
+    REQUIRE_THROWS_AS(Evaluation::computeErrors(predicted, actual), std::invalid_argument);
+}
+
+/**
+ * @test Перебор сетки совпадает с отдельными прогонами кросс-валидации.
+ */
+TEST_CASE("Hyperparameter sweep matches individual cross-validation runs") {
+    auto users = makeCrossValidationUsers(12);
+
+    CrossValidation::Config config;
+    config.split = CrossValidation::Split::PerUser;
+    config.threads = 2;
+
+    HyperparameterSweep::Grid grid;
+    grid.metrics = {Predictor::Metric::Cosine, Predictor::Metric::Pearson};
+    grid.ks = {5, 1, 3};
+    grid.alphas = {0.0, 1.0, 0.5};
+    auto sweep = HyperparameterSweep::run(users, config, grid);
+
+    REQUIRE(sweep.points.size() == 18);
+    for (const auto& point : sweep.points) {
+        CrossValidation::Config single = config;
+        single.metric = point.metric;
+        single.k = point.k;
+        single.alpha = point.alpha;
+        single.algorithm = point.alpha == 1.0 ? CrossValidation::Algorithm::UserBased
+                         : point.alpha == 0.0 ? CrossValidation::Algorithm::ItemBased
+                         : CrossValidation::Algorithm::Hybrid;
+        auto report = CrossValidation::run(users, single);
+
+        REQUIRE(point.errors.count == report.predicted);
+        REQUIRE(point.errors.mae == Approx(report.mae));
+        REQUIRE(point.errors.rmse == Approx(report.rmse));
+    }
+
+    grid.ks = {0};
+    REQUIRE_THROWS_AS(HyperparameterSweep::run(users, config, grid), std::invalid_argument);
+}
+
+/**
+ * @test Leave-last-out: откладывается последняя оценка, негативы не пересекаются
+ * с оценёнными товарами, результат не зависит от числа потоков.
+ */
+TEST_CASE("Leave-one-out ranks the latest rating against sampled negatives") {
+    // Две группы пользователей с непересекающимися вкусами. Каждый оценил
+    // три «поздних» товара своей группы; самый поздний у соседей оценён раньше,
+    // поэтому после откладывания он остаётся в модели у них
+    std::vector<User> users;
+    for (int u = 1; u <= 20; ++u) {
+        User user(u);
+        int base = u <= 10 ? 0 : 100;
+        for (int i = 1; i <= 5; ++i) user.addRating(Rating(u, base + i, 5.0, i));
+        for (int x = 0; x < 3; ++x) {
+            user.addRating(Rating(u, base + 10 + x, 5.0, x == u % 3 ? 100 : 50));
+        }
+        users.push_back(user);
+    }
+    // Пользователь 1 оценил почти весь каталог: негативы выбираются перечислением
+    for (int i = 200; i < 240; ++i) users[0].addRating(Rating(1, i, 1.0, 0));
+
+    LeaveOneOut::Config config;
+    config.negatives = 20;
+    config.cutoffs = {1, 5};
+    config.k = 3;
+    config.threads = 1;
+    auto serial = LeaveOneOut::run(users, config);
+
+    REQUIRE(serial.users == 20);
+    REQUIRE(serial.skipped == 0);
+    REQUIRE(serial.results.size() == 2);
+    REQUIRE(serial.results[0].hitRate == Approx(1.0));
+    REQUIRE(serial.results[1].ndcg == Approx(1.0));
+
+    config.threads = 4;
+    auto parallel = LeaveOneOut::run(users, config);
+    REQUIRE(parallel.results[0].hitRate == serial.results[0].hitRate);
+    REQUIRE(parallel.results[1].ndcg == serial.results[1].ndcg);
+
+    config.negatives = 0;
+    REQUIRE_THROWS_AS(LeaveOneOut::run(users, config), std::invalid_argument);
+}
+
+/**
+ * @test Проигрывание по времени: окно предсказывается по модели из предыдущих окон,
+ * а горизонт модели забывает оценки старше себя.
+ */
+TEST_CASE("Replay predicts each window before ingesting it") {
+    const long day = 86400;
+    ReplayEvaluation::Config config;
+    config.windowSeconds = day;
+    config.k = 3;
+    config.threads = 2;
+    config.sort.runRecords = 4;
+    config.sort.tempDir = ".";
+
+    // День 0: все оценивают товары 10 и 11 одинаково; день 1: пользователи 1–3
+    // ставят товару 12 оценку 4; день 2: пользователь 4 ставит ему 2.
+    // Оценки добавляются в обратном порядке, чтобы сортировка что-то делала.
+    auto fill = [&](RatingSorter& sorter) {
+        sorter.add(Rating(4, 12, 2.0, 2 * day + 4));
+        for (int u = 3; u >= 1; --u) sorter.add(Rating(u, 12, 4.0, day + u));
+        for (int u = 4; u >= 1; --u) {
+            sorter.add(Rating(u, 11, 5.0, u));
+            sorter.add(Rating(u, 10, 3.0, u));
+        }
+    };
+
+    RatingSorter sorter(config.sort);
+    fill(sorter);
+    REQUIRE(sorter.runs() > 1);
+
+    std::vector<std::size_t> seen;
+    auto report = ReplayEvaluation::run(sorter, config, [&](const ReplayEvaluation::Window& w) {
+        seen.push_back(w.index);
+    });
+
+    REQUIRE(seen == std::vector<std::size_t>{0, 1, 2});
+    REQUIRE(report.ratings == 12);
+    REQUIRE(report.windows[0].errors.count == 0);   // холодный старт
+    REQUIRE(report.windows[1].errors.count == 0);   // товар 12 ещё никто не оценил
+    REQUIRE(report.windows[2].errors.count == 1);   // предсказано по дню 1, до приёма дня 2
+    REQUIRE(report.windows[2].errors.mae == Approx(2.0));
+    REQUIRE(report.windows[2].modelRatings == 12);
+    REQUIRE(report.errors.count == 1);
+
+    // Модель с горизонтом в один день уже забыла профиль пользователя 4
+    config.modelWindowSeconds = day;
+    RatingSorter again(config.sort);
+    fill(again);
+    auto windowed = ReplayEvaluation::run(again, config);
+    REQUIRE(windowed.windows.size() == 3);
+    REQUIRE(windowed.errors.count == 0);
+    REQUIRE(windowed.windows[2].modelRatings < 12);
+}
+
+/**
+ * @test Процентили гистограммы задержек: точны для малых значений, относительная погрешность < 1/64.
+ */
+TEST_CASE("LatencyHistogram percentiles are bounded by bucket precision") {
+    LatencyHistogram h;
+    REQUIRE(h.percentile(0.99) == 0);
+    for (std::uint64_t v = 1; v <= 100; ++v) h.record(v);
+    REQUIRE(h.count() == 100);
+    REQUIRE(h.min() == 1);
+    REQUIRE(h.max() == 100);
+    REQUIRE(h.percentile(0.5) == 50);
+    REQUIRE(h.percentile(0.99) == 99);
+    REQUIRE(h.mean() == Approx(50.5));
+
+    LatencyHistogram other;
+    for (std::uint64_t i = 0; i < 900; ++i) other.record(1000000 + i * 1000);
+    h.merge(other);
+    REQUIRE(h.count() == 1000);
+    const double p999 = static_cast<double>(h.percentile(0.999));
+    const double exact = 1000000.0 + 898 * 1000.0;
+    REQUIRE(p999 >= exact);
+    REQUIRE(p999 <= exact * (1.0 + 1.0 / 64.0));
+    REQUIRE(h.percentile(1.0) == h.max());
+
+    h.reset();
+    REQUIRE(h.count() == 0);
+}
+
+/**
+ * @test Пул потоков: результаты и исключения через future, вложенные задачи,
+ * parallelFor/parallelForRange обходят каждый индекс ровно один раз,
+ * parallelReduce не зависит от числа потоков.
+ */
+TEST_CASE("ThreadPool runs tasks and parallel loops") {
+    ThreadPool pool(3);
+    REQUIRE(pool.size() == 3);
+    REQUIRE(pool.currentWorker() == -1);
+
+    auto answer = pool.submit([] { return 42; });
+    auto failed = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    auto nested = pool.submit([&pool] {
+        return pool.currentWorker() >= 0 ? pool.submit([] { return 7; }).get() : -1;
+    });
+    REQUIRE(answer.get() == 42);
+    REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+    REQUIRE(nested.get() == 7);
+
+    constexpr std::size_t n = 10000;
+    std::vector<std::atomic<int>> seen(n);
+    parallelFor(n, [&](std::size_t i) { seen[i]++; }, 4);
+    std::atomic<bool> oversized{false};
+    parallelForRange(n, 64, [&](std::size_t begin, std::size_t end) {
+        if (end - begin > 64) oversized = true;
+        for (std::size_t i = begin; i < end; ++i) seen[i]++;
+    }, 4);
+    REQUIRE_FALSE(oversized.load());
+    for (const auto& s : seen) REQUIRE(s.load() == 2);
+
+    // Вложенный цикл из цикла не ждёт свободного рабочего
+    std::atomic<int> inner{0};
+    parallelFor(8, [&](std::size_t) { parallelFor(8, [&](std::size_t) { inner++; }, 4); }, 4);
+    REQUIRE(inner.load() == 64);
+
+    auto sum = [&](std::size_t threads) {
+        return parallelReduce(n, 100, 0.0,
+                              [](std::size_t begin, std::size_t end) {
+                                  double s = 0.0;
+                                  for (std::size_t i = begin; i < end; ++i) s += 1.0 / (1.0 + static_cast<double>(i));
+                                  return s;
+                              },
+                              [](double a, double b) { return a + b; }, threads);
+    };
+    REQUIRE(sum(1) == sum(4));
+    REQUIRE(parallelReduce(0, 16, 5, [](std::size_t, std::size_t) { return 1; },
+                           [](int a, int b) { return a + b; }) == 5);
+
+    REQUIRE_THROWS_AS(parallelFor(100, [](std::size_t i) {
+        if (i == 37) throw std::invalid_argument("bad index");
+    }, 4), std::invalid_argument);
+}
@@ -17,6 +17,15 @@ using namespace Catch;
 #include "../src/Models/Rating.h"
 #include "../src/Algorithms/Similarity.h"
 #include "../src/Algorithms/Predictor.h"
+#include "../src/Algorithms/Recommender.h"
+#include "../src/Algorithms/BatchSimilarity.h"
+#include "../src/DataHandler/SyntheticGenerator.h"
+#include "../src/Models/Item.h"
+#include "../src/Utils/Instrumentation.h"
+#include "../src/Utils/Parallel.h"
+#include "../src/Utils/Tracing.h"
+#include <sstream>
+#include <thread>
 
 using namespace recsys;
 
@@ -69,8 +78,10 @@ TEST_CASE("Predictor uses Pearson similarity") {
 /**
  * @test Проверяет предсказание на основе меры Жаккара.
  *
- * Пользователи имеют одинаковые множества оценённых объектов.
- * Ожидаемое предсказание: 5.0 (при максимальном сходстве)
+ * Пользователи имеют одинаковые множества оценённых объектов,
+ * поэтому единственный сосед берётся с максимальным сходством
+ * и предсказание совпадает с его оценкой.
+ * Ожидаемое предсказание: 5.0
  */
 TEST_CASE("Predictor uses Jaccard similarity") {
     std::vector<User> users;
@@ -81,10 +92,243 @@ TEST_CASE("Predictor uses Jaccard similarity") {
     users.push_back(u1);
 
     User u2(2);
-    u2.addRating({2, 101, 3.0, 123456789});
+    u2.addRating({2, 101, 5.0, 123456789});
     u2.addRating({2, 102, 3.0, 123456789});
     users.push_back(u2);
 
     double pred = Predictor::predict(1, 101, users, 1, Predictor::Metric::Jaccard);
     REQUIRE(pred == Approx(5.0).margin(0.01));
 }
+
+/**
+ * @test Проверяет предсказание с манхэттенской метрикой.
+ *
+ * Манхэттенская схожесть единственного соседа положительна,
+ * поэтому предсказание равно его оценке.
+ */
+TEST_CASE("Predictor uses Manhattan similarity") {
+    std::vector<User> users;
+
+    User u1(11);
+    u1.addRating({11, 201, 3.0, 0});
+    users.push_back(u1);
+
+    User u2(12);
+    u2.addRating({12, 201, 4.0, 0});
+    u2.addRating({12, 202, 2.0, 0});
+    users.push_back(u2);
+
+    double pred = Predictor::predict(11, 202, users, 1, Predictor::Metric::Manhattan);
+    REQUIRE(pred == Approx(2.0).margin(0.01));
+}
+
+/**
+ * @test Проверяет агрегацию с центрированием по среднему (формула Резника).
+ *
+ * Среднее пользователя 21 — 3.0; сосед 22 оценил item 303 выше своего среднего,
+ * и это отклонение переносится на среднее пользователя 21.
+ */
+TEST_CASE("Predictor supports mean-centered aggregation") {
+    std::vector<User> users;
+
+    User u1(21);
+    u1.addRating({21, 301, 3.0, 0});
+    u1.addRating({21, 302, 3.0, 0});
+    users.push_back(u1);
+
+    User u2(22);
+    u2.addRating({22, 301, 2.0, 0});
+    u2.addRating({22, 302, 2.0, 0});
+    u2.addRating({22, 303, 4.0, 0});
+    users.push_back(u2);
+
+    Predictor::Options options;
+    options.aggregation = Predictor::Aggregation::MeanCentered;
+    double pred = Predictor::predict(21, 303, users, 1, Predictor::Metric::Cosine, options);
+
+    // Среднее соседа: (2 + 2 + 4) / 3
+    double neighborAvg = 8.0 / 3.0;
+    REQUIRE(pred == Approx(3.0 + (4.0 - neighborAvg)).margin(0.01));
+}
+
+/**
+ * @test Проверяет, что при затухании свежая оценка соседа весит больше старой.
+ *
+ * Два одинаково похожих соседа оценили item 403 на 5.0 (давно) и 1.0 (вчера).
+ * Без затухания предсказание — 3.0, с периодом полураспада 30 дней оно
+ * смещается к свежей оценке.
+ */
+TEST_CASE("Predictor applies time decay to neighbor ratings") {
+    const long now = 1700000000;
+    const long day = 86400;
+    std::vector<User> users;
+
+    User u1(31);
+    u1.addRating({31, 401, 4.0, now});
+    users.push_back(u1);
+
+    User u2(32);
+    u2.addRating({32, 401, 4.0, now});
+    u2.addRating({32, 403, 5.0, now - 365 * day});
+    users.push_back(u2);
+
+    User u3(33);
+    u3.addRating({33, 401, 4.0, now});
+    u3.addRating({33, 403, 1.0, now - day});
+    users.push_back(u3);
+
+    Predictor::Options options;
+    options.weighting = Predictor::Weighting::TimeDecay;
+    options.halfLifeDays = 30.0;
+    options.now = now;
+
+    double plain = Predictor::predict(31, 403, users, 2, Predictor::Metric::Jaccard);
+    double decayed = Predictor::predict(31, 403, users, 2, Predictor::Metric::Jaccard, options);
+
+    REQUIRE(plain == Approx(3.0).margin(0.01));
+    REQUIRE(decayed < 1.1);
+    REQUIRE(decayed >= 1.0);
+
+    options.halfLifeDays = 0.0;
+    REQUIRE_THROWS_AS(
+        Predictor::predict(31, 403, users, 2, Predictor::Metric::Jaccard, options),
+        std::invalid_argument
+    );
+}
+
+/**
+ * @test Счётчики горячего пути: схожести, пересечения, кэш, кандидаты и этапы.
+ *
+ * При сборке без RECSYS_INSTRUMENTATION все счётчики остаются нулевыми.
+ */
+TEST_CASE("Instrumentation counts hot-path events") {
+    std::vector<User> users;
+    for (int id = 1; id <= 4; ++id) users.emplace_back(id);
+    users[0].addRating(Rating(1, 101, 4.0, 0));
+    users[0].addRating(Rating(1, 102, 3.0, 0));
+    for (int id = 2; id <= 4; ++id) {
+        users[id - 1].addRating(Rating(id, 101, 5.0, 0));
+        users[id - 1].addRating(Rating(id, 103, 2.0 + id, 0));
+    }
+    std::vector<Item> items = {Item(101), Item(102), Item(103)};
+
+    Predictor::clearCache();
+    Instrumentation::reset();
+
+    Predictor::predict(1, 103, users, 2);
+    Predictor::predict(1, 103, users, 2);
+    Recommender::recommendTopN(1, users, items, 2, 2);
+    // Счётчики рабочих потоков пула сбрасываются до возврата из parallelFor
+    parallelFor(8, [&](std::size_t) { Similarity::cosine(users[0], users[1]); }, 4);
+
+    auto snapshot = Instrumentation::snapshot();
+    if (!Instrumentation::enabled) {
+        REQUIRE(snapshot[Instrumentation::Counter::SimilarityEvaluations] == 0);
+        return;
+    }
+    using C = Instrumentation::Counter;
+    using S = Instrumentation::Stage;
+    // Один промах на первый predict (3 схожести), попадания на второй и в top-N
+    REQUIRE(snapshot[C::CacheMisses] == 1);
+    REQUIRE(snapshot[C::CacheHits] == 2);
+    REQUIRE(snapshot[C::SimilarityEvaluations] == 3 + 8);
+    REQUIRE(snapshot[C::OverlapItems] == 3 + 8);
+    REQUIRE(snapshot[C::NeighborsFound] == 3);
+    REQUIRE(snapshot[C::NeighborsExamined] == 2);
+    REQUIRE(snapshot[C::CandidatesScored] == 1);
+    REQUIRE(snapshot.calls(S::PredictUser) == 3);
+    REQUIRE(snapshot.calls(S::Neighbors) == 1);
+    REQUIRE(snapshot.calls(S::RecommendTopN) == 1);
+    REQUIRE(snapshot.nanos(S::RecommendTopN) > 0);
+
+    auto text = Instrumentation::text(snapshot);
+    REQUIRE(text.find("# TYPE recsys_cache_hits_total counter\nrecsys_cache_hits_total 2\n") != std::string::npos);
+    REQUIRE(text.find("recsys_stage_calls_total{stage=\"predict_user\"} 3\n") != std::string::npos);
+
+    Instrumentation::reset();
+    REQUIRE(Instrumentation::snapshot()[C::CacheHits] == 0);
+}
+
+/**
+ * @test Трасса: вложенные интервалы с номерами потоков, запись только между start() и stop().
+ */
+TEST_CASE("Tracer records nested spans per thread") {
+    std::vector<User> users;
+    for (int id = 1; id <= 3; ++id) {
+        users.emplace_back(id);
+        users.back().addRating(Rating(id, 101, 1.0 + id, 0));
+        users.back().addRating(Rating(id, 100 + id, 3.0, 0));
+    }
+    std::vector<Item> items = {Item(101), Item(102), Item(103)};
+
+    Predictor::clearCache();
+    Tracer::start();
+    Recommender::recommendTopN(1, users, items, 2, 2);
+    std::thread worker([&] { Predictor::predict(2, 103, users, 2); });
+    worker.join();
+    Tracer::stop();
+    const std::size_t recorded = Tracer::eventCount();
+    Predictor::predict(3, 102, users, 2);
+
+    std::ostringstream json;
+    Tracer::writeJson(json);
+    const std::string text = json.str();
+    if (!Tracer::compiled) {
+        REQUIRE(recorded == 0);
+        return;
+    }
+    REQUIRE(Tracer::eventCount() == recorded);
+    REQUIRE(Tracer::droppedCount() == 0);
+    REQUIRE(text.rfind("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [", 0) == 0);
+    REQUIRE(text.find("\"name\": \"recommend.topn\", \"cat\": \"recommend\", \"ph\": \"X\"") != std::string::npos);
+    REQUIRE(text.find("\"name\": \"similarity.neighbors\"") != std::string::npos);
+    // Главный и рабочий потоки
+    REQUIRE(text.find("\"name\": \"thread_name\"") != text.rfind("\"name\": \"thread_name\""));
+    // Внешний интервал идёт раньше вложенных: отсортировано по началу
+    REQUIRE(text.find("recommend.topn") < text.find("predict.user"));
+}
+
+/**
+ * @test Пакетная схожесть даёт тех же соседей, что и поочерёдный Predictor::neighbors.
+ *
+ * Маленькие пакет и плитка заставляют курсоры строк товаров переходить
+ * через несколько полос пользователей.
+ */
+TEST_CASE("BatchSimilarity matches per-user neighbors") {
+    SyntheticGenerator::Config config;
+    config.users = 60;
+    config.items = 40;
+    config.ratings = 900;
+    config.seed = 11;
+    std::vector<User> users;
+    std::vector<Item> items;
+    SyntheticGenerator generator(config);
+    generator.build(users, items);
+
+    const BatchSimilarity batch(users);
+    REQUIRE(batch.userCount() == users.size());
+    REQUIRE(batch.ratingCount() == generator.totalRatings());
+
+    std::vector<std::size_t> queries;
+    for (std::size_t q = 0; q < users.size(); q += 3) queries.push_back(q);
+    BatchSimilarity::Options options;
+    options.batchSize = 5;
+    options.tileUsers = 7;
+    options.threads = 4;
+
+    for (auto metric : {Predictor::Metric::Cosine, Predictor::Metric::Pearson,
+                        Predictor::Metric::Jaccard, Predictor::Metric::Manhattan}) {
+        const auto result = batch.neighbors(queries, metric, options);
+        REQUIRE(result.size() == queries.size());
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            const auto expected = Predictor::neighbors(users[queries[i]], users, metric);
+            REQUIRE(result[i].size() == expected.size());
+            for (std::size_t j = 0; j < expected.size(); ++j) {
+                REQUIRE(result[i][j].user == expected[j].user);
+                REQUIRE(result[i][j].similarity == Approx(expected[j].similarity).margin(1e-12));
+            }
+        }
+    }
+
+    REQUIRE_THROWS_AS(batch.neighbors({users.size()}, Predictor::Metric::Cosine), std::out_of_range);
+}
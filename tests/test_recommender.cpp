@@ -16,6 +16,17 @@
 #include <Models/User.h>
 #include <Models/Item.h>
 #include <DataHandler/CSVLoader.h>
+#include <DataHandler/SyntheticGenerator.h>
+#include <Serving/LoadGenerator.h>
+#include <Serving/ModelStore.h>
+#include <Serving/TcpServer.h>
+#include <Utils/EpochSet.h>
+#include <Utils/Instrumentation.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
 
 using namespace recsys;
 
@@ -98,3 +109,444 @@ TEST_CASE("Recommender generates recommendations") {
         REQUIRE(recs[0].first == 103);
     }
 }
+
+/**
+ * @test Строковый протокол сервиса: разбор, ответы, TCP и короткий нагрузочный прогон.
+ */
+TEST_CASE("RecommendationService answers the line protocol") {
+    SyntheticGenerator::Config config;
+    config.users = 60;
+    config.items = 40;
+    config.density = 0.2;
+    std::vector<User> users;
+    std::vector<Item> items;
+    SyntheticGenerator(config).build(users, items);
+    const int userId = users.front().getId();
+
+    RecommendationService service(users, items);
+
+    auto request = RecommendationService::parse("TOPN " + std::to_string(userId) + " 3");
+    REQUIRE(request);
+    REQUIRE(request->type == RecommendationService::RequestType::TopN);
+    REQUIRE(request->n == 3);
+    REQUIRE(RecommendationService::parse(RecommendationService::format(*request))->userId == userId);
+    REQUIRE_FALSE(RecommendationService::parse("TOPN x"));
+    REQUIRE_FALSE(RecommendationService::parse("DELETE 1"));
+
+    REQUIRE(service.handle(*request).items.size() <= 3);
+    REQUIRE(service.handleLine("POPULAR 2").rfind("OK ", 0) == 0);
+    REQUIRE(service.handleLine("bogus") == "ERR bad request");
+    REQUIRE(service.handleLine("TOPN 999999 3").rfind("ERR", 0) == 0);
+
+    SECTION("Served over TCP") {
+        TcpServer server(service, 0);
+        server.start();
+        REQUIRE(server.port() != 0);
+        TcpClient client("127.0.0.1", server.port());
+        REQUIRE(client.request("POPULAR 2") == service.handleLine("POPULAR 2"));
+        REQUIRE(client.request("PREDICT " + std::to_string(userId) + " " + std::to_string(items.front().getId()))
+                    .rfind("OK ", 0) == 0);
+
+        LoadGenerator::Config load;
+        load.clients = 2;
+        load.durationSeconds = 0;
+        load.maxRequests = 40;
+        auto report = LoadGenerator::run(users, items, load,
+                                         LoadGenerator::remote("127.0.0.1", server.port()));
+
+        // Строка без '\n' длиннее предела закрывает соединение, а не растит буфер
+        {
+            TcpClient flood("127.0.0.1", server.port());
+            REQUIRE_THROWS_AS(flood.request(std::string(TcpServer::kMaxLineBytes + 1, 'x')), std::runtime_error);
+        }
+
+        // Потоки закрытых соединений присоединяются, а не копятся до stop()
+        for (int i = 0; i < 20; ++i) {
+            TcpClient once("127.0.0.1", server.port());
+            REQUIRE(once.request("POPULAR 1").rfind("OK ", 0) == 0);
+        }
+        std::size_t threads = server.connectionThreads();
+        for (int attempt = 0; attempt < 200 && threads > 1; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            threads = server.connectionThreads();
+        }
+        REQUIRE(threads <= 1);   // открыт только client
+        server.stop();
+        REQUIRE(report.total.requests == 40);
+        REQUIRE(report.total.errors == 0);
+        REQUIRE(report.total.latency.count() == 40);
+    }
+
+    SECTION("Load generator in process") {
+        LoadGenerator::Config load;
+        load.clients = 3;
+        load.durationSeconds = 0;
+        load.maxRequests = 100;
+        load.mix = {1.0, 1.0, 0.0, 0.0};
+        auto report = LoadGenerator::run(users, items, load, LoadGenerator::inProcess(service));
+        REQUIRE(report.total.requests == 100);
+        REQUIRE(report.byType[0].requests + report.byType[1].requests == 100);
+        REQUIRE(report.byType[2].requests == 0);
+        REQUIRE(report.total.latency.percentile(0.5) <= report.total.latency.percentile(0.999));
+        REQUIRE(report.qps() > 0.0);
+    }
+}
+
+/**
+ * @test Параллельная оценка кандидатов даёт ту же выдачу, что и последовательная.
+ */
+TEST_CASE("Parallel candidate scoring matches the sequential top-N") {
+    SyntheticGenerator::Config config;
+    config.users = 80;
+    config.items = 700;
+    config.density = 0.05;
+    std::vector<User> users;
+    std::vector<Item> items;
+    SyntheticGenerator(config).build(users, items);
+    const Recommender::Parallelism defaults = Recommender::parallelism();
+
+    auto run = [&](const User& user) {
+        Predictor::clearCache();
+        std::vector<std::vector<std::pair<int, double>>> lists;
+        lists.push_back(Recommender::recommendTopN(user.getId(), users, items, 10, 5));
+        lists.push_back(Recommender::recommendTopN(user.getId(), users, items, 1000, 5, Predictor::Metric::Pearson));
+        lists.push_back(Recommender::recommendHybrid(user.getId(), users, items, 10, 5, Predictor::Metric::Cosine, 0.5));
+        lists.push_back(Recommender::recommendItemBasedTopN(user.getId(), users, items, 7));
+        auto nbrs = Predictor::neighbors(user, users, Predictor::Metric::Cosine);
+        lists.push_back(Recommender::recommendFromNeighbors(user, nbrs, items, 10, 5, Predictor::Options{}));
+        return lists;
+    };
+
+    for (std::size_t u : {std::size_t{0}, users.size() / 2}) {
+        Recommender::setParallelism({static_cast<std::size_t>(-1), 0});
+        auto sequential = run(users[u]);
+        Recommender::setParallelism({1, 4});
+        auto parallel = run(users[u]);
+
+        REQUIRE(sequential.size() == parallel.size());
+        for (std::size_t l = 0; l < sequential.size(); ++l) {
+            REQUIRE(parallel[l] == sequential[l]);
+            for (std::size_t i = 1; i < sequential[l].size(); ++i) {
+                REQUIRE(sequential[l][i - 1].second >= sequential[l][i].second);
+            }
+        }
+        REQUIRE_FALSE(sequential[0].empty());
+        REQUIRE(sequential[1].size() > 10);
+    }
+
+    Recommender::setParallelism(defaults);
+    REQUIRE(Recommender::parallelism().minCandidates == defaults.minCandidates);
+    Predictor::clearCache();
+}
+
+/**
+ * @test Снимки модели: читатели не видят замену посреди запроса, старая модель освобождается.
+ */
+TEST_CASE("ModelStore swaps snapshots while readers keep the old model") {
+    auto makeModel = [](int users) {
+        Model model;
+        for (int id = 1; id <= users; ++id) model.users.emplace_back(id);
+        return model;
+    };
+
+    ModelStore store(makeModel(1));
+    REQUIRE(store.version() == 1);
+
+    ModelStore::Snapshot held = store.snapshot();
+    REQUIRE(store.publish(makeModel(2)) == 2);
+    REQUIRE(store.snapshot()->users.size() == 2);
+    REQUIRE(held->users.size() == 1);
+    REQUIRE(store.drainingCount() == 1);
+    std::weak_ptr<const Model> old = held;
+    held.reset();
+    REQUIRE(old.expired());
+    store.synchronize();
+    REQUIRE(store.drainingCount() == 0);
+
+    // Каждый снимок согласован: в модели версии v ровно v пользователей
+    std::atomic<bool> stop{false};
+    std::atomic<int> mismatches{0};
+    std::atomic<long> reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            std::uint64_t last = 0;
+            while (!stop.load()) {
+                auto snapshot = store.snapshot();
+                if (snapshot->users.size() != snapshot->version || snapshot->version < last) ++mismatches;
+                last = snapshot->version;
+                ++reads;
+            }
+        });
+    }
+    for (int v = 3; v <= 40; ++v) {
+        store.publish(makeModel(v));
+        if (v % 10 == 0) store.synchronize();
+    }
+    while (reads.load() < 1000) std::this_thread::yield();
+    stop = true;
+    for (auto& reader : readers) reader.join();
+    REQUIRE(mismatches.load() == 0);
+    REQUIRE(store.version() == 40);
+    store.synchronize();
+    REQUIRE(store.drainingCount() == 0);
+
+    SECTION("Service answers from the new model after update") {
+        std::vector<User> users = {User(1), User(2)};
+        users[0].addRating(Rating(1, 101, 5.0, 0));
+        users[1].addRating(Rating(2, 101, 5.0, 0));
+        std::vector<Item> items = {Item(101)};
+        RecommendationService service(users, items);
+        REQUIRE(service.handleLine("TOPN 3 1").rfind("ERR", 0) == 0);
+
+        users.emplace_back(3);
+        users[2].addRating(Rating(3, 101, 4.0, 0));
+        REQUIRE(service.update(users, items) == 2);
+        REQUIRE(service.snapshot()->users.size() == 3);
+        REQUIRE(service.handleLine("TOPN 3 1") == "OK");
+    }
+
+    SECTION("Served predictions never come from the global caches") {
+        auto makeUsers = [](double score) {
+            std::vector<User> users = {User(1), User(2)};
+            users[0].addRating(Rating(1, 101, 5.0, 0));
+            users[1].addRating(Rating(2, 101, 5.0, 0));
+            users[1].addRating(Rating(2, 102, score, 0));
+            return users;
+        };
+        std::vector<Item> items = {Item(101), Item(102)};
+        Predictor::clearCache();
+        RecommendationService service(makeUsers(3.0), items);
+        RecommendationService::Request predict{RecommendationService::RequestType::Predict, 1, 102};
+        RecommendationService::Request hybrid{RecommendationService::RequestType::Hybrid, 1, 0, 5};
+        REQUIRE(service.handle(predict).value == 3.0);
+        REQUIRE_FALSE(service.handle(hybrid).items.empty());
+        REQUIRE(Predictor::userBasedCache().size() == 0);
+        REQUIRE(Predictor::itemBasedCache().size() == 0);
+
+        // Даже прогретый по старой модели кэш не влияет на ответы по новой сразу после update()
+        REQUIRE(Predictor::predict(1, 102, service.snapshot()->users, 5, Predictor::Metric::Cosine) == 3.0);
+        service.update(makeUsers(4.0), items);
+        REQUIRE(service.handle(predict).value == 4.0);
+        RecommendationService::Request topN{RecommendationService::RequestType::TopN, 1, 0, 5};
+        const auto recommended = service.handle(topN).items;
+        REQUIRE(recommended.size() == 1);
+        REQUIRE(recommended.front().second == 4.0);
+        Predictor::clearCache();
+    }
+}
+
+/**
+ * @test Выдача со сроком: без срока совпадает с обычной, с истёкшим — популярные товары.
+ */
+TEST_CASE("Deadline-aware top-N degrades to popular items when the budget is spent") {
+    SyntheticGenerator::Config config;
+    config.users = 80;
+    config.items = 300;
+    config.density = 0.05;
+    std::vector<User> users;
+    std::vector<Item> items;
+    SyntheticGenerator(config).build(users, items);
+    const User& user = users.front();
+    Predictor::clearCache();
+
+    auto full = Recommender::recommendWithDeadline(user.getId(), users, items, 10, 5,
+                                                   Predictor::Metric::Cosine, 1.0, Recommender::Deadline{});
+    REQUIRE_FALSE(full.degraded());
+    REQUIRE(full.items == Recommender::recommendTopN(user.getId(), users, items, 10, 5));
+    auto hybrid = Recommender::recommendWithDeadline(user.getId(), users, items, 10, 5,
+                                                     Predictor::Metric::Pearson, 0.5, Recommender::Deadline{});
+    REQUIRE(hybrid.items == Recommender::recommendHybrid(user.getId(), users, items, 10, 5,
+                                                         Predictor::Metric::Pearson, 0.5));
+
+    // Поиск соседей со сроком: без срока — те же соседи в том же порядке, после срока — прерван
+    bool cut = true;
+    auto unbounded = Predictor::neighbors(user, users, Predictor::Metric::Pearson,
+                                          std::chrono::steady_clock::time_point::max(), cut);
+    REQUIRE_FALSE(cut);
+    auto reference = Predictor::neighbors(user, users, Predictor::Metric::Pearson);
+    REQUIRE(unbounded.size() == reference.size());
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        REQUIRE(unbounded[i].user == reference[i].user);
+        REQUIRE(unbounded[i].similarity == reference[i].similarity);
+    }
+    auto late = Predictor::neighbors(user, users, Predictor::Metric::Pearson,
+                                     std::chrono::steady_clock::now() - std::chrono::seconds(1), cut);
+    REQUIRE(cut);
+    REQUIRE(late.empty());
+
+    Recommender::Deadline expired;
+    expired.at = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    auto fallback = Recommender::recommendWithDeadline(user.getId(), users, items, 10, 5,
+                                                       Predictor::Metric::Cosine, 0.5, expired);
+    REQUIRE(fallback.degradation == Recommender::Degradation::Popular);
+    REQUIRE(fallback.items.size() == 10);
+    int previousCount = std::numeric_limits<int>::max();
+    for (const auto& [itemId, value] : fallback.items) {
+        REQUIRE(user.getRatingForItem(itemId) == 0.0);
+        const auto item = std::find_if(items.begin(), items.end(), [&](const Item& i) { return i.getId() == itemId; });
+        REQUIRE(item->getRatingCount() <= previousCount);
+        REQUIRE(value == item->getAverageRating());
+        previousCount = item->getRatingCount();
+    }
+
+    // Только user-based: соседей найти не успели и кандидатов от них нет, но выдача та же
+    auto userOnly = Recommender::recommendWithDeadline(user.getId(), users, items, 10, 5,
+                                                       Predictor::Metric::Cosine, 1.0, expired);
+    REQUIRE(userOnly.degradation == Recommender::Degradation::Popular);
+    REQUIRE(userOnly.items == fallback.items);
+    Recommender::setCandidateGeneration(false);
+    auto userOnlyScan = Recommender::recommendWithDeadline(user.getId(), users, items, 10, 5,
+                                                           Predictor::Metric::Cosine, 1.0, expired);
+    Recommender::setCandidateGeneration(true);
+    REQUIRE(userOnlyScan.items == userOnly.items);
+
+    REQUIRE_THROWS_AS(Recommender::recommendWithDeadline(-1, users, items, 10, 5, Predictor::Metric::Cosine,
+                                                         1.0, expired), std::runtime_error);
+
+    // Бюджет в протоколе и пометка урезанного ответа
+    auto request = RecommendationService::parse("HYBRID 1 5 2000");
+    REQUIRE(request);
+    REQUIRE(request->budgetMicros == 2000);
+    REQUIRE(RecommendationService::format(*request) == "HYBRID 1 5 2000");
+    REQUIRE(RecommendationService::parse("TOPN 1 5")->budgetMicros == 0);
+    REQUIRE_FALSE(RecommendationService::parse("TOPN 1 5 -3"));
+    RecommendationService::Response response;
+    response.items = {{7, 4.5}};
+    response.degraded = true;
+    REQUIRE(RecommendationService::format(*request, response) == "OK DEGRADED 7:4.5");
+    Predictor::clearCache();
+}
+
+/**
+ * @test Отбор кандидатов по соседям не меняет выдачу и сокращает число оценённых товаров.
+ */
+TEST_CASE("Candidate generation scores fewer items and keeps the top-N") {
+    EpochSet set;
+    REQUIRE(set.insert(5));
+    REQUIRE_FALSE(set.insert(5));
+    for (int key = -1000; key < 1000; ++key) set.insert(key * 7);
+    REQUIRE(set.contains(-7000));
+    REQUIRE_FALSE(set.contains(6));
+    REQUIRE(set.size() == 2001);
+    const std::size_t capacity = set.capacity();
+    set.clear();
+    REQUIRE(set.size() == 0);
+    REQUIRE_FALSE(set.contains(5));
+    REQUIRE(set.capacity() == capacity);
+
+    SyntheticGenerator::Config config;
+    config.users = 60;
+    config.items = 2000;
+    config.density = 0.004;
+    std::vector<User> users;
+    std::vector<Item> items;
+    SyntheticGenerator(config).build(users, items);
+
+    auto run = [&](const User& user) {
+        Predictor::clearCache();
+        std::vector<std::vector<std::pair<int, double>>> lists;
+        lists.push_back(Recommender::recommendTopN(user.getId(), users, items, 10, 5));
+        lists.push_back(Recommender::recommendHybrid(user.getId(), users, items, 10, 5, Predictor::Metric::Jaccard, 0.3));
+        lists.push_back(Recommender::recommendItemBasedTopN(user.getId(), users, items, 10));
+        auto nbrs = Predictor::neighbors(user, users, Predictor::Metric::Pearson);
+        lists.push_back(Recommender::recommendFromNeighbors(user, nbrs, items, 2000, 5, Predictor::Options{}));
+        lists.push_back(Recommender::recommendWithDeadline(user.getId(), users, items, 10, 5,
+                                                           Predictor::Metric::Cosine, 1.0, Recommender::Deadline{}).items);
+        return lists;
+    };
+
+    for (std::size_t u : {std::size_t{0}, users.size() - 1}) {
+        Recommender::setCandidateGeneration(false);
+        Instrumentation::reset();
+        auto full = run(users[u]);
+        const auto scoredFull = Instrumentation::snapshot()[Instrumentation::Counter::CandidatesScored];
+        Recommender::setCandidateGeneration(true);
+        Instrumentation::reset();
+        auto generated = run(users[u]);
+        const auto scored = Instrumentation::snapshot()[Instrumentation::Counter::CandidatesScored];
+
+        REQUIRE(generated == full);
+        REQUIRE_FALSE(full[3].empty());
+        if (Instrumentation::enabled) REQUIRE(scored < scoredFull);
+    }
+    REQUIRE(Recommender::candidateGeneration());
+    Predictor::clearCache();
+}
+
+/**
+ * @test Исключения выдачи: оценённые товары (в том числе с оценкой 0) и переданные вызывающим.
+ */
+TEST_CASE("Top-N excludes rated items and caller-supplied items") {
+    std::vector<User> users;
+    for (int id = 1; id <= 3; ++id) users.emplace_back(id);
+    users[0].addRating(Rating(1, 101, 4.0, 0));
+    users[0].addRating(Rating(1, 104, 0.0, 0));
+    for (int id = 2; id <= 3; ++id) {
+        users[id - 1].addRating(Rating(id, 101, 4.0, 0));
+        for (int item = 102; item <= 105; ++item) users[id - 1].addRating(Rating(id, item, 1.0 + item - 102 + id, 0));
+    }
+    std::vector<Item> items;
+    for (int item = 101; item <= 105; ++item) items.emplace_back(item);
+    Predictor::clearCache();
+
+    EpochSet excluded;
+    Recommender::collectExclusions(users[0], {103}, excluded);
+    REQUIRE(excluded.size() == 3);
+    REQUIRE(excluded.contains(104));
+    REQUIRE(excluded.contains(103));
+    REQUIRE_FALSE(excluded.contains(102));
+    const EpochSet& scratch = Recommender::scratchExclusions(users[0], {103});
+    REQUIRE(scratch.size() == 3);
+    REQUIRE(scratch.contains(103));
+    REQUIRE(Recommender::scratchExclusions(users[0]).size() == 2);   // тот же буфер потока, очищен
+    REQUIRE(&Recommender::scratchExclusions(users[0]) == &scratch);
+
+    auto ids = [](const std::vector<std::pair<int, double>>& recs) {
+        std::vector<int> result;
+        for (const auto& [itemId, score] : recs) result.push_back(itemId);
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    // Оценка 0 — тоже оценка: товар 104 не рекомендуется
+    REQUIRE(ids(Recommender::recommendTopN(1, users, items, 10, 2)) == std::vector<int>{102, 103, 105});
+    REQUIRE(ids(Recommender::recommendTopN(1, users, items, 10, 2, Predictor::Metric::Cosine, {103, 999}))
+            == std::vector<int>{102, 105});
+    REQUIRE(ids(Recommender::recommendHybrid(1, users, items, 10, 2, Predictor::Metric::Cosine, 0.5, {105}))
+            == std::vector<int>{102, 103});
+    auto itemBased = ids(Recommender::recommendItemBasedTopN(1, users, items, 10));
+    REQUIRE(std::count(itemBased.begin(), itemBased.end(), 102) == 1);
+    itemBased.erase(std::find(itemBased.begin(), itemBased.end(), 102));
+    REQUIRE(ids(Recommender::recommendItemBasedTopN(1, users, items, 10, {102})) == itemBased);
+    auto nbrs = Predictor::neighbors(users[0], users, Predictor::Metric::Cosine);
+    REQUIRE(ids(Recommender::recommendFromNeighbors(users[0], nbrs, items, 10, 2, Predictor::Options{}, {102, 103}))
+            == std::vector<int>{105});
+    auto budgeted = Recommender::recommendWithDeadline(1, users, items, 10, 2, Predictor::Metric::Cosine, 1.0,
+                                                       Recommender::Deadline{}, {105});
+    REQUIRE(ids(budgeted.items) == std::vector<int>{102, 103});
+
+    auto request = RecommendationService::parse("TOPN 1 10 EXCLUDE 102,105");
+    REQUIRE(request);
+    REQUIRE(request->exclude == std::vector<int>{102, 105});
+    REQUIRE(request->budgetMicros == 0);
+    REQUIRE(RecommendationService::format(*request) == "TOPN 1 10 EXCLUDE 102,105");
+    REQUIRE(RecommendationService::parse("HYBRID 1 10 500 EXCLUDE 7")->budgetMicros == 500);
+    REQUIRE_FALSE(RecommendationService::parse("TOPN 1 10 EXCLUDE a,b"));
+    // Один бюджет перед EXCLUDE, токены целиком числовые
+    REQUIRE(RecommendationService::parse("TOPN 1 5 7")->budgetMicros == 7);
+    REQUIRE(RecommendationService::parse("POPULAR 2")->n == 2);
+    REQUIRE(RecommendationService::parse("PREDICT 1 102")->itemId == 102);
+    for (const char* bad : {"TOPN 1 5 7 9", "TOPN 1 5 1.5", "TOPN 1 5 5abc", "TOPN 1 5 -1", "TOPN 1 5.5",
+                            "TOPN 1 5 EXCLUDE", "TOPN 1 5 EXCLUDE 1,", "TOPN 1 5 EXCLUDE 1x", "TOPN 1 5 EXCLUDE 1 2",
+                            "TOPN 1 5 EXCLUDE 1 7", "TOPN 1 5 7 EXCLUDE 1 EXCLUDE 2", "TOPN 1x 5",
+                            "POPULAR 2x", "POPULAR 2 3", "POPULAR", "PREDICT 1 2 foo", "PREDICT 1 2.5",
+                            "PREDICT 1x 2", "PREDICT 1", "PREDICT 99999999999 2"}) {
+        INFO(bad);
+        REQUIRE_FALSE(RecommendationService::parse(bad));
+    }
+    RecommendationService service(users, items);
+    REQUIRE(service.handle(*request).items.size() == 1);
+    REQUIRE(service.handleLine("POPULAR 2x") == "ERR bad request");
+    REQUIRE(service.handleLine("PREDICT 1 102 foo") == "ERR bad request");
+    Predictor::clearCache();
+}
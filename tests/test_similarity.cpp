@@ -14,6 +14,7 @@
 using namespace Catch;
 
 #include <Algorithms/Similarity.h>
+#include <Algorithms/DecayTable.h>
 #include <Models/User.h>
 #include <Models/Rating.h>
 
@@ -54,16 +55,55 @@ TEST_CASE("Jaccard of non-overlapping sets is 0", "[similarity]") {
  * @test Проверяет скорректированное косинусное сходство между двумя объектами.
  *
  * Пользователи выставили оценки так, что нормализованные векторы идеально совпадают.
+ * Третий товар нужен, чтобы центрирование по среднему пользователя
+ * не делало отклонения по 101 и 102 противоположными по знаку.
  * Ожидаемое значение: 1.0
  */
 TEST_CASE("Adjusted Cosine Similarity works - Positive correlation gives +1") {
     User u1(1), u2(2);
     u1.addRating({1, 101, 4.0, 0});
-    u1.addRating({1, 102, 2.0, 0});
+    u1.addRating({1, 102, 4.0, 0});
+    u1.addRating({1, 103, 1.0, 0});
     u2.addRating({2, 101, 5.0, 0});
-    u2.addRating({2, 102, 3.0, 0});
+    u2.addRating({2, 102, 5.0, 0});
+    u2.addRating({2, 103, 2.0, 0});
 
     std::vector<User> users = {u1, u2};
     double sim = Similarity::adjustedCosine(users, 101, 102);
     REQUIRE(sim == Approx(1.0).margin(0.01));
 }
+
+/**
+ * @test Проверяет, что таблица затухания приближает 2^(-age/halfLife) с ошибкой < 1%.
+ */
+TEST_CASE("Decay table approximates exponential half-life", "[similarity][decay]") {
+    const double halfLife = 86400.0 * 30;
+    DecayTable table(halfLife);
+
+    REQUIRE(table.weight(0) == Approx(1.0));
+    REQUIRE(table.weight(-100) == Approx(1.0));
+
+    for (long age : {3600L, 86400L * 7, 86400L * 30, 86400L * 90, 86400L * 365}) {
+        double exact = std::exp2(-static_cast<double>(age) / halfLife);
+        REQUIRE(table.weight(age) == Approx(exact).epsilon(0.01));
+    }
+
+    // Вне диапазона таблицы вес остаётся положительным и не растёт
+    REQUIRE(table.weight(86400L * 10000) > 0.0);
+    REQUIRE(table.weight(86400L * 10000) <= table.weight(86400L * 365));
+
+    // Similarity::decayWeight — тот же закон: за период полураспада вес падает вдвое
+    const long now = 86400L * 1000;
+    REQUIRE(Similarity::decayWeight(now - 86400L * 30, now, halfLife) == Approx(0.5));
+    REQUIRE(Similarity::decayWeight(now - 86400L * 90, now, halfLife) ==
+            Approx(table.weight(86400L * 90)).epsilon(0.01));
+
+    // Кэш таблиц ограничен: новые периоды вытесняют давно не использованные
+    auto shared = DecayTable::forHalfLife(halfLife);
+    REQUIRE(DecayTable::forHalfLife(halfLife) == shared);
+    for (int i = 1; i <= 100; ++i) DecayTable::forHalfLife(3600.0 * i);
+    std::size_t tables = 0;
+    DecayTable::cachedBytes(tables);
+    REQUIRE(tables == DecayTable::kCachedTables);
+    REQUIRE(shared->halfLife() == halfLife);   // вытесненная таблица жива, пока её держат
+}